@@ -35,14 +35,20 @@
 
 #include "TimeLib.h"
 
-static tmElements_t tm;          // a cache of time elements
+#if defined(ESP32)
+#include <esp_timer.h>
+#endif
+
+static tmElements_t tm;          // a cache of time elements, shared by all accessors
 static time_t cacheTime;   // the time the cache was updated
+static bool cacheValid = false;
 static uint32_t syncInterval = 300;  // time sync will be attempted after this many seconds
 
 void refreshCache(time_t t) {
-  if (t != cacheTime) {
+  if (!cacheValid || t != cacheTime) {
     breakTime(t, tm); 
     cacheTime = t; 
+    cacheValid = true;
   }
 }
 
@@ -234,8 +240,22 @@ time_t makeTime(tmElements_t &tm){
 /*=====================================================*/	
 /* Low level system time functions  */
 
+// The 64 bit timer on the ESP32 doesn't wrap, elsewhere the unsigned
+// subtraction in now() copes with millis() wrapping once between calls.
+#if defined(ESP32)
+typedef uint64_t millis_t;
+static millis_t currentMillis() {
+  return esp_timer_get_time() / 1000;
+}
+#else
+typedef uint32_t millis_t;
+static millis_t currentMillis() {
+  return millis();
+}
+#endif
+
 static uint32_t sysTime = 0;
-static uint32_t prevMillis = 0;
+static millis_t prevMillis = 0;
 static uint32_t nextSyncTime = 0;
 static timeStatus_t Status = timeNotSet;
 
@@ -248,13 +268,14 @@ time_t sysUnsyncedTime = 0; // the time sysTime unadjusted by sync
 
 
 time_t now() {
-	// calculate number of seconds passed since last call to now()
-  while (millis() - prevMillis >= 1000) {
-		// millis() and prevMillis are both unsigned ints thus the subtraction will always be the absolute value of the difference
-    sysTime++;
-    prevMillis += 1000;	
+  // catch up with all seconds passed since the last call at once
+  const millis_t elapsed = currentMillis() - prevMillis;
+  if (elapsed >= 1000) {
+    const uint32_t seconds = elapsed / 1000;
+    sysTime += seconds;
+    prevMillis += (millis_t)seconds * 1000;
 #ifdef TIME_DRIFT_INFO
-    sysUnsyncedTime++; // this can be compared to the synced time to measure long term drift     
+    sysUnsyncedTime += seconds; // this can be compared to the synced time to measure long term drift     
 #endif
   }
   if (nextSyncTime <= sysTime) {
@@ -280,12 +301,14 @@ void setTime(time_t t) {
   sysTime = (uint32_t)t;  
   nextSyncTime = (uint32_t)t + syncInterval;
   Status = timeSet;
-  prevMillis = millis();  // restart counting from now (thanks to Korman for this fix)
+  prevMillis = currentMillis();  // restart counting from now (thanks to Korman for this fix)
 } 
 
 void setTime(int hr,int min,int sec,int dy, int mnth, int yr){
  // year can be given as full four digit year or two digts (2010 or 10 for 2010);  
  //it is converted to years since 1970
+ // (a local copy, the shared cache stays valid)
+  tmElements_t tm;
   if( yr > 99)
       yr = yr - 1970;
   else
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <pgmspace.h>
+#include <Timezone.h>
 
 namespace WSConfig {
   // Wireless configuration.
@@ -22,8 +23,31 @@ namespace WSConfig {
   // Button, not yet used.
   const uint8_t kButtonPin = 32;
 
-  // NTP Timeserver to use.
-  const char kNtpServerName[] PROGMEM = "<ntpserver>";
+  // NTP Timeservers to use (up to 4), they're queried side by side and the
+  // ones that disagree with the majority are ignored. Use at least three to
+  // be able to outvote a bad one.
+  const char* const kNtpServerNames[] = {
+    "0.pool.ntp.org",
+    "1.pool.ntp.org",
+    "2.pool.ntp.org"
+  };
+
+  // Time zone for the display, the clock itself runs in UTC. Rules as in
+  // lib/Timezone: name, week, day of week, month, local hour of the change
+  // and the offset to UTC in minutes.
+  const TimeChangeRule kDaylightSavingTime = { "CEST", Last, Sun, Mar, 2, 120 };
+  const TimeChangeRule kStandardTime = { "CET", Last, Sun, Oct, 3, 60 };
+
+  // Weather provider, kWeatherProviderWunderground or
+  // kWeatherProviderOpenMeteo.
+  const uint8_t kWeatherProviderWunderground = 0;
+  const uint8_t kWeatherProviderOpenMeteo = 1;
+  const uint8_t kWeatherProvider = kWeatherProviderOpenMeteo;
+
+  // How long current conditions and the forecast are kept before they're
+  // fetched again, in milliseconds.
+  const uint32_t kWeatherObservationTtl = 5 * 60 * 1000;
+  const uint32_t kWeatherForecastTtl = 3 * 60 * 60 * 1000;
 
   // Weatherunderground API key, language and location.
   // The location is used to find closest weather station.
@@ -31,6 +55,11 @@ namespace WSConfig {
   const char kWundergroundLanguage[] PROGMEM = "EN";
   const char kWundergroundLocation[] PROGMEM    = "<lat>,<long>";
 
+  // Open-Meteo location, the name is shown as city.
+  const char kOpenMeteoLatitude[] PROGMEM = "<lat>";
+  const char kOpenMeteoLongitude[] PROGMEM = "<long>";
+  const char kOpenMeteoLocationName[] PROGMEM = "<city>";
+
   // MQTT configuration. Leave empty (="") if not used.
   const char kMqttBroker[] PROGMEM = "<mqttbroker>";
   const uint16_t kMqttBrokerPort = 8883;
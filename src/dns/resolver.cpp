@@ -0,0 +1,378 @@
+#include "resolver.h"
+#include <string.h>
+#include <esp_log.h>
+
+extern "C" {
+  #include "lwip/err.h"
+  #include "lwip/dns.h"
+}
+
+static const char LogTag[] PROGMEM = "DnsResolver";
+
+static xQueueHandle ResolverQueue;
+static volatile TaskHandle_t ResolverTaskHandle = NULL;
+
+namespace Dns {
+  Resolver::Resolver(const uint32_t ttl, const uint32_t negativeTtl) : ttl(ttl), negativeTtl(negativeTtl) {
+    this->statistics = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    for(size_t i = 0; i < kMaxEntries; i++) {
+      this->entries[i].host[0] = '\0';
+      this->entries[i].state = eFree;
+      this->entries[i].address = 0;
+      this->entries[i].isPrefetching = false;
+      this->entries[i].resolvedAt = 0;
+      this->entries[i].lookupStart = 0;
+      this->entries[i].lastUsed = 0;
+    }
+
+    // Lookups come in from several tasks and finish on the resolver task.
+    this->lock = xSemaphoreCreateRecursiveMutex();
+  }
+
+  Resolver::~Resolver() {
+    vSemaphoreDelete(this->lock);
+  }
+
+  bool Resolver::resolve(const char* host, const Callback callback) {
+    IPAddress address;
+
+    // Nothing to look up for an address literal.
+    if(address.fromString(host)) {
+      callback(true, address);
+      return true;
+    }
+
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    if(!ResolverQueue) {
+      ResolverQueue = xQueueCreate(2 * kMaxEntries, sizeof(Result));
+      if(!ResolverQueue) {
+        ESP_LOGE(LogTag, "error creating resolver queue.");
+      }
+    }
+
+    if(!ResolverTaskHandle) {
+      static const char kResolverTaskName[] PROGMEM = "DnsResolver::TaskHandler";
+
+      xTaskCreatePinnedToCore(&Resolver::ResolverTask,
+                              kResolverTaskName,
+                              4096,
+                              NULL,
+                              3,
+                              (TaskHandle_t*)&ResolverTaskHandle,
+                              1);
+    }
+
+    const unsigned long now = millis();
+    int index = this->indexOf(host);
+
+    // Copied, the entry may be reused once the lock is released.
+    char name[kMaxHostLength];
+    bool shouldLookup = false;
+
+    if(index >= 0 && !this->isExpired(this->entries[index], now)) {
+      Entry& entry = this->entries[index];
+
+      entry.lastUsed = now;
+
+      if(entry.state == eResolved) {
+        this->statistics.hits++;
+
+        // Refresh in the background once three quarters of the TTL passed,
+        // so a regular user never waits for a lookup.
+        if(!entry.isPrefetching && now - entry.resolvedAt > this->ttl - this->ttl / 4) {
+          ESP_LOGI(LogTag, "prefetching %s.", host);
+
+          this->statistics.prefetches++;
+          entry.isPrefetching = true;
+          this->beginLookup(entry);
+
+          strcpy(name, entry.host);
+          shouldLookup = true;
+        }
+
+        address = entry.address;
+        xSemaphoreGiveRecursive(this->lock);
+
+        callback(true, address);
+
+        if(shouldLookup) {
+          this->lookup(name);
+        }
+        return true;
+      }
+
+      if(entry.state == eFailed) {
+        this->statistics.negativeHits++;
+        xSemaphoreGiveRecursive(this->lock);
+
+        callback(false, address);
+        return false;
+      }
+    }
+
+    this->statistics.misses++;
+
+    if(index < 0) {
+      index = this->allocate(host);
+    }
+
+    if(index < 0) {
+      xSemaphoreGiveRecursive(this->lock);
+
+      ESP_LOGE(LogTag, "no free entry for %s.", host);
+      callback(false, address);
+      return false;
+    }
+
+    Entry& entry = this->entries[index];
+
+    // Join a lookup that's already running.
+    size_t waiter = 0;
+    while(waiter < kMaxWaiters && entry.waiters[waiter]) {
+      waiter++;
+    }
+
+    if(waiter == kMaxWaiters) {
+      xSemaphoreGiveRecursive(this->lock);
+
+      ESP_LOGE(LogTag, "too many lookups for %s.", host);
+      callback(false, address);
+      return false;
+    }
+
+    entry.waiters[waiter] = callback;
+    entry.lastUsed = now;
+
+    // Start a lookup, or again when the last one never reported back.
+    if(entry.state != eResolving || now - entry.lookupStart > kLookupTimeout) {
+      entry.isPrefetching = false;
+      this->beginLookup(entry);
+
+      strcpy(name, entry.host);
+      shouldLookup = true;
+    }
+
+    xSemaphoreGiveRecursive(this->lock);
+
+    // lwIP may answer right away, its waiters are called without the lock.
+    if(shouldLookup) {
+      this->lookup(name);
+    }
+
+    return true;
+  }
+
+  bool Resolver::get(const char* host, IPAddress& address) {
+    bool success = false;
+
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    const int index = this->indexOf(host);
+    if(index >= 0 && this->entries[index].state == eResolved && !this->isExpired(this->entries[index], millis())) {
+      address = this->entries[index].address;
+      success = true;
+    }
+
+    xSemaphoreGiveRecursive(this->lock);
+
+    return success;
+  }
+
+  void Resolver::remove(const char* host) {
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    // A running lookup still has to report back to its waiters.
+    const int index = this->indexOf(host);
+    if(index >= 0 && this->entries[index].state != eResolving) {
+      this->entries[index].state = eFree;
+    }
+
+    xSemaphoreGiveRecursive(this->lock);
+  }
+
+  const Resolver::Statistics& Resolver::getStatistics() const {
+    return this->statistics;
+  }
+
+  //
+  // - private
+  //
+  int Resolver::indexOf(const char* host) const {
+    for(size_t i = 0; i < kMaxEntries; i++) {
+      const Entry& entry = this->entries[i];
+
+      if(entry.state != eFree && strcasecmp(entry.host, host) == 0) {
+        return i;
+      }
+    }
+
+    return -1;
+  }
+
+  int Resolver::allocate(const char* host) {
+    if(strlen(host) >= kMaxHostLength) {
+      return -1;
+    }
+
+    // Take a free entry, or the least recently used one that isn't being
+    // looked up.
+    int index = -1;
+    for(size_t i = 0; i < kMaxEntries; i++) {
+      const Entry& entry = this->entries[i];
+
+      if(entry.state == eFree) {
+        index = i;
+        break;
+      }
+
+      if(entry.state != eResolving && (index < 0 || entry.lastUsed < this->entries[index].lastUsed)) {
+        index = i;
+      }
+    }
+
+    if(index >= 0) {
+      Entry& entry = this->entries[index];
+
+      strcpy(entry.host, host);
+      entry.state = eFree;
+      entry.isPrefetching = false;
+
+      for(size_t i = 0; i < kMaxWaiters; i++) {
+        entry.waiters[i] = nullptr;
+      }
+    }
+
+    return index;
+  }
+
+  bool Resolver::isExpired(const Entry& entry, const unsigned long now) const {
+    switch(entry.state) {
+      case eResolved:
+        return now - entry.resolvedAt > this->ttl;
+      case eFailed:
+        return now - entry.resolvedAt > this->negativeTtl;
+      default:
+        // Waiting for a lookup counts as a miss.
+        return true;
+    }
+  }
+
+  void Resolver::beginLookup(Entry& entry) {
+    // A prefetch keeps handing out the cached address until it's done.
+    if(!entry.isPrefetching) {
+      entry.state = eResolving;
+    }
+
+    entry.lookupStart = millis();
+    this->statistics.lookups++;
+  }
+
+  void Resolver::lookup(const char* host) {
+    ip_addr_t ipAddress;
+    const err_t error = dns_gethostbyname(host, &ipAddress, (dns_found_callback)&DnsFoundCallback, this);
+
+    if(error == ERR_OK) {
+      // lwIP had it cached itself.
+      this->found(host, &ipAddress);
+    } else if(error != ERR_INPROGRESS) {
+      ESP_LOGE(LogTag, "could not look up %s (%d).", host, error);
+      this->found(host, NULL);
+    }
+  }
+
+  void Resolver::found(const char* name, const ip_addr_t* ipAddress) {
+    // Connections are IPv4 only, any other answer is no address to us.
+    if(ipAddress != NULL && !IP_IS_V4(ipAddress)) {
+      ESP_LOGW(LogTag, "%s resolved to a non IPv4 address.", name);
+      ipAddress = NULL;
+    }
+
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    const int index = this->indexOf(name);
+    if(index < 0) {
+      xSemaphoreGiveRecursive(this->lock);
+      return;
+    }
+
+    Entry& entry = this->entries[index];
+    const unsigned long now = millis();
+    const uint32_t lookupTime = now - entry.lookupStart;
+
+    this->statistics.lastLookupTime = lookupTime;
+    this->statistics.totalLookupTime += lookupTime;
+
+    if(ipAddress != NULL) {
+      ESP_LOGI(LogTag, "resolved %s in %d ms.", name, lookupTime);
+
+      entry.state = eResolved;
+      entry.address = ip_2_ip4(ipAddress)->addr;
+      entry.resolvedAt = now;
+    } else if(entry.isPrefetching && entry.state == eResolved) {
+      // Keep the address we have, it's still valid until it expires.
+      ESP_LOGW(LogTag, "prefetching %s failed.", name);
+      this->statistics.failures++;
+    } else {
+      ESP_LOGE(LogTag, "could not resolve %s.", name);
+
+      this->statistics.failures++;
+      entry.state = eFailed;
+      entry.resolvedAt = now;
+    }
+
+    entry.isPrefetching = false;
+
+    // Call back outside the lock, callbacks may resolve again.
+    Callback waiters[kMaxWaiters];
+    for(size_t i = 0; i < kMaxWaiters; i++) {
+      waiters[i] = entry.waiters[i];
+      entry.waiters[i] = nullptr;
+    }
+
+    const bool success = entry.state == eResolved;
+    const IPAddress address(entry.address);
+
+    xSemaphoreGiveRecursive(this->lock);
+
+    for(size_t i = 0; i < kMaxWaiters; i++) {
+      if(waiters[i]) {
+        waiters[i](success, address);
+      }
+    }
+  }
+
+  void Resolver::DnsFoundCallback(const char* name, const ip_addr_t* ipAddress, void* arg) {
+    if(arg == NULL || strlen(name) >= kMaxHostLength) {
+      return;
+    }
+
+    Result result;
+    result.resolver = static_cast<Resolver*>(arg);
+    strcpy(result.host, name);
+    result.success = ipAddress != NULL;
+    if(ipAddress != NULL) {
+      result.ipAddress = *ipAddress;
+    }
+
+    // Runs on the lwIP task, which must not block. A lost result is looked
+    // up again after kLookupTimeout.
+    if(xQueueSend(ResolverQueue, &result, 0) != pdPASS) {
+      ESP_LOGE(LogTag, "error adding %s to queue!", name);
+    }
+  }
+
+  void Resolver::ResolverTask(void*) {
+    Result result;
+
+    for (;;) {
+      if(xQueueReceive(ResolverQueue, &result, portMAX_DELAY) == pdTRUE) {
+        result.resolver->found(result.host, result.success ? &result.ipAddress : NULL);
+      }
+    }
+
+    ResolverTaskHandle = NULL;
+    vTaskDelete( NULL );
+  }
+}
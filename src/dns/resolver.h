@@ -0,0 +1,103 @@
+#ifndef _DNS_RESOLVER_H_
+#define _DNS_RESOLVER_H_
+
+#include <Arduino.h>
+#include <functional>
+
+extern "C" {
+  #include "lwip/ip_addr.h"
+}
+
+namespace Dns {
+  // Small host name cache in front of lwIP's resolver, shared by the HTTP,
+  // NTP and MQTT clients. Failed lookups are cached for a short while too,
+  // and an address that's close to expiring is looked up again in the
+  // background while the cached one is still handed out.
+  //
+  // Nothing runs on the lwIP task: its callbacks only post to a queue, and
+  // AsyncTCP/AsyncUDP connect through tcpip_api_call, which would deadlock
+  // there. Lookups finish on the resolver's own task.
+  class Resolver {
+    public:
+      // Called right away for a cached address, otherwise from the resolver
+      // task once the lookup finished. Never on the lwIP task, so callbacks
+      // may connect right away.
+      typedef std::function<void(bool success, const IPAddress& address)> Callback;
+
+      struct Statistics {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t negativeHits;
+        uint32_t failures;
+        uint32_t prefetches;
+        uint32_t lookups;
+        uint32_t lastLookupTime;
+        uint32_t totalLookupTime;
+      };
+
+      Resolver(const uint32_t ttl = 300000 /* in milliseconds */,
+               const uint32_t negativeTtl = 30000 /* in milliseconds */);
+      ~Resolver();
+
+      bool resolve(const char* host, const Callback callback);
+
+      // Only looks at the cache, doesn't start a lookup.
+      bool get(const char* host, IPAddress& address);
+
+      // Forget host, e.g. after its address stopped answering.
+      void remove(const char* host);
+
+      const Statistics& getStatistics() const;
+
+    private:
+      static const size_t kMaxEntries = 4;
+      static const size_t kMaxHostLength = 64;
+      static const size_t kMaxWaiters = 3;
+      // A lookup that didn't report back by then is started again, in
+      // milliseconds.
+      static const uint32_t kLookupTimeout = 30000;
+
+      enum State {
+        eFree,
+        eResolving,
+        eResolved,
+        eFailed
+      };
+
+      struct Entry {
+        char host[kMaxHostLength];
+        State state;
+        uint32_t address;
+        bool isPrefetching;
+        unsigned long resolvedAt;
+        unsigned long lookupStart;
+        unsigned long lastUsed;
+        Callback waiters[kMaxWaiters];
+      };
+
+      // lwIP's answer, passed by value to the resolver task.
+      struct Result {
+        Resolver* resolver;
+        char host[kMaxHostLength];
+        bool success;
+        ip_addr_t ipAddress;
+      };
+
+      uint32_t ttl;
+      uint32_t negativeTtl;
+      Statistics statistics;
+      Entry entries[kMaxEntries];
+      SemaphoreHandle_t lock;
+
+      int indexOf(const char* host) const;
+      int allocate(const char* host);
+      bool isExpired(const Entry& entry, const unsigned long now) const;
+      void beginLookup(Entry& entry);
+      void lookup(const char* host);
+      void found(const char* name, const ip_addr_t* ipAddress);
+      static void DnsFoundCallback(const char* name, const ip_addr_t* ipAddress, void* arg);
+      static void ResolverTask(void* params);
+  };
+}
+
+#endif // _DNS_RESOLVER_H_
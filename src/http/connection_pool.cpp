@@ -0,0 +1,206 @@
+#include "connection_pool.h"
+#include <string.h>
+#include <esp_log.h>
+
+static const char LogTag[] PROGMEM = "HttpConnectionPool";
+
+namespace Http {
+  ConnectionPool::ConnectionPool(const uint32_t idleTimeout) : idleTimeout(idleTimeout) {
+    this->statistics = { 0, 0, 0 };
+
+    // Recursive, closing a connection can fire its handlers right away.
+    this->lock = xSemaphoreCreateRecursiveMutex();
+
+    for(size_t i = 0; i < kMaxConnections; i++) {
+      this->connections[i].state = eFree;
+      this->connections[i].host[0] = '\0';
+      this->connections[i].port = 0;
+      this->connections[i].lastUsed = 0;
+    }
+  }
+
+  ConnectionPool::~ConnectionPool() {
+    for(size_t i = 0; i < kMaxConnections; i++) {
+      this->close(this->connections[i]);
+    }
+
+    vSemaphoreDelete(this->lock);
+  }
+
+  AsyncClient* ConnectionPool::acquire(const char* host, const uint16_t port, bool& isConnected) {
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    this->evict();
+
+    Connection* freeConnection = NULL;
+
+    for(size_t i = 0; i < kMaxConnections; i++) {
+      Connection& connection = this->connections[i];
+
+      if(connection.state == eIdle
+        && connection.port == port
+        && strcasecmp(connection.host, host) == 0
+        && connection.client.connected()) {
+        ESP_LOGI(LogTag, "reusing connection to %s:%d.", host, port);
+
+        this->statistics.hits++;
+
+        connection.state = eBusy;
+        connection.client.onPoll(nullptr);
+        isConnected = true;
+
+        xSemaphoreGiveRecursive(this->lock);
+        return &connection.client;
+      }
+
+      if(connection.state == eFree && freeConnection == NULL) {
+        freeConnection = &connection;
+      }
+    }
+
+    this->statistics.misses++;
+
+    // No idle connection to this server, take over the least recently used
+    // idle connection to another server if there's no free one.
+    if(freeConnection == NULL) {
+      for(size_t i = 0; i < kMaxConnections; i++) {
+        Connection& connection = this->connections[i];
+
+        if(connection.state == eIdle
+          && (freeConnection == NULL || connection.lastUsed < freeConnection->lastUsed)) {
+          freeConnection = &connection;
+        }
+      }
+
+      if(freeConnection != NULL) {
+        this->statistics.evictions++;
+        this->close(*freeConnection);
+      }
+    }
+
+    if(freeConnection == NULL) {
+      ESP_LOGE(LogTag, "no free connection for %s:%d.", host, port);
+
+      xSemaphoreGiveRecursive(this->lock);
+      return NULL;
+    }
+
+    freeConnection->state = eBusy;
+    strncpy(freeConnection->host, host, kMaxHostLength - 1);
+    freeConnection->host[kMaxHostLength - 1] = '\0';
+    freeConnection->port = port;
+    isConnected = false;
+
+    xSemaphoreGiveRecursive(this->lock);
+    return &freeConnection->client;
+  }
+
+  void ConnectionPool::release(AsyncClient* client, const bool keepAlive) {
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    Connection* connection = this->find(client);
+    if(connection == NULL) {
+      xSemaphoreGiveRecursive(this->lock);
+      return;
+    }
+
+    if(!keepAlive || !client->connected()) {
+      this->close(*connection);
+
+      xSemaphoreGiveRecursive(this->lock);
+      return;
+    }
+
+    connection->state = eIdle;
+    connection->lastUsed = millis();
+
+    // While idle nothing is expected from the server, if it closes the
+    // connection (or sends anything) the connection is dropped.
+    client->setRxTimeout(0);
+    client->onConnect(nullptr);
+    client->onTimeout(nullptr);
+    client->onError(nullptr);
+    client->onAck(nullptr);
+    client->onData([this](void* v, AsyncClient* c, void* data, size_t len) {
+      xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+      Connection* connection = this->find(c);
+      if(connection != NULL && connection->state == eIdle) {
+        ESP_LOGI(LogTag, "unexpected data on idle connection.");
+        this->close(*connection);
+      }
+
+      xSemaphoreGiveRecursive(this->lock);
+    });
+    client->onDisconnect([this](void* v, AsyncClient* c) {
+      xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+      Connection* connection = this->find(c);
+      if(connection != NULL && connection->state == eIdle) {
+        ESP_LOGI(LogTag, "idle connection closed by server.");
+        connection->state = eFree;
+      }
+
+      xSemaphoreGiveRecursive(this->lock);
+    });
+    // Expire idle connections without waiting for the next acquire().
+    client->onPoll([this](void* v, AsyncClient* c) {
+      this->evict();
+    });
+
+    xSemaphoreGiveRecursive(this->lock);
+  }
+
+  void ConnectionPool::evict() {
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    const unsigned long now = millis();
+
+    for(size_t i = 0; i < kMaxConnections; i++) {
+      Connection& connection = this->connections[i];
+
+      if(connection.state == eIdle && now - connection.lastUsed > this->idleTimeout) {
+        ESP_LOGI(LogTag, "evicting idle connection to %s:%d.", connection.host, connection.port);
+
+        this->statistics.evictions++;
+        this->close(connection);
+      }
+    }
+
+    xSemaphoreGiveRecursive(this->lock);
+  }
+
+  const ConnectionPool::Statistics& ConnectionPool::getStatistics() const {
+    return this->statistics;
+  }
+
+  //
+  // - private
+  //
+  ConnectionPool::Connection* ConnectionPool::find(const AsyncClient* client) {
+    for(size_t i = 0; i < kMaxConnections; i++) {
+      if(&this->connections[i].client == client) {
+        return &this->connections[i];
+      }
+    }
+
+    return NULL;
+  }
+
+  void ConnectionPool::close(Connection& connection) {
+    // Mark free first, closing fires the disconnect handler.
+    connection.state = eFree;
+
+    connection.client.onConnect(nullptr);
+    connection.client.onData(nullptr);
+    connection.client.onDisconnect(nullptr);
+    connection.client.onTimeout(nullptr);
+    connection.client.onError(nullptr);
+    connection.client.onAck(nullptr);
+    connection.client.onPoll(nullptr);
+
+    if(connection.client.connected() || connection.client.connecting()) {
+      connection.client.close(true);
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef _HTTP_CONNECTION_POOL_H_
+#define _HTTP_CONNECTION_POOL_H_
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+
+namespace Http {
+  // Keeps idle keep-alive connections around, keyed by host and port, so the
+  // next request to the same server skips DNS and the TCP handshake. The pool
+  // owns a fixed set of connections which are never deleted, clients borrow
+  // them with acquire() and hand them back with release(). acquire() runs on
+  // the caller's task, release() and the idle handlers on the AsyncTCP task,
+  // the slots are guarded by a lock.
+  class ConnectionPool {
+    public:
+      struct Statistics {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t evictions;
+      };
+
+      ConnectionPool(const uint32_t idleTimeout = 30000 /* in milliseconds */);
+      ~ConnectionPool();
+
+      // Returns an idle connection to host:port (isConnected is true), or a
+      // free connection that still needs to connect. Returns NULL if all
+      // connections are in use.
+      AsyncClient* acquire(const char* host, const uint16_t port, bool& isConnected);
+
+      // Hands a connection back. With keepAlive it's parked for reuse,
+      // otherwise it's closed.
+      void release(AsyncClient* client, const bool keepAlive);
+
+      // Closes connections that were idle for longer than the idle timeout.
+      // Also runs from the poll of every idle connection.
+      void evict();
+
+      const Statistics& getStatistics() const;
+
+    private:
+      static const size_t kMaxConnections = 3;
+      static const size_t kMaxHostLength = 64;
+
+      enum State {
+        eFree,
+        eBusy,
+        eIdle
+      };
+
+      struct Connection {
+        AsyncClient client;
+        State state;
+        char host[kMaxHostLength];
+        uint16_t port;
+        unsigned long lastUsed;
+      };
+
+      uint32_t idleTimeout;
+      SemaphoreHandle_t lock;
+      Statistics statistics;
+      Connection connections[kMaxConnections];
+
+      Connection* find(const AsyncClient* client);
+      void close(Connection& connection);
+  };
+}
+
+#endif // _HTTP_CONNECTION_POOL_H_
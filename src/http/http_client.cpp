@@ -1,235 +1,179 @@
 #include "http_client.h"
 #include <string.h>
-#include <cstdio>
 #include <stdlib.h>
+#include <algorithm>
 #include <esp_log.h>
 
 static const char LogTag[] PROGMEM = "HttpClient";
 
 namespace Http {
-  Client::Client(const uint32_t rxTimeout) {
-    this->tcp.setRxTimeout(rxTimeout);
-  }
-
-  Client::~Client() {}
+  Client::Client(const uint32_t rxTimeout, const size_t maxConcurrentRequests) : rxTimeout(rxTimeout) {
+    this->setMaxConcurrentRequests(maxConcurrentRequests);
 
-  bool Client::get(const String& uri, const std::function<void(bool, Response)> callback) {
-    ESP_LOGI(LogTag, "uri: %s", uri.c_str());
-
-    Uri::Uri u;
+    // Requests are queued from the caller's task and scheduled from the
+    // AsyncTCP task, starting a request can call back into schedule().
+    this->lock = xSemaphoreCreateRecursiveMutex();
 
-    bool success = Uri::UriParser::parse(uri, u);
-    if(!success) {
-      ESP_LOGE(LogTag, "invalid uri.");
-      callback(false, this->response);
-      return false;
+    for(size_t i = 0; i < kMaxConcurrentRequests; i++) {
+      this->requests[i].onIdle(std::bind(&Client::schedule, this));
     }
+  }
 
-    this->response.statusCode = 0;
-    this->callback = callback;
-
-    this->tcp.onConnect([this, u](void* v, AsyncClient* c) {
-      ESP_LOGI(LogTag, "connected %s:%d.", c->remoteIP().toString().c_str(), c->remotePort());
-
-      if(!SendRequest(u, c)) {
-        ESP_LOGI(LogTag, "connected call.");
-        this->callback(false, this->response);
-      }
-    });
-
-    this->tcp.onData(OnData, this);
-
-    // @ToDo: do we need a callback here?
-    this->tcp.onDisconnect([this](void* v, AsyncClient* c) {
-      ESP_LOGI(LogTag, "disconnected.");
-
-      if(this->callback) {
-        this->callback(false, this->response);
-      }
-    });
+  Client::~Client() {
+    vSemaphoreDelete(this->lock);
+  }
 
-    this->tcp.onTimeout([this](void* v, AsyncClient* c, uint32_t time) {
-      ESP_LOGE(LogTag, "timeout %d.", time);
+  bool Client::watchHeader(const char* name) {
+    bool success = true;
 
-      this->callback(false, this->response);
-    });
+    for(size_t i = 0; i < kMaxConcurrentRequests; i++) {
+      success &= this->requests[i].watchHeader(name);
+    }
 
-    this->tcp.onError([](void* v, AsyncClient* c, int8_t error) {
-      ESP_LOGE(LogTag, "error %d.", error);
+    return success;
+  }
 
-      // callback(false);
-    });
+  void Client::setConnectionPool(ConnectionPool* pool) {
+    this->pool = pool;
+  }
 
-    return this->tcp.connect(u.domain.c_str(), u.port);
+  void Client::setMaxConcurrentRequests(const size_t maxConcurrentRequests) {
+    this->maxConcurrentRequests = std::max((size_t)1, std::min(maxConcurrentRequests, (size_t)kMaxConcurrentRequests));
   }
 
-  //
-  // - private
-  //
-  void Client::onData(AsyncClient* c, char *data, size_t len) {
-
-    // Headers are always in the first response.
-    if(this->response.statusCode == 0) {
-      bool success = ParseResponse(data, len, response);
-      if(!success) {
-        c->stop();
-        this->callback(false, response);
-        this->callback = nullptr;
-        return;
-      }
+  void Client::setCACert(const char* caCert) {
+    this->caCert = caCert;
+  }
 
-      this->contentReceivedLength = response.body.length();
-      this->contentLength = atol(response.headers["Content-Length"].c_str());
-    } else {
-      this->contentReceivedLength += len;
+  void Client::setConditionalRequests(const bool enabled) {
+    this->useConditionalRequests = enabled;
+  }
 
-      memcpy(this->buffer, data, len);
-      this->buffer[len] = '\0';
+  void Client::setCompression(const bool enabled) {
+    this->useCompression = enabled;
+  }
 
-      this->response.body.concat(buffer);
-    }
+  void Client::setResolver(Dns::Resolver* resolver) {
+    this->resolver = resolver;
+  }
 
-    if(this->contentReceivedLength >= this->contentLength && this->callback) {
-      c->stop();
-      this->callback(true, response);
-      this->callback = nullptr;
-    }
+  void Client::setUserAgent(const char* userAgent) {
+    this->userAgent = userAgent;
   }
 
-  void Client::OnData(void* v, AsyncClient* c, void *data, size_t len) {
-    Client *self = static_cast<Client*>(v);
+  void Client::forgetValidators(const String& uri) {
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+    this->validatorCache.remove(uri);
+    xSemaphoreGiveRecursive(this->lock);
+  }
 
-    if(self != NULL) {
-      char* rawData = reinterpret_cast<char*>(data);
-      self->onData(c, rawData, len);
-    }
+  const TlsSessionCache::Statistics& Client::getTlsStatistics() const {
+    return this->sessionCache.getStatistics();
   }
 
-  //
-  // - Static
-  //
-  bool Client::ParseResponse(char* rawData, const size_t len, Response& res) {
-    static const size_t kEndOfResponseHeaderLength = 4;
-    size_t i = 0;
-    char* line = rawData;
-    char* position = line;
-    bool isFirstline = true;
-    bool success = true;
+  bool Client::get(const String& uri, const ResponseCallback callback) {
+    return this->get(uri, nullptr, callback);
+  }
 
-    for(; i < len - kEndOfResponseHeaderLength; i++) {
-      if(rawData[i] == '\r' && rawData[i + 1] == '\n') {
-        rawData[i] = '\0';
-
-        // The first line in the response contains the status line. Parse that
-        // first then continue with parsing normal header fields.
-        if(isFirstline) {
-          isFirstline = false;
-          if(!ParseResponseStatusLine(line, i, res)) {
-            success = false;
-            break;
-          }
-        } else if(!ParseResponseHeaderField(line, i, res)) {
-          success = false;
-          break;
-        }
+  bool Client::get(const String& uri, const BodyCallback onBody, const ResponseCallback callback) {
+    ESP_LOGI(LogTag, "uri: %s", uri.c_str());
 
-        // The end of the header is marked by a double cr lf. Check if there's
-        // space in the buffer and for (another) cr lf combo.
-        // Otherwise check if there's space and move to the next header field.
-        if(i + kEndOfResponseHeaderLength < len && rawData[i + 2] == '\r' && rawData[i + 3] == '\n') {
-          line = &rawData[i + kEndOfResponseHeaderLength];
-          break;
-        } else if(i + 2 < len) {
-          line = &rawData[i + 2];
-        } else {
-          ESP_LOGE(LogTag, "could not parse response header fields.");
-          success = false;
-          break;
-        }
-      } else {
-        (++position) = &rawData[i];
-      }
-    }
+    Uri::Uri u;
 
-    if(success && (i + kEndOfResponseHeaderLength) < len) {
-      res.body = String(line);
-    } else {
-      res.body = String("");
+    bool success = uri.length() < Request::kMaxUriLength && Uri::UriParser::parse(uri, u);
+    if(!success) {
+      ESP_LOGE(LogTag, "invalid uri.");
+      callback(false, Response());
+      return false;
     }
 
-    return true;
-  }
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
 
-  bool Client::ParseResponseStatusLine(char* line, const size_t lineLength, Response& response) {
-    static const char kStatusLine[] PROGMEM = "HTTP/1.1 ";
-    static const size_t kStatusLineLength = strlen(kStatusLine);
+    if(this->pendingRequests.size() >= kMaxPendingRequests) {
+      xSemaphoreGiveRecursive(this->lock);
 
-    if(lineLength < kStatusLineLength) {
+      ESP_LOGE(LogTag, "too many pending requests.");
+      callback(false, Response());
       return false;
     }
 
-    // Check if status line starts with "HTTP/1.1 ".
-    if(strncmp(line, kStatusLine, kStatusLineLength) == 0) {
-      // Pointer to where the status code starts, it starts right after HTTP/1.1
-      // and up to the first space.
-      const char* statusCode = &line[kStatusLineLength];
+    PendingRequest pendingRequest;
+    strcpy(pendingRequest.uri, uri.c_str());
+    pendingRequest.parts = u;
+    pendingRequest.hasValidators = false;
+    pendingRequest.onBody = onBody;
+    pendingRequest.callback = callback;
+
+    if(this->useConditionalRequests) {
+      pendingRequest.hasValidators = this->validatorCache.get(uri, pendingRequest.validators);
+
+      // Keep the validators of a full response for the next request.
+      pendingRequest.callback = [this, uri, callback](bool success, const Response& response) {
+        if(success && response.statusCode == 200) {
+          xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+          this->validatorCache.put(uri, response.headers);
+          xSemaphoreGiveRecursive(this->lock);
+        }
 
-      // Find the position of the first space and replace it with a
-      // null terminating char (\0).
-      const size_t endOfStatusCodePosition = strcspn(statusCode, " ");
+        callback(success, response);
+      };
+    }
 
-      if((kStatusLineLength + endOfStatusCodePosition) >= lineLength) {
-        ESP_LOGE(LogTag, "could not find status code in status line.");
-        return false;
-      }
+    this->pendingRequests.push_back(pendingRequest);
+    this->schedule();
 
-      char* endOfStatusCode = (char*)&statusCode[endOfStatusCodePosition];
-      *endOfStatusCode = '\0';
+    xSemaphoreGiveRecursive(this->lock);
 
-      response.statusCode = atoi(statusCode);
+    return true;
+  }
 
-      // The reason message starts right after the status code, the String
-      // is already null terminated.
-      if((endOfStatusCodePosition + kStatusLineLength) >= lineLength) {
-        ESP_LOGE(LogTag, "could not find reason message in status line.");
-        return false;
-      }
+  //
+  // - private
+  //
+  size_t Client::numberOfActiveRequests() const {
+    size_t count = 0;
 
-      //
-      response.reasonMessage = String(++endOfStatusCode);
-    } else {
-      ESP_LOGE(LogTag, "invalid status line.");
-      return false;
+    for(size_t i = 0; i < kMaxConcurrentRequests; i++) {
+      if(this->requests[i].isBusy()) {
+        count++;
+      }
     }
 
-    return true;
+    return count;
   }
 
-  bool Client::ParseResponseHeaderField(char* line, const size_t lineLength, Response& response) {
-    // Find position of : char in line and replace with terminating char.
-    const size_t keyPosition = strcspn(line, ":");
-    line[keyPosition] = '\0';
-
-    if(keyPosition + 2 < lineLength) {
-      response.headers.insert(std::make_pair(line, &line[keyPosition + 2]));
+  void Client::schedule() {
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
 
-      return true;
-    } else {
-      ESP_LOGE(LogTag, "could not parse header field.");
-      return false;
-    }
-  }
+    for(size_t i = 0; i < kMaxConcurrentRequests && !this->pendingRequests.empty(); i++) {
+      if(this->requests[i].isBusy()) {
+        continue;
+      }
 
-  // @ToDo: optimize.
-  bool Client::SendRequest(const Uri::Uri& u, AsyncClient* c) {
-    String requestLine = "GET " + u.path + " HTTP/1.1\r\nHost: " + u.domain + "\r\n\r\n";
-    if(c->space() > requestLine.length() && c->canSend()) {
-      c->add(requestLine.c_str(), requestLine.length());
-      c->send();
+      if(this->numberOfActiveRequests() >= this->maxConcurrentRequests) {
+        break;
+      }
 
-      return true;
+      // Take it off the queue before starting, start() may call back right
+      // away and end up in here again.
+      PendingRequest pendingRequest = this->pendingRequests.front();
+      this->pendingRequests.pop_front();
+
+      const RequestOptions options = {
+        this->rxTimeout,
+        this->pool,
+        &this->sessionCache,
+        this->caCert,
+        pendingRequest.hasValidators ? &pendingRequest.validators : NULL,
+        this->useCompression,
+        this->userAgent,
+        this->resolver
+      };
+
+      this->requests[i].start(pendingRequest.uri, pendingRequest.parts, options, pendingRequest.onBody, pendingRequest.callback);
     }
 
-    return false;
+    xSemaphoreGiveRecursive(this->lock);
   }
 }
+
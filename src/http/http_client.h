@@ -3,38 +3,92 @@
 
 #include <Arduino.h>
 #include <AsyncTCP.h>
-#include <map>
+#include <list>
 #include "uri_parser.h"
+#include "request.h"
+#include "connection_pool.h"
 
 namespace Http {
-  struct Response {
-    std::map<String, String> headers;
-    String body;
-    uint16_t statusCode;
-    String reasonMessage;
-  };
-
   class Client {
     public:
-      Client(const uint32_t rxTimeout = 10 /* in seconds */ );
+      static const size_t kMaxConcurrentRequests = 3;
+
+      Client(const uint32_t rxTimeout = 10 /* in seconds */,
+             const size_t maxConcurrentRequests = kMaxConcurrentRequests);
       ~Client();
-      bool get(const String& uri, const std::function<void(bool, Response)> callback);
+      bool get(const String& uri, const ResponseCallback callback);
+
+      // Streams the body to onBody instead of collecting it in Response::body,
+      // callback marks the end of the body (or a failure).
+      bool get(const String& uri, const BodyCallback onBody, const ResponseCallback callback);
+
+      // Keep the value of an additional response header field, name must
+      // have static storage (e.g. PROGMEM constant).
+      bool watchHeader(const char* name);
+
+      // Reuse keep-alive connections from pool, NULL (default) opens and
+      // closes a connection for every request.
+      void setConnectionPool(ConnectionPool* pool);
+
+      // Number of requests that run at the same time, up to
+      // kMaxConcurrentRequests. Requests over the limit are queued.
+      void setMaxConcurrentRequests(const size_t maxConcurrentRequests);
+
+      // PEM encoded root certificate used to verify https servers. Without
+      // one the server certificate isn't verified.
+      void setCACert(const char* caCert);
+
+      // Remember ETag/Last-Modified of successful responses and make the next
+      // request for the same URI conditional. Callers then need to handle
+      // 304 Not Modified, which comes without a body.
+      void setConditionalRequests(const bool enabled);
+
+      // Drop the validators of uri, e.g. when its last body turned out to be
+      // unusable and a full response is needed.
+      void forgetValidators(const String& uri);
+
+      // Ask servers for gzip/deflate compressed bodies. Inflating needs a
+      // 32 KB window (plus ~11 KB state) on the heap while a compressed body
+      // is received, so it's a trade of RAM for transfer time.
+      void setCompression(const bool enabled);
+
+      // Look up host names through resolver instead of on every connect.
+      void setResolver(Dns::Resolver* resolver);
+
+      // Sent as User-Agent with every request, must have static storage.
+      void setUserAgent(const char* userAgent);
+
+      // Handshake time and session resumption counters for https requests.
+      const TlsSessionCache::Statistics& getTlsStatistics() const;
 
     private:
-      AsyncClient tcp;
-      Response response;
-      size_t contentReceivedLength = 0;
-      size_t contentLength = 0;
-      std::function<void(bool, Response)> callback;
-      // @ToDo: find better solution.
-      char buffer[4096];
-
-      void onData(AsyncClient* c, char *data, size_t len);
-      static void OnData(void* v, AsyncClient* c, void *data, size_t len);
-      static bool SendRequest(const Uri::Uri& u, AsyncClient* c);
-      static bool ParseResponse(char* rawData, const size_t len, Response& res);
-      static bool ParseResponseStatusLine(char* line, const size_t lineLength, Response& response);
-      static bool ParseResponseHeaderField(char* line, const size_t lineLength, Response& response);
+      static const size_t kMaxPendingRequests = 4;
+
+      struct PendingRequest {
+        char uri[Request::kMaxUriLength];
+        Uri::Uri parts;
+        bool hasValidators;
+        Validators validators;
+        BodyCallback onBody;
+        ResponseCallback callback;
+      };
+
+      uint32_t rxTimeout;
+      size_t maxConcurrentRequests;
+      ConnectionPool* pool = NULL;
+      const char* caCert = NULL;
+      TlsSessionCache sessionCache;
+      bool useConditionalRequests = false;
+      bool useCompression = false;
+      const char* userAgent = NULL;
+      Dns::Resolver* resolver = NULL;
+      ValidatorCache validatorCache;
+      SemaphoreHandle_t lock;
+      Request requests[kMaxConcurrentRequests];
+      std::list<PendingRequest> pendingRequests;
+
+      size_t numberOfActiveRequests() const;
+      void schedule();
   };
 }
 
@@ -0,0 +1,210 @@
+#include "inflate_stream.h"
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <esp_log.h>
+
+static const char LogTag[] PROGMEM = "HttpInflateStream";
+
+namespace Http {
+  InflateStream::InflateStream() {}
+
+  InflateStream::~InflateStream() {
+    this->end();
+  }
+
+  InflateStream::Encoding InflateStream::EncodingFromHeader(const char* contentEncoding) {
+    if(contentEncoding == NULL || contentEncoding[0] == '\0' || strcasecmp(contentEncoding, "identity") == 0) {
+      return eIdentity;
+    } else if(strcasecmp(contentEncoding, "gzip") == 0 || strcasecmp(contentEncoding, "x-gzip") == 0) {
+      return eGzip;
+    } else if(strcasecmp(contentEncoding, "deflate") == 0) {
+      return eDeflate;
+    }
+
+    return eUnsupported;
+  }
+
+  bool InflateStream::begin(const Encoding encoding) {
+    this->end();
+
+    if(encoding != eGzip && encoding != eDeflate) {
+      return false;
+    }
+
+    // Deflate allows back references up to 32 KB, the window has to be the
+    // full size.
+    this->inflator = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+    this->window = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+
+    if(this->inflator == NULL || this->window == NULL) {
+      ESP_LOGE(LogTag, "not enough memory to inflate.");
+      this->end();
+      return false;
+    }
+
+    tinfl_init(this->inflator);
+
+    this->windowOffset = 0;
+    this->headerOffset = 0;
+    this->gzipFlags = 0;
+
+    // Content-Encoding deflate is zlib wrapped, for gzip we skip the header
+    // ourselves and inflate the raw stream.
+    if(encoding == eGzip) {
+      this->state = eGzipHeader;
+      this->flags = TINFL_FLAG_HAS_MORE_INPUT;
+    } else {
+      this->state = eInflate;
+      this->flags = TINFL_FLAG_HAS_MORE_INPUT | TINFL_FLAG_PARSE_ZLIB_HEADER;
+    }
+
+    return true;
+  }
+
+  void InflateStream::end() {
+    free(this->inflator);
+    free(this->window);
+
+    this->inflator = NULL;
+    this->window = NULL;
+    this->state = eDone;
+  }
+
+  bool InflateStream::write(const char* data, size_t len, const BodyCallback& onData) {
+    const uint8_t* input = (const uint8_t*)data;
+
+    if(this->state < eInflate) {
+      const size_t consumed = this->parseGzipHeader(input, len);
+
+      input += consumed;
+      len -= consumed;
+    }
+
+    while(this->state == eInflate) {
+      size_t inputLength = len;
+      size_t outputLength = TINFL_LZ_DICT_SIZE - this->windowOffset;
+
+      const tinfl_status status = tinfl_decompress(this->inflator,
+                                                   input,
+                                                   &inputLength,
+                                                   this->window,
+                                                   this->window + this->windowOffset,
+                                                   &outputLength,
+                                                   this->flags);
+
+      input += inputLength;
+      len -= inputLength;
+
+      if(outputLength > 0) {
+        onData((const char*)(this->window + this->windowOffset), outputLength);
+        this->windowOffset = (this->windowOffset + outputLength) & (TINFL_LZ_DICT_SIZE - 1);
+      }
+
+      if(status == TINFL_STATUS_DONE) {
+        // Whatever follows (the gzip trailer) isn't needed.
+        this->state = eDone;
+      } else if(status < TINFL_STATUS_DONE) {
+        ESP_LOGE(LogTag, "corrupt compressed data (%d).", status);
+        this->state = eError;
+      } else if(status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) {
+        break;
+      }
+    }
+
+    return this->state != eError;
+  }
+
+  bool InflateStream::isDone() const {
+    return this->state == eDone;
+  }
+
+  //
+  // - private
+  //
+  size_t InflateStream::parseGzipHeader(const uint8_t* data, size_t len) {
+    size_t i = 0;
+
+    for(; i < len && this->state < eInflate; i++) {
+      const uint8_t c = data[i];
+
+      switch(this->state) {
+        case eGzipHeader:
+          // Magic (0x1f 0x8b) and compression method 8 (deflate), followed
+          // by flags, time, extra flags and OS.
+          if((this->headerOffset == 0 && c != 0x1f)
+            || (this->headerOffset == 1 && c != 0x8b)
+            || (this->headerOffset == 2 && c != 8)) {
+            ESP_LOGE(LogTag, "invalid gzip header.");
+            this->state = eError;
+            break;
+          }
+
+          if(this->headerOffset == 3) {
+            this->gzipFlags = c;
+          }
+
+          if(++this->headerOffset == kGzipHeaderLength) {
+            this->headerOffset = 0;
+            this->extraLength = 0;
+            this->nextGzipHeaderField();
+          }
+          break;
+        case eGzipExtraLength:
+          this->extraLength |= (size_t)c << (8 * this->headerOffset);
+
+          if(++this->headerOffset == 2) {
+            this->headerOffset = 0;
+            this->state = eGzipExtra;
+
+            if(this->extraLength == 0) {
+              this->nextGzipHeaderField();
+            }
+          }
+          break;
+        case eGzipExtra:
+          if(--this->extraLength == 0) {
+            this->nextGzipHeaderField();
+          }
+          break;
+        case eGzipName:
+        case eGzipComment:
+          // Zero terminated strings.
+          if(c == 0) {
+            this->nextGzipHeaderField();
+          }
+          break;
+        case eGzipHeaderCrc:
+          if(++this->headerOffset == 2) {
+            this->headerOffset = 0;
+            this->nextGzipHeaderField();
+          }
+          break;
+        default:
+          break;
+      }
+    }
+
+    return i;
+  }
+
+  void InflateStream::nextGzipHeaderField() {
+    // Optional fields follow in this order, each flag is cleared once the
+    // field is skipped.
+    if(this->gzipFlags & kGzipFlagExtra) {
+      this->gzipFlags &= ~kGzipFlagExtra;
+      this->state = eGzipExtraLength;
+    } else if(this->gzipFlags & kGzipFlagName) {
+      this->gzipFlags &= ~kGzipFlagName;
+      this->state = eGzipName;
+    } else if(this->gzipFlags & kGzipFlagComment) {
+      this->gzipFlags &= ~kGzipFlagComment;
+      this->state = eGzipComment;
+    } else if(this->gzipFlags & kGzipFlagHeaderCrc) {
+      this->gzipFlags &= ~kGzipFlagHeaderCrc;
+      this->state = eGzipHeaderCrc;
+    } else {
+      this->state = eInflate;
+    }
+  }
+}
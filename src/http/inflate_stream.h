@@ -0,0 +1,71 @@
+#ifndef _HTTP_INFLATE_STREAM_H_
+#define _HTTP_INFLATE_STREAM_H_
+
+#include <Arduino.h>
+#include "rom/miniz.h"
+#include "response_parser.h"
+
+namespace Http {
+  static const char kContentEncoding[] PROGMEM = "Content-Encoding";
+
+  // Streaming gzip/deflate decoder between the response parser and the body
+  // callback, backed by the inflater in the ESP32 ROM. The window and the
+  // decompressor state are only allocated while a compressed body is being
+  // received.
+  class InflateStream {
+    public:
+      enum Encoding {
+        eIdentity,
+        eGzip,
+        eDeflate,
+        eUnsupported
+      };
+
+      InflateStream();
+      ~InflateStream();
+
+      static Encoding EncodingFromHeader(const char* contentEncoding);
+
+      bool begin(const Encoding encoding);
+      void end();
+
+      // Inflates len bytes and passes the decoded data on to onData, returns
+      // false on corrupt data.
+      bool write(const char* data, size_t len, const BodyCallback& onData);
+
+      bool isDone() const;
+
+    private:
+      enum State {
+        eGzipHeader,
+        eGzipExtraLength,
+        eGzipExtra,
+        eGzipName,
+        eGzipComment,
+        eGzipHeaderCrc,
+        eInflate,
+        eDone,
+        eError
+      };
+
+      static const uint8_t kGzipFlagHeaderCrc = 0x02;
+      static const uint8_t kGzipFlagExtra = 0x04;
+      static const uint8_t kGzipFlagName = 0x08;
+      static const uint8_t kGzipFlagComment = 0x10;
+      static const size_t kGzipHeaderLength = 10;
+
+      State state = eDone;
+      uint32_t flags = 0;
+      uint8_t gzipFlags = 0;
+      size_t headerOffset = 0;
+      size_t extraLength = 0;
+      tinfl_decompressor* inflator = NULL;
+      uint8_t* window = NULL;
+      size_t windowOffset = 0;
+
+      size_t parseGzipHeader(const uint8_t* data, size_t len);
+      void nextGzipHeaderField();
+  };
+}
+
+#endif // _HTTP_INFLATE_STREAM_H_
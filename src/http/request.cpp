@@ -0,0 +1,522 @@
+#include "request.h"
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <esp_log.h>
+
+static const char LogTag[] PROGMEM = "HttpRequest";
+
+namespace Http {
+  static const char kMethodGet[] PROGMEM = "GET ";
+  static const char kRootPath[] PROGMEM = "/";
+  static const char kVersion[] PROGMEM = " HTTP/1.1\r\n";
+  static const char kHeaderDivider[] PROGMEM = ": ";
+  static const char kLineEnd[] PROGMEM = "\r\n";
+  static const char kHost[] PROGMEM = "Host";
+  static const char kKeepAlive[] PROGMEM = "keep-alive";
+  static const char kClose[] PROGMEM = "close";
+  static const char kUserAgent[] PROGMEM = "User-Agent";
+  static const char kAcceptEncoding[] PROGMEM = "Accept-Encoding";
+  static const char kGzipDeflate[] PROGMEM = "gzip, deflate";
+  static const char kIfNoneMatch[] PROGMEM = "If-None-Match";
+  static const char kIfModifiedSince[] PROGMEM = "If-Modified-Since";
+
+  Request::Request() : options(), parser(response.headers) {
+    this->bodySink = std::bind(&Request::onBody, this, std::placeholders::_1, std::placeholders::_2);
+    this->decodedBodySink = std::bind(&Request::onDecodedBody, this, std::placeholders::_1, std::placeholders::_2);
+    this->writeSink = std::bind(&Request::write, this, std::placeholders::_1, std::placeholders::_2);
+
+    this->response.headers.watch(kContentLength);
+    this->response.headers.watch(kTransferEncoding);
+    this->response.headers.watch(kConnection);
+    this->response.headers.watch(kETag);
+    this->response.headers.watch(kLastModified);
+    this->response.headers.watch(kContentEncoding);
+  }
+
+  Request::~Request() {
+    this->release(false);
+
+    delete this->secure;
+  }
+
+  bool Request::watchHeader(const char* name) {
+    return this->response.headers.watch(name);
+  }
+
+  void Request::onIdle(const std::function<void()> callback) {
+    this->idleCallback = callback;
+  }
+
+  bool Request::isBusy() const {
+    return this->isActive;
+  }
+
+  bool Request::start(const char* uri,
+                      const Uri::Uri& parts,
+                      const RequestOptions& options,
+                      const BodyCallback onBody,
+                      const ResponseCallback callback) {
+    this->options = options;
+    this->hasValidators = options.validators != NULL;
+    if(this->hasValidators) {
+      this->validators = *options.validators;
+    }
+    this->options.validators = NULL;
+    this->parser.reset();
+    this->writer.reset();
+    this->isInflating = false;
+    this->isBodyCorrupt = false;
+    this->response.statusCode = 0;
+    this->response.reasonMessage = "";
+    this->response.receivedBytes = 0;
+    this->response.body = "";
+    this->callback = callback;
+    this->bodyCallback = onBody;
+    this->isActive = true;
+
+    if(strlen(uri) >= kMaxUriLength || !Uri::UriParser::copy(uri, parts.host, this->host, kMaxHostLength)) {
+      ESP_LOGE(LogTag, "uri too long.");
+      this->complete(false);
+      return false;
+    }
+
+    strcpy(this->uriBuffer, uri);
+    this->uri = parts;
+
+    // The fragment is never sent, cut it off so path and query can be
+    // written straight from the buffer.
+    if(parts.fragment.offset > 0) {
+      this->uriBuffer[parts.fragment.offset - 1] = '\0';
+    }
+
+    return this->connect();
+  }
+
+  //
+  // - private
+  //
+  bool Request::connect() {
+    bool isConnected = false;
+    AsyncClient* c = NULL;
+
+    // Without a pool, or when all pooled connections are busy, fall back to
+    // a connection of our own.
+    if(this->isPooled()) {
+      c = this->options.pool->acquire(this->host, this->uri.port, isConnected);
+    }
+
+    if(c == NULL) {
+      c = &this->connection;
+    }
+
+    this->tcp = c;
+    this->isReusedConnection = isConnected;
+    this->didReceiveData = false;
+
+    c->setRxTimeout(this->options.rxTimeout);
+    c->onConnect([this](void* v, AsyncClient* c) {
+      this->onConnect(c);
+    });
+    c->onData(OnData, this);
+    c->onDisconnect([this](void* v, AsyncClient* c) {
+      this->onDisconnect(c);
+    });
+    c->onTimeout([this](void* v, AsyncClient* c, uint32_t time) {
+      if(c == this->tcp) {
+        ESP_LOGE(LogTag, "timeout %d.", time);
+
+        this->release(false);
+        this->complete(false);
+      }
+    });
+    c->onAck([this](void* v, AsyncClient* c, size_t len, uint32_t time) {
+      // Room in the send window again, continue the handshake or writing
+      // the request.
+      if(c == this->tcp) {
+        if(this->secure != NULL) {
+          this->secure->acknowledged();
+        }
+
+        this->flushRequest();
+      }
+    });
+    c->onError([](void* v, AsyncClient* c, int8_t error) {
+      ESP_LOGE(LogTag, "error %d.", error);
+    });
+
+    if(isConnected) {
+      this->onConnect(c);
+      return true;
+    }
+
+    if(this->options.resolver != NULL) {
+      const uint32_t attempt = ++this->connectAttempt;
+
+      // Called right away for a cached address, otherwise from the
+      // resolver task, never the lwIP one (see Dns::Resolver). By then the
+      // request may have failed or moved on.
+      return this->options.resolver->resolve(this->host, [this, c, attempt](bool success, const IPAddress& address) {
+        if(c != this->tcp || attempt != this->connectAttempt) {
+          return;
+        }
+
+        if(!success || !c->connect(address, this->uri.port)) {
+          ESP_LOGE(LogTag, "could not connect to %s:%d.", this->host, this->uri.port);
+
+          this->release(false);
+          this->complete(false);
+        }
+      });
+    }
+
+    if(!c->connect(this->host, this->uri.port)) {
+      ESP_LOGE(LogTag, "could not connect to %s:%d.", this->host, this->uri.port);
+
+      this->release(false);
+      this->complete(false);
+      return false;
+    }
+
+    return true;
+  }
+
+  void Request::release(const bool keepAlive) {
+    AsyncClient* c = this->tcp;
+
+    // Forget the connection first, closing it fires the disconnect handler.
+    this->tcp = NULL;
+
+    if(c == NULL) {
+      return;
+    }
+
+    if(this->secure != NULL) {
+      this->secure->end();
+    }
+
+    if(this->isPooled() && c != &this->connection) {
+      this->options.pool->release(c, keepAlive);
+    } else if(c->connected() || c->connecting()) {
+      c->close(true);
+    }
+  }
+
+  void Request::onConnect(AsyncClient* c) {
+    if(c != this->tcp) {
+      return;
+    }
+
+    ESP_LOGI(LogTag, "connected %s:%d.", c->remoteIP().toString().c_str(), c->remotePort());
+
+    if(this->uri.scheme != Uri::https) {
+      this->sendRequest();
+      return;
+    }
+
+    // The request goes out once the TLS handshake is done, created on first
+    // use so plain HTTP requests don't pay for it.
+    if(this->secure == NULL) {
+      this->secure = new SecureTransport();
+    }
+
+    this->secure->begin(c,
+                        this->host,
+                        this->uri.port,
+                        this->options.caCert,
+                        this->options.sessionCache,
+                        [this]() {
+                          this->sendRequest();
+                        },
+                        [this](const char* data, size_t len) {
+                          this->onData(this->tcp, (char*)data, len);
+                        },
+                        [this]() {
+                          this->release(false);
+                          this->complete(false);
+                        });
+  }
+
+  void Request::onDisconnect(AsyncClient* c) {
+    if(c != this->tcp) {
+      return;
+    }
+
+    ESP_LOGI(LogTag, "disconnected.");
+
+    // The server may have closed a pooled connection right when we reused
+    // it, in that case retry on a new connection.
+    if(this->isReusedConnection && !this->didReceiveData && this->callback) {
+      ESP_LOGI(LogTag, "reused connection was closed, reconnecting.");
+
+      this->release(false);
+      this->connect();
+      return;
+    }
+
+    // A body without Content-Length or chunked encoding ends when the server
+    // closes the connection, anything else closing early is a failure.
+    const bool success = this->parser.finish() && (!this->isInflating || this->inflate.isDone());
+
+    this->release(false);
+    this->complete(success);
+  }
+
+  void Request::onReceive(AsyncClient* c, char *data, size_t len) {
+    if(c == this->tcp && this->secure != NULL && this->secure->isOpen()) {
+      this->secure->receive(data, len);
+    } else {
+      this->onData(c, data, len);
+    }
+  }
+
+  void Request::onData(AsyncClient* c, char *data, size_t len) {
+    if(c == NULL || c != this->tcp || !this->callback) {
+      return;
+    }
+
+    this->didReceiveData = true;
+    this->response.receivedBytes += len;
+
+    // The status line and header block can be split over any number of
+    // segments, feed them to the parser until it saw the end of the header.
+    if(!this->parser.isHeaderComplete()) {
+      const size_t consumed = this->parser.parse(data, len);
+
+      if(this->parser.hasError()) {
+        this->release(false);
+        this->complete(false);
+        return;
+      }
+
+      if(!this->parser.isHeaderComplete()) {
+        return;
+      }
+
+      this->response.statusCode = this->parser.getStatusCode();
+      this->response.reasonMessage = this->parser.getReasonMessage();
+
+      if(!this->beginBody()) {
+        this->release(false);
+        this->complete(false);
+        return;
+      }
+
+      // Whatever is left in this segment is the start of the body.
+      data += consumed;
+      len -= consumed;
+    }
+
+    if(!this->parser.parseBody(data, len, this->bodySink) || this->isBodyCorrupt) {
+      this->release(false);
+      this->complete(false);
+      return;
+    }
+
+    if(this->parser.isComplete()) {
+      // A compressed body that ends before the deflate stream did is
+      // truncated.
+      const bool success = !this->isInflating || this->inflate.isDone();
+
+      this->release(success && this->parser.isPersistent());
+      this->complete(success);
+    }
+  }
+
+  bool Request::beginBody() {
+    const char* contentEncoding = this->response.headers.get(kContentEncoding);
+    const InflateStream::Encoding encoding = InflateStream::EncodingFromHeader(contentEncoding);
+
+    // Responses without a body (e.g. 304) are complete right after the
+    // header, nothing to inflate.
+    if(encoding != InflateStream::eIdentity && !this->parser.isComplete()) {
+      if(encoding == InflateStream::eUnsupported) {
+        ESP_LOGE(LogTag, "unsupported content encoding %s.", contentEncoding);
+        return false;
+      }
+
+      this->isInflating = this->inflate.begin(encoding);
+      return this->isInflating;
+    }
+
+    // Content-Length is only the decoded size for identity bodies.
+    if(!this->bodyCallback && this->parser.getBodyFraming() == ResponseParser::eContentLength) {
+      this->response.body.reserve(this->parser.getContentLength());
+    }
+
+    return true;
+  }
+
+  void Request::complete(bool success) {
+    // Clear state before calling back, the callback may start a new request.
+    // The request stays busy until the callback returned so the response
+    // isn't reset while the callback is still reading it.
+    ResponseCallback callback = this->callback;
+
+    this->callback = nullptr;
+    this->bodyCallback = nullptr;
+
+    // Hand the inflate window back to the heap right away.
+    this->inflate.end();
+    this->isInflating = false;
+
+    if(callback) {
+      callback(success, this->response);
+    }
+
+    this->isActive = false;
+
+    if(this->idleCallback) {
+      this->idleCallback();
+    }
+  }
+
+  void Request::onBody(const char* data, size_t len) {
+    if(!this->isInflating) {
+      this->onDecodedBody(data, len);
+    } else if(!this->isBodyCorrupt && !this->inflate.write(data, len, this->decodedBodySink)) {
+      this->isBodyCorrupt = true;
+    }
+  }
+
+  void Request::onDecodedBody(const char* data, size_t len) {
+    if(this->bodyCallback) {
+      this->bodyCallback(data, len);
+      return;
+    }
+
+    // String has no public append for non terminated data, copy through a
+    // small stack buffer.
+    char buffer[128];
+
+    while(len > 0) {
+      const size_t length = std::min(len, sizeof(buffer) - 1);
+
+      memcpy(buffer, data, length);
+      buffer[length] = '\0';
+
+      this->response.body.concat(buffer);
+
+      data += length;
+      len -= length;
+    }
+  }
+
+  void Request::OnData(void* v, AsyncClient* c, void *data, size_t len) {
+    Request *self = static_cast<Request*>(v);
+
+    if(self != NULL) {
+      char* rawData = reinterpret_cast<char*>(data);
+      self->onReceive(c, rawData, len);
+    }
+  }
+
+  bool Request::sendRequest() {
+    const bool isDefaultPort = (this->uri.scheme == Uri::http && this->uri.port == 80)
+      || (this->uri.scheme == Uri::https && this->uri.port == 443);
+
+    RequestWriter& w = this->writer;
+
+    w.reset();
+
+    // Path and query follow each other in the buffer, a URI without a path
+    // still needs the /.
+    w.add(kMethodGet);
+    if(this->uri.path.length == 0) {
+      w.add(kRootPath);
+    }
+    w.add(this->uriBuffer + this->uri.path.offset);
+    w.add(kVersion);
+
+    w.add(kHost);
+    w.add(kHeaderDivider);
+    if(this->uri.isIPv6) {
+      w.add("[");
+      w.add(this->host);
+      w.add("]");
+    } else {
+      w.add(this->host);
+    }
+    if(!isDefaultPort) {
+      w.add(":");
+      w.add((uint32_t)this->uri.port);
+    }
+    w.add(kLineEnd);
+
+    w.addHeader(kConnection, this->isPooled() ? kKeepAlive : kClose);
+
+    if(this->options.userAgent != NULL) {
+      w.addHeader(kUserAgent, this->options.userAgent);
+    }
+
+    if(this->options.acceptEncoding) {
+      w.addHeader(kAcceptEncoding, kGzipDeflate);
+    }
+
+    if(this->hasValidators && this->validators.eTag[0] != '\0') {
+      w.addHeader(kIfNoneMatch, this->validators.eTag);
+    }
+
+    if(this->hasValidators && this->validators.lastModified[0] != '\0') {
+      w.addHeader(kIfModifiedSince, this->validators.lastModified);
+    }
+
+    w.end();
+
+    return this->flushRequest();
+  }
+
+  bool Request::flushRequest() {
+    AsyncClient* c = this->tcp;
+
+    if(c == NULL || this->writer.isDone()) {
+      return true;
+    }
+
+    const bool success = this->writer.flush(this->writeSink);
+
+    // A TLS error fails the request from within the sink.
+    if(c != this->tcp) {
+      return false;
+    }
+
+    if(!success) {
+      ESP_LOGE(LogTag, "could not send request.");
+
+      this->release(false);
+      this->complete(false);
+      return false;
+    }
+
+    if(this->secure == NULL || !this->secure->isOpen()) {
+      c->send();
+    }
+
+    return true;
+  }
+
+  int Request::write(const char* data, size_t len) {
+    if(this->secure != NULL && this->secure->isOpen()) {
+      return this->secure->write(data, len);
+    }
+
+    AsyncClient* c = this->tcp;
+    if(c == NULL || !c->connected()) {
+      return -1;
+    }
+
+    // Whatever doesn't fit goes out once the server acknowledged what's in
+    // flight.
+    const size_t space = c->space();
+    if(space == 0 || !c->canSend()) {
+      return 0;
+    }
+
+    return c->add(data, std::min(space, len));
+  }
+
+  bool Request::isPooled() const {
+    // TLS state lives in the request, so only plain connections are pooled.
+    return this->options.pool != NULL && this->uri.scheme == Uri::http;
+  }
+}
@@ -0,0 +1,115 @@
+#ifndef _HTTP_REQUEST_H_
+#define _HTTP_REQUEST_H_
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include "uri_parser.h"
+#include "response_parser.h"
+#include "connection_pool.h"
+#include "secure_transport.h"
+#include "validator_cache.h"
+#include "inflate_stream.h"
+#include "request_writer.h"
+#include "dns/resolver.h"
+
+namespace Http {
+  struct Response {
+    Headers headers;
+    String body;
+    uint16_t statusCode;
+    String reasonMessage;
+    // As received, status line, header and framing included, before the
+    // body is inflated.
+    uint32_t receivedBytes;
+  };
+
+  typedef std::function<void(bool, const Response&)> ResponseCallback;
+
+  struct RequestOptions {
+    uint32_t rxTimeout;
+    ConnectionPool* pool;
+    TlsSessionCache* sessionCache;
+    const char* caCert;
+    // Sent as If-None-Match/If-Modified-Since when not NULL.
+    const Validators* validators;
+    // Sends Accept-Encoding: gzip, deflate. Compressed bodies are inflated
+    // before they reach the body callback either way.
+    bool acceptEncoding;
+    // Sent as User-Agent when not NULL.
+    const char* userAgent;
+    // Host names are looked up through resolver when not NULL.
+    Dns::Resolver* resolver;
+  };
+
+  // State of a single in-flight request: its connection, parser, response
+  // and callbacks. Http::Client keeps a fixed number of these and runs them
+  // side by side.
+  class Request {
+    public:
+      static const size_t kMaxUriLength = 256;
+      static const size_t kMaxHostLength = 64;
+
+      Request();
+      ~Request();
+
+      bool watchHeader(const char* name);
+
+      // Called once a request finished and its callback returned, so the
+      // owner can schedule the next one.
+      void onIdle(const std::function<void()> callback);
+
+      bool isBusy() const;
+
+      // uri is copied, parts are the components parsed from it.
+      bool start(const char* uri,
+                 const Uri::Uri& parts,
+                 const RequestOptions& options,
+                 const BodyCallback onBody,
+                 const ResponseCallback callback);
+
+    private:
+      AsyncClient connection;
+      AsyncClient* tcp = NULL;
+      SecureTransport* secure = NULL;
+      RequestOptions options;
+      Uri::Uri uri;
+      char uriBuffer[kMaxUriLength];
+      char host[kMaxHostLength];
+      bool isActive = false;
+      bool isReusedConnection = false;
+      bool didReceiveData = false;
+      uint32_t connectAttempt = 0;
+      bool hasValidators = false;
+      bool isInflating = false;
+      bool isBodyCorrupt = false;
+      Validators validators;
+      Response response;
+      ResponseParser parser;
+      InflateStream inflate;
+      RequestWriter writer;
+      ResponseCallback callback;
+      BodyCallback bodyCallback;
+      BodyCallback bodySink;
+      BodyCallback decodedBodySink;
+      RequestWriter::Sink writeSink;
+      std::function<void()> idleCallback;
+
+      bool connect();
+      void release(const bool keepAlive);
+      bool isPooled() const;
+      void onConnect(AsyncClient* c);
+      void onDisconnect(AsyncClient* c);
+      void onReceive(AsyncClient* c, char *data, size_t len);
+      void onData(AsyncClient* c, char *data, size_t len);
+      static void OnData(void* v, AsyncClient* c, void *data, size_t len);
+      bool beginBody();
+      void onBody(const char* data, size_t len);
+      void onDecodedBody(const char* data, size_t len);
+      void complete(bool success);
+      bool sendRequest();
+      bool flushRequest();
+      int write(const char* data, size_t len);
+  };
+}
+
+#endif // _HTTP_REQUEST_H_
@@ -0,0 +1,109 @@
+#include "request_writer.h"
+#include "response_parser.h"
+#include <string.h>
+#include <stdio.h>
+#include <esp_log.h>
+
+static const char LogTag[] PROGMEM = "HttpRequestWriter";
+
+namespace Http {
+  static const char kHeaderDivider[] PROGMEM = ": ";
+  static const char kLineEnd[] PROGMEM = "\r\n";
+
+  RequestWriter::RequestWriter() {}
+
+  void RequestWriter::reset() {
+    this->numberOfPieces = 0;
+    this->numberOfNumbers = 0;
+    this->piece = 0;
+    this->offset = 0;
+    this->hasOverflow = false;
+  }
+
+  bool RequestWriter::add(const char* data, const size_t len) {
+    if(len == 0) {
+      return true;
+    }
+
+    if(this->numberOfPieces >= kMaxPieces || len > UINT16_MAX) {
+      this->hasOverflow = true;
+      return false;
+    }
+
+    this->pieces[this->numberOfPieces].data = data;
+    this->pieces[this->numberOfPieces].length = len;
+    this->numberOfPieces++;
+
+    return true;
+  }
+
+  bool RequestWriter::add(const char* data) {
+    return this->add(data, strlen(data));
+  }
+
+  bool RequestWriter::add(const uint32_t value) {
+    if(this->numberOfNumbers >= kMaxNumbers) {
+      this->hasOverflow = true;
+      return false;
+    }
+
+    char* number = this->numbers[this->numberOfNumbers++];
+    snprintf(number, kMaxNumberLength, "%u", value);
+
+    return this->add(number);
+  }
+
+  bool RequestWriter::addHeader(const char* name, const char* value) {
+    return this->add(name)
+      && this->add(kHeaderDivider)
+      && this->add(value)
+      && this->add(kLineEnd);
+  }
+
+  bool RequestWriter::end(const char* body, const size_t len) {
+    bool success = true;
+
+    if(body != NULL) {
+      success = this->add(kContentLength)
+        && this->add(kHeaderDivider)
+        && this->add((uint32_t)len)
+        && this->add(kLineEnd);
+    }
+
+    return success
+      && this->add(kLineEnd)
+      && (body == NULL || this->add(body, len));
+  }
+
+  bool RequestWriter::flush(const Sink& sink) {
+    if(this->hasOverflow) {
+      ESP_LOGE(LogTag, "request has too many parts.");
+      return false;
+    }
+
+    while(this->piece < this->numberOfPieces) {
+      const Piece& piece = this->pieces[this->piece];
+      const int written = sink(piece.data + this->offset, piece.length - this->offset);
+
+      if(written < 0) {
+        return false;
+      } else if(written == 0) {
+        // Full, the caller flushes again once data got acknowledged.
+        break;
+      }
+
+      this->offset += written;
+
+      if(this->offset >= piece.length) {
+        this->piece++;
+        this->offset = 0;
+      }
+    }
+
+    return true;
+  }
+
+  bool RequestWriter::isDone() const {
+    return this->piece >= this->numberOfPieces;
+  }
+}
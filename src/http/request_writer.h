@@ -0,0 +1,56 @@
+#ifndef _HTTP_REQUEST_WRITER_H_
+#define _HTTP_REQUEST_WRITER_H_
+
+#include <Arduino.h>
+#include <functional>
+
+namespace Http {
+  // Serializes a request without building it in memory first. The request
+  // is kept as a list of pieces pointing to the caller's strings, flush()
+  // writes as much as the connection takes and picks up where it left off
+  // on the next call. Pieces aren't copied, they have to stay valid until
+  // the request is written.
+  class RequestWriter {
+    public:
+      // Takes up to len bytes and returns how many it took, 0 when the
+      // connection is full for now and negative on an error.
+      typedef std::function<int(const char* data, size_t len)> Sink;
+
+      RequestWriter();
+
+      void reset();
+
+      bool add(const char* data, const size_t len);
+      bool add(const char* data);
+      bool add(const uint32_t value);
+      bool addHeader(const char* name, const char* value);
+
+      // Ends the header, with an optional body (Content-Length is added).
+      bool end(const char* body = NULL, const size_t len = 0);
+
+      // Returns false if the sink failed or the request didn't fit in the
+      // piece table.
+      bool flush(const Sink& sink);
+      bool isDone() const;
+
+    private:
+      static const size_t kMaxPieces = 40;
+      static const size_t kMaxNumbers = 2;
+      static const size_t kMaxNumberLength = 11;
+
+      struct Piece {
+        const char* data;
+        uint16_t length;
+      };
+
+      Piece pieces[kMaxPieces];
+      size_t numberOfPieces = 0;
+      char numbers[kMaxNumbers][kMaxNumberLength];
+      size_t numberOfNumbers = 0;
+      size_t piece = 0;
+      size_t offset = 0;
+      bool hasOverflow = false;
+  };
+}
+
+#endif // _HTTP_REQUEST_WRITER_H_
@@ -0,0 +1,514 @@
+#include "response_parser.h"
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <esp_log.h>
+
+static const char LogTag[] PROGMEM = "HttpResponseParser";
+
+namespace Http {
+  //
+  // - Headers
+  //
+  bool Headers::watch(const char* name) {
+    if(this->indexOf(name, strlen(name)) >= 0) {
+      return true;
+    }
+
+    if(this->numberOfFields >= kMaxFields) {
+      ESP_LOGE(LogTag, "header table full, not watching %s.", name);
+      return false;
+    }
+
+    Field& field = this->fields[this->numberOfFields++];
+    field.name = name;
+    field.value[0] = '\0';
+    field.valueLength = 0;
+    field.isPresent = false;
+    field.isTruncated = false;
+
+    return true;
+  }
+
+  void Headers::clear() {
+    for(size_t i = 0; i < this->numberOfFields; i++) {
+      this->fields[i].value[0] = '\0';
+      this->fields[i].valueLength = 0;
+      this->fields[i].isPresent = false;
+      this->fields[i].isTruncated = false;
+    }
+  }
+
+  bool Headers::has(const char* name) const {
+    const int index = this->indexOf(name, strlen(name));
+
+    return index >= 0 && this->fields[index].isPresent;
+  }
+
+  const char* Headers::get(const char* name) const {
+    const int index = this->indexOf(name, strlen(name));
+    if(index < 0 || !this->fields[index].isPresent) {
+      return NULL;
+    }
+
+    return this->fields[index].value;
+  }
+
+  bool Headers::isTruncated(const char* name) const {
+    const int index = this->indexOf(name, strlen(name));
+
+    return index >= 0 && this->fields[index].isPresent && this->fields[index].isTruncated;
+  }
+
+  int Headers::indexOf(const char* name, const size_t nameLength) const {
+    for(size_t i = 0; i < this->numberOfFields; i++) {
+      const char* fieldName = this->fields[i].name;
+
+      // Header field names are case-insensitive.
+      if(strlen(fieldName) == nameLength && strncasecmp(fieldName, name, nameLength) == 0) {
+        return i;
+      }
+    }
+
+    return -1;
+  }
+
+  //
+  // - ResponseParser
+  //
+  ResponseParser::ResponseParser(Headers& headers) : headers(headers) {
+    this->reset();
+  }
+
+  void ResponseParser::reset() {
+    this->beginStatusLine();
+    this->fieldNameLength = 0;
+    this->fieldIndex = -1;
+    this->bodyFraming = eContentLength;
+    this->contentLength = 0;
+    this->bodyLength = 0;
+    this->remainingLength = 0;
+    this->chunkSizeDigits = 0;
+  }
+
+  size_t ResponseParser::parse(const char* data, const size_t len) {
+    size_t i = 0;
+
+    for(; i < len && this->state < eBody; i++) {
+      const char c = data[i];
+
+      switch(this->state) {
+        case eVersion:
+          this->parseVersion(c);
+          break;
+        case eStatusCode:
+          this->parseStatusCode(c);
+          break;
+        case eReasonMessage:
+          if(c == '\r') {
+            this->reasonMessage[this->reasonMessageLength] = '\0';
+            this->state = eStatusLineEnd;
+          } else if(this->reasonMessageLength < kMaxReasonMessageLength - 1) {
+            this->reasonMessage[this->reasonMessageLength++] = c;
+          }
+          break;
+        case eStatusLineEnd:
+        case eHeaderLineEnd:
+          this->state = (c == '\n') ? eHeaderLineStart : eError;
+          break;
+        case eHeaderLineStart:
+          if(c == '\r') {
+            this->state = eHeaderBlockEnd;
+          } else {
+            this->fieldNameLength = 0;
+            this->fieldIndex = -1;
+            this->state = eHeaderFieldName;
+            this->parseHeaderFieldName(c);
+          }
+          break;
+        case eHeaderFieldName:
+          this->parseHeaderFieldName(c);
+          break;
+        case eHeaderFieldValueStart:
+          // Skip optional whitespace in front of the value.
+          if(c == ' ' || c == '\t') {
+            break;
+          }
+          this->state = eHeaderFieldValue;
+          this->parseHeaderFieldValue(c);
+          break;
+        case eHeaderFieldValue:
+          this->parseHeaderFieldValue(c);
+          break;
+        case eHeaderBlockEnd:
+          if(c != '\n') {
+            this->state = eError;
+          } else if(this->statusCode >= 100 && this->statusCode < 200 && this->statusCode != 101) {
+            // Interim response (e.g. 100 Continue), the final one follows.
+            this->beginStatusLine();
+          } else {
+            this->beginBody();
+          }
+          break;
+        default:
+          break;
+      }
+    }
+
+    if(this->state == eError) {
+      ESP_LOGE(LogTag, "invalid response header.");
+    }
+
+    return i;
+  }
+
+  bool ResponseParser::parseBody(const char* data, const size_t len, const BodyCallback& onBody) {
+    if(this->bodyFraming == eChunked) {
+      this->parseChunked(data, len, onBody);
+    } else if(this->state == eBody && len > 0) {
+      size_t length = len;
+
+      if(this->bodyFraming == eContentLength) {
+        length = std::min(len, this->remainingLength);
+        this->remainingLength -= length;
+
+        if(this->remainingLength == 0) {
+          this->state = eComplete;
+        }
+      }
+
+      this->bodyLength += length;
+      onBody(data, length);
+    }
+
+    return this->state != eError;
+  }
+
+  bool ResponseParser::finish() {
+    if(this->state == eBody && this->bodyFraming == eUntilClose) {
+      this->state = eComplete;
+    }
+
+    return this->isComplete();
+  }
+
+  bool ResponseParser::isHeaderComplete() const {
+    return this->state >= eBody && this->state != eError;
+  }
+
+  bool ResponseParser::isComplete() const {
+    return this->state == eComplete;
+  }
+
+  bool ResponseParser::hasError() const {
+    return this->state == eError;
+  }
+
+  bool ResponseParser::isPersistent() const {
+    static const char kClose[] PROGMEM = "close";
+
+    if(!this->isComplete() || this->minorVersion < 1 || this->bodyFraming == eUntilClose) {
+      return false;
+    }
+
+    const char* connection = this->headers.get(kConnection);
+
+    return connection == NULL || strcasecmp(connection, kClose) != 0;
+  }
+
+  ResponseParser::BodyFraming ResponseParser::getBodyFraming() const {
+    return this->bodyFraming;
+  }
+
+  size_t ResponseParser::getContentLength() const {
+    return this->contentLength;
+  }
+
+  size_t ResponseParser::getBodyLength() const {
+    return this->bodyLength;
+  }
+
+  uint16_t ResponseParser::getStatusCode() const {
+    return this->statusCode;
+  }
+
+  const char* ResponseParser::getReasonMessage() const {
+    return this->reasonMessage;
+  }
+
+  //
+  // - private
+  //
+  void ResponseParser::beginStatusLine() {
+    this->state = eVersion;
+    this->versionOffset = 0;
+    this->minorVersion = 0;
+    this->statusCode = 0;
+    this->reasonMessage[0] = '\0';
+    this->reasonMessageLength = 0;
+    this->headers.clear();
+  }
+
+  void ResponseParser::parseVersion(const char c) {
+    // The status line starts with "HTTP/1.0 " or "HTTP/1.1 ", versionOffset
+    // is the offset within that prefix since it may be split over segments.
+    static const char kVersionPrefix[] PROGMEM = "HTTP/1.";
+    static const size_t kVersionPrefixLength = sizeof(kVersionPrefix) - 1;
+
+    if(this->versionOffset < kVersionPrefixLength) {
+      if(c != kVersionPrefix[this->versionOffset]) {
+        this->state = eError;
+      }
+    } else if(this->versionOffset == kVersionPrefixLength) {
+      if(c != '0' && c != '1') {
+        this->state = eError;
+      }
+
+      this->minorVersion = c - '0';
+    } else if(c == ' ') {
+      this->state = eStatusCode;
+    } else {
+      this->state = eError;
+    }
+
+    this->versionOffset++;
+  }
+
+  void ResponseParser::parseStatusCode(const char c) {
+    if(c >= '0' && c <= '9' && this->statusCode < 100) {
+      this->statusCode = this->statusCode * 10 + (c - '0');
+    } else if(this->statusCode < 100) {
+      // Status code is always three digits.
+      this->state = eError;
+    } else if(c == ' ') {
+      this->state = eReasonMessage;
+    } else if(c == '\r') {
+      // Reason message is optional.
+      this->state = eStatusLineEnd;
+    } else {
+      this->state = eError;
+    }
+  }
+
+  void ResponseParser::parseHeaderFieldName(const char c) {
+    if(c == ':') {
+      this->fieldIndex = (this->fieldNameLength <= kMaxFieldNameLength)
+        ? this->headers.indexOf(this->fieldName, this->fieldNameLength)
+        : -1;
+
+      if(this->fieldIndex >= 0) {
+        Headers::Field& field = this->headers.fields[this->fieldIndex];
+        field.valueLength = 0;
+        field.value[0] = '\0';
+        field.isTruncated = false;
+      }
+
+      this->state = eHeaderFieldValueStart;
+    } else if(c == '\r' || c == '\n') {
+      this->state = eError;
+    } else if(this->fieldNameLength < kMaxFieldNameLength) {
+      this->fieldName[this->fieldNameLength++] = c;
+    } else {
+      // Too long to be any of the watched fields, mark it so it never
+      // matches.
+      this->fieldNameLength = kMaxFieldNameLength + 1;
+    }
+  }
+
+  void ResponseParser::parseHeaderFieldValue(const char c) {
+    if(c == '\r') {
+      this->endHeaderField();
+      this->state = eHeaderLineEnd;
+      return;
+    }
+
+    if(this->fieldIndex < 0) {
+      return;
+    }
+
+    Headers::Field& field = this->headers.fields[this->fieldIndex];
+    if(field.valueLength < Headers::kMaxValueLength - 1) {
+      field.value[field.valueLength++] = c;
+    } else if(c != ' ' && c != '\t') {
+      // Whitespace could still be trailing and get stripped.
+      field.isTruncated = true;
+    }
+  }
+
+  void ResponseParser::endHeaderField() {
+    if(this->fieldIndex < 0) {
+      return;
+    }
+
+    Headers::Field& field = this->headers.fields[this->fieldIndex];
+
+    // Strip trailing whitespace.
+    while(field.valueLength > 0 && (field.value[field.valueLength - 1] == ' ' || field.value[field.valueLength - 1] == '\t')) {
+      field.valueLength--;
+    }
+
+    field.value[field.valueLength] = '\0';
+    field.isPresent = true;
+  }
+
+  void ResponseParser::beginBody() {
+    static const char kChunked[] PROGMEM = "chunked";
+    static const size_t kChunkedLength = sizeof(kChunked) - 1;
+
+    const char* transferEncoding = this->headers.get(kTransferEncoding);
+    const char* contentLength = this->headers.get(kContentLength);
+
+    // Chunked is always the last transfer coding applied.
+    const size_t transferEncodingLength = transferEncoding ? strlen(transferEncoding) : 0;
+    if(transferEncodingLength >= kChunkedLength
+      && strcasecmp(&transferEncoding[transferEncodingLength - kChunkedLength], kChunked) == 0) {
+      this->bodyFraming = eChunked;
+      this->remainingLength = 0;
+      this->chunkSizeDigits = 0;
+      this->state = eChunkSize;
+    } else if(this->statusCode == 101 || this->statusCode == 204 || this->statusCode == 304) {
+      // These never have a body, other 1xx responses are skipped.
+      this->bodyFraming = eContentLength;
+      this->state = eComplete;
+    } else if(contentLength) {
+      // A length we can't be sure of (a sign, trailing garbage, cut off or
+      // too large) leaves no way to find the end of the body.
+      if(this->headers.isTruncated(kContentLength) || !ParseContentLength(contentLength, this->contentLength)) {
+        this->state = eError;
+        return;
+      }
+
+      this->bodyFraming = eContentLength;
+      this->remainingLength = this->contentLength;
+      this->state = this->remainingLength > 0 ? eBody : eComplete;
+    } else {
+      this->bodyFraming = eUntilClose;
+      this->state = eBody;
+    }
+  }
+
+  void ResponseParser::parseChunked(const char* data, const size_t len, const BodyCallback& onBody) {
+    size_t i = 0;
+
+    while(i < len && this->state != eComplete && this->state != eError) {
+      // Hand over as much chunk data as possible in one go.
+      if(this->state == eChunkData) {
+        const size_t length = std::min(len - i, this->remainingLength);
+
+        this->bodyLength += length;
+        this->remainingLength -= length;
+        onBody(&data[i], length);
+        i += length;
+
+        if(this->remainingLength == 0) {
+          this->state = eChunkDataEnd;
+        }
+        continue;
+      }
+
+      const char c = data[i++];
+
+      switch(this->state) {
+        case eChunkSize:
+          this->parseChunkSize(c);
+          break;
+        case eChunkExtension:
+          if(c == '\r') {
+            this->state = eChunkSizeLineEnd;
+          }
+          break;
+        case eChunkSizeLineEnd:
+          if(c != '\n') {
+            this->state = eError;
+          } else {
+            // A zero sized chunk ends the body, optionally followed by trailer
+            // fields.
+            this->state = this->remainingLength > 0 ? eChunkData : eTrailerLineStart;
+          }
+          break;
+        case eChunkDataEnd:
+          this->state = (c == '\r') ? eChunkDataLineEnd : eError;
+          break;
+        case eChunkDataLineEnd:
+          this->remainingLength = 0;
+          this->chunkSizeDigits = 0;
+          this->state = (c == '\n') ? eChunkSize : eError;
+          break;
+        case eTrailerLineStart:
+          this->state = (c == '\r') ? eTrailerEnd : eTrailerLine;
+          break;
+        case eTrailerLine:
+          if(c == '\r') {
+            this->state = eTrailerLineEnd;
+          }
+          break;
+        case eTrailerLineEnd:
+          this->state = (c == '\n') ? eTrailerLineStart : eError;
+          break;
+        case eTrailerEnd:
+          this->state = (c == '\n') ? eComplete : eError;
+          break;
+        default:
+          break;
+      }
+    }
+
+    if(this->state == eError) {
+      ESP_LOGE(LogTag, "invalid chunked body.");
+    }
+  }
+
+  void ResponseParser::parseChunkSize(const char c) {
+    int digit = -1;
+
+    if(c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if(c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if(c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    }
+
+    if(digit >= 0) {
+      // Guard against chunk sizes that don't fit.
+      if(this->remainingLength > (SIZE_MAX >> 4)) {
+        this->state = eError;
+      } else {
+        this->remainingLength = (this->remainingLength << 4) | digit;
+        this->chunkSizeDigits++;
+      }
+    } else if(this->chunkSizeDigits == 0) {
+      this->state = eError;
+    } else if(c == ';' || c == ' ' || c == '\t') {
+      this->state = eChunkExtension;
+    } else if(c == '\r') {
+      this->state = eChunkSizeLineEnd;
+    } else {
+      this->state = eError;
+    }
+  }
+
+  bool ResponseParser::ParseContentLength(const char* value, size_t& length) {
+    length = 0;
+
+    if(*value == '\0') {
+      return false;
+    }
+
+    for(; *value != '\0'; value++) {
+      if(*value < '0' || *value > '9') {
+        return false;
+      }
+
+      const size_t digit = *value - '0';
+      if(length > (SIZE_MAX - digit) / 10) {
+        return false;
+      }
+
+      length = length * 10 + digit;
+    }
+
+    return true;
+  }
+}
@@ -0,0 +1,155 @@
+#ifndef _HTTP_RESPONSE_PARSER_H_
+#define _HTTP_RESPONSE_PARSER_H_
+
+#include <Arduino.h>
+#include <functional>
+
+namespace Http {
+  static const char kContentLength[] PROGMEM = "Content-Length";
+  static const char kTransferEncoding[] PROGMEM = "Transfer-Encoding";
+  static const char kETag[] PROGMEM = "ETag";
+  static const char kConnection[] PROGMEM = "Connection";
+  static const char kLastModified[] PROGMEM = "Last-Modified";
+
+  // Receives the body as it arrives. Data points into the TCP receive buffer
+  // and is only valid for the duration of the call.
+  typedef std::function<void(const char* data, size_t len)> BodyCallback;
+
+  // Fixed-capacity table of response header fields. Only fields that are
+  // registered with watch() are stored, everything else is skipped while
+  // parsing. Names are not copied and must outlive the table. Values longer
+  // than kMaxValueLength - 1 are cut off and marked truncated.
+  class Headers {
+    public:
+      static const size_t kMaxFields = 8;
+      static const size_t kMaxValueLength = 64;
+
+      bool watch(const char* name);
+      void clear();
+
+      bool has(const char* name) const;
+      const char* get(const char* name) const;
+      bool isTruncated(const char* name) const;
+
+    private:
+      friend class ResponseParser;
+
+      struct Field {
+        const char* name;
+        char value[kMaxValueLength];
+        uint8_t valueLength;
+        bool isPresent;
+        bool isTruncated;
+      };
+
+      Field fields[kMaxFields];
+      size_t numberOfFields = 0;
+
+      int indexOf(const char* name, const size_t nameLength) const;
+  };
+
+  // Resumable parser for a HTTP/1.x response. Data can be fed in slices split
+  // at arbitrary offsets, the parser never holds on to the caller's buffer.
+  class ResponseParser {
+    public:
+      enum BodyFraming {
+        eContentLength,
+        eChunked,
+        eUntilClose
+      };
+
+      ResponseParser(Headers& headers);
+
+      void reset();
+
+      // Consumes up to len bytes and returns how many were used. Parsing stops
+      // right after the empty line that ends the header block, the remainder
+      // of data is the start of the body. Interim 1xx responses (except 101
+      // Switching Protocols) are skipped.
+      size_t parse(const char* data, const size_t len);
+
+      // Decodes body data according to the framing announced in the header
+      // (Content-Length, chunked or close-delimited) and passes the payload on
+      // to onBody. Returns false on a malformed body.
+      bool parseBody(const char* data, const size_t len, const BodyCallback& onBody);
+
+      // Signals that the connection was closed, which completes a
+      // close-delimited body. Returns whether the body is complete.
+      bool finish();
+
+      bool isHeaderComplete() const;
+      bool isComplete() const;
+      bool hasError() const;
+
+      // Whether the connection can be reused after this response, i.e.
+      // HTTP/1.1, no "Connection: close" and the body isn't close-delimited.
+      bool isPersistent() const;
+
+      BodyFraming getBodyFraming() const;
+      // As announced by Content-Length, 0 with another framing.
+      size_t getContentLength() const;
+      size_t getBodyLength() const;
+      uint16_t getStatusCode() const;
+      const char* getReasonMessage() const;
+
+    private:
+      enum State {
+        eVersion,
+        eStatusCode,
+        eReasonMessage,
+        eStatusLineEnd,
+        eHeaderLineStart,
+        eHeaderFieldName,
+        eHeaderFieldValueStart,
+        eHeaderFieldValue,
+        eHeaderLineEnd,
+        eHeaderBlockEnd,
+        eBody,
+        eChunkSize,
+        eChunkExtension,
+        eChunkSizeLineEnd,
+        eChunkData,
+        eChunkDataEnd,
+        eChunkDataLineEnd,
+        eTrailerLineStart,
+        eTrailerLine,
+        eTrailerLineEnd,
+        eTrailerEnd,
+        eComplete,
+        eError
+      };
+
+      static const size_t kMaxReasonMessageLength = 32;
+      static const size_t kMaxFieldNameLength = 32;
+
+      Headers& headers;
+      State state;
+      size_t versionOffset;
+      uint8_t minorVersion;
+      uint16_t statusCode;
+      char reasonMessage[kMaxReasonMessageLength];
+      size_t reasonMessageLength;
+      char fieldName[kMaxFieldNameLength];
+      size_t fieldNameLength;
+      int fieldIndex;
+      BodyFraming bodyFraming;
+      size_t contentLength;
+      size_t bodyLength;
+      size_t remainingLength;
+      size_t chunkSizeDigits;
+
+      void beginStatusLine();
+      void parseVersion(const char c);
+      void parseStatusCode(const char c);
+      void parseHeaderFieldName(const char c);
+      void parseHeaderFieldValue(const char c);
+      void endHeaderField();
+      void beginBody();
+      void parseChunked(const char* data, const size_t len, const BodyCallback& onBody);
+      void parseChunkSize(const char c);
+
+      static bool ParseContentLength(const char* value, size_t& length);
+  };
+}
+
+#endif // _HTTP_RESPONSE_PARSER_H_
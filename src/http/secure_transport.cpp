@@ -0,0 +1,382 @@
+#include "secure_transport.h"
+#include <string.h>
+#include <algorithm>
+#include <mbedtls/ssl_internal.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/error.h>
+#include <esp_log.h>
+
+static const char LogTag[] PROGMEM = "HttpSecureTransport";
+
+namespace Http {
+  //
+  // - TlsSessionCache
+  //
+  TlsSessionCache::TlsSessionCache() {
+    this->statistics = { 0, 0, 0, 0 };
+
+    for(size_t i = 0; i < kMaxSessions; i++) {
+      this->entries[i].host[0] = '\0';
+      this->entries[i].port = 0;
+      this->entries[i].isValid = false;
+      this->entries[i].lastUsed = 0;
+      mbedtls_ssl_session_init(&this->entries[i].session);
+    }
+  }
+
+  TlsSessionCache::~TlsSessionCache() {
+    for(size_t i = 0; i < kMaxSessions; i++) {
+      mbedtls_ssl_session_free(&this->entries[i].session);
+    }
+  }
+
+  const mbedtls_ssl_session* TlsSessionCache::get(const char* host, const uint16_t port) const {
+    const int index = this->indexOf(host, port);
+    if(index < 0) {
+      return NULL;
+    }
+
+    return &this->entries[index].session;
+  }
+
+  void TlsSessionCache::put(const char* host, const uint16_t port, const mbedtls_ssl_context* ssl) {
+    int index = this->indexOf(host, port);
+
+    // Replace the least recently used session if this host is new.
+    if(index < 0) {
+      index = 0;
+      for(size_t i = 0; i < kMaxSessions; i++) {
+        if(!this->entries[i].isValid) {
+          index = i;
+          break;
+        }
+
+        if(this->entries[i].lastUsed < this->entries[index].lastUsed) {
+          index = i;
+        }
+      }
+    }
+
+    Entry& entry = this->entries[index];
+
+    mbedtls_ssl_session_free(&entry.session);
+    mbedtls_ssl_session_init(&entry.session);
+
+    entry.isValid = mbedtls_ssl_get_session(ssl, &entry.session) == 0;
+    entry.port = port;
+    entry.lastUsed = millis();
+    strncpy(entry.host, host, kMaxHostLength - 1);
+    entry.host[kMaxHostLength - 1] = '\0';
+  }
+
+  void TlsSessionCache::remove(const char* host, const uint16_t port) {
+    const int index = this->indexOf(host, port);
+    if(index < 0) {
+      return;
+    }
+
+    this->entries[index].isValid = false;
+    mbedtls_ssl_session_free(&this->entries[index].session);
+    mbedtls_ssl_session_init(&this->entries[index].session);
+  }
+
+  void TlsSessionCache::addHandshake(const uint32_t time, const bool resumed) {
+    this->statistics.handshakes++;
+    this->statistics.lastHandshakeTime = time;
+    this->statistics.totalHandshakeTime += time;
+
+    if(resumed) {
+      this->statistics.resumptions++;
+    }
+  }
+
+  const TlsSessionCache::Statistics& TlsSessionCache::getStatistics() const {
+    return this->statistics;
+  }
+
+  int TlsSessionCache::indexOf(const char* host, const uint16_t port) const {
+    for(size_t i = 0; i < kMaxSessions; i++) {
+      const Entry& entry = this->entries[i];
+
+      if(entry.isValid && entry.port == port && strcasecmp(entry.host, host) == 0) {
+        return i;
+      }
+    }
+
+    return -1;
+  }
+
+  //
+  // - SecureTransport
+  //
+  SecureTransport::SecureTransport() {}
+
+  SecureTransport::~SecureTransport() {
+    this->end();
+  }
+
+  bool SecureTransport::begin(AsyncClient* client,
+                              const char* host,
+                              const uint16_t port,
+                              const char* caCert,
+                              TlsSessionCache* sessionCache,
+                              const std::function<void()> onReady,
+                              const DataCallback onData,
+                              const std::function<void()> onError) {
+    static const char kPersonalization[] PROGMEM = "HttpSecureTransport";
+
+    this->end();
+
+    this->client = client;
+    this->host = host;
+    this->port = port;
+    this->sessionCache = sessionCache;
+    this->readyCallback = onReady;
+    this->dataCallback = onData;
+    this->errorCallback = onError;
+    this->isHandshakeComplete = false;
+    this->isResumedSession = false;
+    this->handshakeStart = millis();
+
+    mbedtls_ssl_init(&this->ssl);
+    mbedtls_ssl_config_init(&this->config);
+    mbedtls_ctr_drbg_init(&this->drbg);
+    mbedtls_entropy_init(&this->entropy);
+    mbedtls_x509_crt_init(&this->caChain);
+    this->isInitialized = true;
+
+    int error = mbedtls_ctr_drbg_seed(&this->drbg,
+                                      mbedtls_entropy_func,
+                                      &this->entropy,
+                                      (const unsigned char*)kPersonalization,
+                                      strlen(kPersonalization));
+    if(error == 0) {
+      error = mbedtls_ssl_config_defaults(&this->config,
+                                          MBEDTLS_SSL_IS_CLIENT,
+                                          MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT);
+    }
+
+    if(error == 0 && caCert != NULL) {
+      error = mbedtls_x509_crt_parse(&this->caChain, (const unsigned char*)caCert, strlen(caCert) + 1);
+    }
+
+    if(error != 0) {
+      this->fail(error);
+      return false;
+    }
+
+    if(caCert != NULL) {
+      mbedtls_ssl_conf_ca_chain(&this->config, &this->caChain, NULL);
+      mbedtls_ssl_conf_authmode(&this->config, MBEDTLS_SSL_VERIFY_REQUIRED);
+    } else {
+      ESP_LOGW(LogTag, "no CA certificate set, not verifying %s.", host);
+      mbedtls_ssl_conf_authmode(&this->config, MBEDTLS_SSL_VERIFY_NONE);
+    }
+
+    mbedtls_ssl_conf_rng(&this->config, mbedtls_ctr_drbg_random, &this->drbg);
+    mbedtls_ssl_conf_session_tickets(&this->config, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+
+    error = mbedtls_ssl_setup(&this->ssl, &this->config);
+    if(error == 0) {
+      error = mbedtls_ssl_set_hostname(&this->ssl, host);
+    }
+
+    if(error != 0) {
+      this->fail(error);
+      return false;
+    }
+
+    mbedtls_ssl_set_bio(&this->ssl, this, &SecureTransport::Send, &SecureTransport::Receive, NULL);
+
+    // Offer the session from the last handshake with this server, if the
+    // server still knows it we skip the certificate exchange and key
+    // agreement.
+    const mbedtls_ssl_session* session = this->sessionCache ? this->sessionCache->get(host, port) : NULL;
+    if(session != NULL && mbedtls_ssl_set_session(&this->ssl, session) != 0) {
+      ESP_LOGW(LogTag, "could not set cached session for %s.", host);
+    }
+
+    this->handshake();
+
+    return this->isInitialized;
+  }
+
+  void SecureTransport::end() {
+    if(!this->isInitialized) {
+      return;
+    }
+
+    this->isInitialized = false;
+    this->isHandshakeComplete = false;
+
+    mbedtls_ssl_free(&this->ssl);
+    mbedtls_ssl_config_free(&this->config);
+    mbedtls_ctr_drbg_free(&this->drbg);
+    mbedtls_entropy_free(&this->entropy);
+    mbedtls_x509_crt_free(&this->caChain);
+  }
+
+  bool SecureTransport::isOpen() const {
+    return this->isInitialized;
+  }
+
+  void SecureTransport::receive(const char* data, size_t len) {
+    if(!this->isInitialized) {
+      return;
+    }
+
+    // mbedTLS pulls the ciphertext through Receive() from this segment.
+    this->rxData = data;
+    this->rxLength = len;
+
+    if(!this->isHandshakeComplete) {
+      this->handshake();
+    }
+
+    if(this->isInitialized && this->isHandshakeComplete) {
+      this->read();
+    }
+
+    this->rxData = NULL;
+    this->rxLength = 0;
+  }
+
+  void SecureTransport::acknowledged() {
+    // Nothing arrives to step it on, the server waits for the rest of our
+    // handshake message.
+    if(this->isInitialized && !this->isHandshakeComplete) {
+      this->handshake();
+    }
+  }
+
+  int SecureTransport::write(const char* data, size_t len) {
+    if(!this->isInitialized) {
+      return -1;
+    }
+
+    const int written = mbedtls_ssl_write(&this->ssl, (const unsigned char*)data, len);
+
+    if(written == MBEDTLS_ERR_SSL_WANT_WRITE) {
+      return 0;
+    } else if(written < 0) {
+      this->fail(written);
+    }
+
+    return written;
+  }
+
+  //
+  // - private
+  //
+  void SecureTransport::handshake() {
+    // Step through the handshake ourselves, whether the server accepted the
+    // offered session is only known while the handshake is in progress.
+    while(this->ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+      const int error = mbedtls_ssl_handshake_step(&this->ssl);
+
+      if(this->ssl.handshake != NULL) {
+        this->isResumedSession = this->ssl.handshake->resume != 0;
+      }
+
+      if(error == MBEDTLS_ERR_SSL_WANT_READ || error == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        return;
+      }
+
+      if(error != 0) {
+        // Don't offer a session the server choked on again.
+        if(this->sessionCache != NULL) {
+          this->sessionCache->remove(this->host, this->port);
+        }
+
+        this->fail(error);
+        return;
+      }
+    }
+
+    const uint32_t handshakeTime = millis() - this->handshakeStart;
+
+    ESP_LOGI(LogTag, "handshake with %s done in %d ms (resumed: %d).", this->host, handshakeTime, this->isResumedSession);
+
+    this->isHandshakeComplete = true;
+
+    if(this->sessionCache != NULL) {
+      this->sessionCache->addHandshake(handshakeTime, this->isResumedSession);
+      this->sessionCache->put(this->host, this->port, &this->ssl);
+    }
+
+    if(this->readyCallback) {
+      this->readyCallback();
+    }
+  }
+
+  void SecureTransport::read() {
+    // Keep reading until all received ciphertext is used up, callbacks may
+    // end the transport in between.
+    while(this->isInitialized) {
+      const int len = mbedtls_ssl_read(&this->ssl, (unsigned char*)this->plaintext, sizeof(this->plaintext));
+
+      if(len > 0) {
+        if(this->dataCallback) {
+          this->dataCallback(this->plaintext, len);
+        }
+      } else if(len == MBEDTLS_ERR_SSL_WANT_READ || len == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        break;
+      } else if(len == 0 || len == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+        // The TCP connection closing follows.
+        break;
+      } else {
+        this->fail(len);
+        break;
+      }
+    }
+  }
+
+  void SecureTransport::fail(const int error) {
+    char message[64];
+    mbedtls_strerror(error, message, sizeof(message));
+
+    ESP_LOGE(LogTag, "TLS error -0x%04X: %s.", -error, message);
+
+    this->end();
+
+    if(this->errorCallback) {
+      this->errorCallback();
+    }
+  }
+
+  int SecureTransport::Send(void* context, const unsigned char* buffer, size_t len) {
+    SecureTransport* self = static_cast<SecureTransport*>(context);
+    AsyncClient* c = self->client;
+
+    if(c == NULL || !c->connected()) {
+      return MBEDTLS_ERR_NET_CONN_RESET;
+    }
+
+    const size_t space = c->space();
+    if(space == 0 || !c->canSend()) {
+      return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+
+    const size_t length = c->add((const char*)buffer, std::min(space, len));
+    c->send();
+
+    return length > 0 ? (int)length : MBEDTLS_ERR_SSL_WANT_WRITE;
+  }
+
+  int SecureTransport::Receive(void* context, unsigned char* buffer, size_t len) {
+    SecureTransport* self = static_cast<SecureTransport*>(context);
+
+    if(self->rxLength == 0) {
+      return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+    const size_t length = std::min(len, self->rxLength);
+    memcpy(buffer, self->rxData, length);
+
+    self->rxData += length;
+    self->rxLength -= length;
+
+    return length;
+  }
+}
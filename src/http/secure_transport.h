@@ -0,0 +1,121 @@
+#ifndef _HTTP_SECURE_TRANSPORT_H_
+#define _HTTP_SECURE_TRANSPORT_H_
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include <functional>
+#include <mbedtls/ssl.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/x509_crt.h>
+
+namespace Http {
+  // Keeps the TLS session of the last handshake with a host, so the next
+  // connection can resume it (session ticket or session ID) instead of doing
+  // a full handshake.
+  class TlsSessionCache {
+    public:
+      struct Statistics {
+        uint32_t handshakes;
+        uint32_t resumptions;
+        uint32_t lastHandshakeTime;
+        uint32_t totalHandshakeTime;
+      };
+
+      TlsSessionCache();
+      ~TlsSessionCache();
+
+      // Returns the cached session for host:port, or NULL.
+      const mbedtls_ssl_session* get(const char* host, const uint16_t port) const;
+      void put(const char* host, const uint16_t port, const mbedtls_ssl_context* ssl);
+      void remove(const char* host, const uint16_t port);
+
+      void addHandshake(const uint32_t time, const bool resumed);
+      const Statistics& getStatistics() const;
+
+    private:
+      static const size_t kMaxSessions = 2;
+      static const size_t kMaxHostLength = 64;
+
+      struct Entry {
+        char host[kMaxHostLength];
+        uint16_t port;
+        bool isValid;
+        unsigned long lastUsed;
+        mbedtls_ssl_session session;
+      };
+
+      Entry entries[kMaxSessions];
+      Statistics statistics;
+
+      int indexOf(const char* host, const uint16_t port) const;
+  };
+
+  // TLS on top of an AsyncClient connection. Ciphertext is fed in with
+  // receive() as it arrives and plaintext is handed to the data callback,
+  // mbedTLS reads straight from the received segment.
+  class SecureTransport {
+    public:
+      typedef std::function<void(const char* data, size_t len)> DataCallback;
+
+      SecureTransport();
+      ~SecureTransport();
+
+      // Starts the handshake on a connected client. onReady is called once
+      // the handshake is done, onError on any TLS failure.
+      bool begin(AsyncClient* client,
+                 const char* host,
+                 const uint16_t port,
+                 const char* caCert,
+                 TlsSessionCache* sessionCache,
+                 const std::function<void()> onReady,
+                 const DataCallback onData,
+                 const std::function<void()> onError);
+      void end();
+
+      bool isOpen() const;
+      void receive(const char* data, size_t len);
+
+      // Call when the connection acknowledged sent data, a handshake that
+      // ran out of room in the send window continues.
+      void acknowledged();
+
+      // Returns the number of bytes taken, 0 when the connection is full
+      // (call again with the same data) and negative on an error.
+      int write(const char* data, size_t len);
+
+    private:
+      AsyncClient* client = NULL;
+      TlsSessionCache* sessionCache = NULL;
+      const char* host = NULL;
+      uint16_t port = 0;
+      bool isInitialized = false;
+      bool isHandshakeComplete = false;
+      bool hasCACert = false;
+      bool isResumedSession = false;
+      unsigned long handshakeStart = 0;
+
+      const char* rxData = NULL;
+      size_t rxLength = 0;
+      char plaintext[512];
+
+      std::function<void()> readyCallback;
+      DataCallback dataCallback;
+      std::function<void()> errorCallback;
+
+      mbedtls_ssl_context ssl;
+      mbedtls_ssl_config config;
+      mbedtls_ctr_drbg_context drbg;
+      mbedtls_entropy_context entropy;
+      mbedtls_x509_crt caChain;
+
+      void handshake();
+      void read();
+      void fail(const int error);
+
+      static int Send(void* context, const unsigned char* buffer, size_t len);
+      static int Receive(void* context, unsigned char* buffer, size_t len);
+  };
+}
+
+#endif // _HTTP_SECURE_TRANSPORT_H_
@@ -1,50 +1,167 @@
 #include "uri_parser.h"
+#include <string.h>
+#include <strings.h>
 
 namespace Uri {
-  const String UriParser::kSchemeHttp PROGMEM = "http";
-  const String UriParser::kSchemeHttps PROGMEM = "https";
-  const String UriParser::kSchemeDivider PROGMEM = "://";
-  const String UriParser::kPathDivider PROGMEM = "/";
-  const String UriParser::kPortDivider PROGMEM = ":";
+  static const char kSchemeHttp[] PROGMEM = "http";
+  static const char kSchemeHttps[] PROGMEM = "https";
+  static const char kSchemeDivider[] PROGMEM = "://";
 
-  bool UriParser::parse(const String& _uri, Uri& u) {
-    String uri = _uri;
+  bool UriParser::parse(const String& uri, Uri& u) {
+    return UriParser::parse(uri.c_str(), uri.length(), u);
+  }
+
+  bool UriParser::parse(const char* uri, const size_t len, Uri& u) {
+    // Offsets are 16 bit, that's plenty for the URIs we request.
+    if(uri == NULL || len > UINT16_MAX) {
+      return false;
+    }
 
-    uri.toLowerCase();
+    memset(&u, 0, sizeof(u));
 
-    // Find where authority part of URI starts. Everything up to this is
-    // part of the scheme.
-    const int authorityOffset = uri.indexOf(kSchemeDivider);
-    if(authorityOffset == kSchemeHttp.length() && uri.substring(0, authorityOffset) == kSchemeHttp) {
+    // Everything up to :// is the scheme, uri doesn't have to be NUL
+    // terminated so don't search past len.
+    const size_t dividerLength = strlen(kSchemeDivider);
+    size_t schemeLength = 0;
+    while(schemeLength + dividerLength <= len && strncmp(uri + schemeLength, kSchemeDivider, dividerLength) != 0) {
+      schemeLength++;
+    }
+
+    if(schemeLength + dividerLength > len) {
+      return false;
+    }
+
+    if(schemeLength == strlen(kSchemeHttp) && strncasecmp(uri, kSchemeHttp, schemeLength) == 0) {
       u.scheme = http;
-      u.port = 80;
-    } else if(authorityOffset == kSchemeHttps.length() && uri.substring(0, authorityOffset) == kSchemeHttps) {
+      u.port = kHttpPort;
+    } else if(schemeLength == strlen(kSchemeHttps) && strncasecmp(uri, kSchemeHttps, schemeLength) == 0) {
       u.scheme = https;
-      u.port = 443;
+      u.port = kHttpsPort;
     } else {
       return false;
     }
 
-    // Get the domain part out of the URI (called authority),
-    // everything after :// and before /. We keep it simple, no fancy
-    // check on valid domain naimes.
-    const int pathOffset = uri.indexOf(kPathDivider, authorityOffset + kSchemeDivider.length());
-    const String authority = uri.substring(authorityOffset + kSchemeDivider.length(), pathOffset);
+    // The authority runs up to the first /, ? or #.
+    const size_t authorityOffset = schemeLength + dividerLength;
+    size_t authorityEnd = authorityOffset;
+    while(authorityEnd < len && uri[authorityEnd] != '/' && uri[authorityEnd] != '?' && uri[authorityEnd] != '#') {
+      authorityEnd++;
+    }
+
+    // User info ends at the last @ of the authority.
+    size_t hostOffset = authorityOffset;
+    for(size_t i = authorityOffset; i < authorityEnd; i++) {
+      if(uri[i] == '@') {
+        hostOffset = i + 1;
+      }
+    }
 
-    // Remaining of the string, including query.
-    u.path = uri.substring(pathOffset, uri.length());
+    if(hostOffset > authorityOffset) {
+      u.userInfo.offset = authorityOffset;
+      u.userInfo.length = hostOffset - 1 - authorityOffset;
+    }
 
-    // If there's a custom port specified, retreive that and set it.
-    // Otherwise the authrority == domain.
-    const int portOffset = authority.indexOf(kPortDivider);
-    if(portOffset > 0) {
-      const String portString = authority.substring(portOffset + kPortDivider.length(), authority.length());
-      u.port = portString.toInt();
-      u.domain = authority.substring(0, portOffset);
+    size_t portOffset = 0;
+
+    if(hostOffset < authorityEnd && uri[hostOffset] == '[') {
+      // IPv6 literal, the port divider comes after the closing bracket.
+      const char* bracket = (const char*)memchr(uri + hostOffset, ']', authorityEnd - hostOffset);
+      if(bracket == NULL) {
+        return false;
+      }
+
+      const size_t bracketOffset = bracket - uri;
+
+      u.isIPv6 = true;
+      u.host.offset = hostOffset + 1;
+      u.host.length = bracketOffset - hostOffset - 1;
+
+      if(bracketOffset + 1 < authorityEnd) {
+        if(uri[bracketOffset + 1] != ':') {
+          return false;
+        }
+
+        portOffset = bracketOffset + 2;
+      }
     } else {
-      u.domain = authority;
+      const char* divider = (const char*)memchr(uri + hostOffset, ':', authorityEnd - hostOffset);
+
+      u.host.offset = hostOffset;
+      u.host.length = (divider != NULL ? (size_t)(divider - uri) : authorityEnd) - hostOffset;
+
+      if(divider != NULL) {
+        portOffset = divider - uri + 1;
+      }
+    }
+
+    if(u.host.length == 0) {
+      return false;
+    }
+
+    // An empty port (http://host:/) means the default port.
+    if(portOffset > 0 && portOffset < authorityEnd
+      && !UriParser::ParsePort(uri + portOffset, authorityEnd - portOffset, u.port)) {
+      return false;
+    }
+
+    // Path up to ? or #, query up to #, the rest is the fragment.
+    size_t offset = authorityEnd;
+
+    u.path.offset = offset;
+    while(offset < len && uri[offset] != '?' && uri[offset] != '#') {
+      offset++;
+    }
+    u.path.length = offset - u.path.offset;
+
+    if(offset < len && uri[offset] == '?') {
+      u.query.offset = ++offset;
+      while(offset < len && uri[offset] != '#') {
+        offset++;
+      }
+      u.query.length = offset - u.query.offset;
+    }
+
+    if(offset < len && uri[offset] == '#') {
+      u.fragment.offset = offset + 1;
+      u.fragment.length = len - u.fragment.offset;
+    }
+
+    return true;
+  }
+
+  bool UriParser::copy(const char* uri, const View& view, char* buffer, const size_t size) {
+    if(size == 0 || view.length >= size) {
+      return false;
+    }
+
+    memcpy(buffer, uri + view.offset, view.length);
+    buffer[view.length] = '\0';
+
+    return true;
+  }
+
+  //
+  // - private
+  //
+  bool UriParser::ParsePort(const char* data, const size_t len, uint16_t& port) {
+    uint32_t value = 0;
+
+    for(size_t i = 0; i < len; i++) {
+      if(data[i] < '0' || data[i] > '9') {
+        return false;
+      }
+
+      value = value * 10 + (data[i] - '0');
+      if(value > UINT16_MAX) {
+        return false;
+      }
+    }
+
+    if(value == 0) {
+      return false;
     }
 
+    port = value;
     return true;
   }
 }
@@ -10,23 +10,42 @@ namespace Uri
     https = 1
   };
 
+  // Part of a URI, as offset and length into the parsed string.
+  struct View {
+    uint16_t offset;
+    uint16_t length;
+  };
+
+  // Components of a URI. Nothing is copied, the views point into the string
+  // that was parsed so it has to outlive the Uri.
   struct Uri {
     Scheme scheme;
-    String domain;
-    String path;
-    int port;
+    View userInfo;
+    View host;      // Without the brackets of an IPv6 literal.
+    View path;      // Empty when the URI has no path.
+    View query;     // Without the '?'.
+    View fragment;  // Without the '#'.
+    uint16_t port;
+    bool isIPv6;
   };
 
   class UriParser {
     public:
-      static bool parse(const String& _uri, Uri& u);
+      // Splits scheme://[userinfo@]host[:port][/path][?query][#fragment],
+      // host can be an IPv6 literal in brackets. Scheme and host are matched
+      // case insensitive, the rest is left as is.
+      static bool parse(const char* uri, const size_t len, Uri& u);
+      static bool parse(const String& uri, Uri& u);
+
+      // Copies a component as a NUL terminated string, returns false if it
+      // doesn't fit.
+      static bool copy(const char* uri, const View& view, char* buffer, const size_t size);
 
     private:
-      static const String kSchemeHttp PROGMEM;
-      static const String kSchemeHttps PROGMEM;
-      static const String kSchemeDivider PROGMEM;
-      static const String kPathDivider PROGMEM;
-      static const String kPortDivider PROGMEM;
+      static const uint16_t kHttpPort = 80;
+      static const uint16_t kHttpsPort = 443;
+
+      static bool ParsePort(const char* data, const size_t len, uint16_t& port);
   };
 }
 #endif // _URI_PARSER_H_
@@ -0,0 +1,95 @@
+#include "validator_cache.h"
+#include <string.h>
+
+namespace Http {
+  ValidatorCache::ValidatorCache() {
+    for(size_t i = 0; i < kMaxEntries; i++) {
+      this->entries[i].uriHash = 0;
+      this->entries[i].isValid = false;
+      this->entries[i].lastUsed = 0;
+    }
+  }
+
+  bool ValidatorCache::get(const String& uri, Validators& validators) const {
+    const int index = this->indexOf(Hash(uri));
+    if(index < 0) {
+      return false;
+    }
+
+    validators = this->entries[index].validators;
+
+    return true;
+  }
+
+  void ValidatorCache::put(const String& uri, const Headers& headers) {
+    // A cut off validator never matches, sending it back only costs a
+    // full response anyway.
+    const char* eTag = headers.isTruncated(kETag) ? NULL : headers.get(kETag);
+    const char* lastModified = headers.isTruncated(kLastModified) ? NULL : headers.get(kLastModified);
+
+    if(eTag == NULL && lastModified == NULL) {
+      this->remove(uri);
+      return;
+    }
+
+    const uint32_t uriHash = Hash(uri);
+    int index = this->indexOf(uriHash);
+
+    // Replace the least recently used entry if this URI is new.
+    if(index < 0) {
+      index = 0;
+      for(size_t i = 0; i < kMaxEntries; i++) {
+        if(!this->entries[i].isValid) {
+          index = i;
+          break;
+        }
+
+        if(this->entries[i].lastUsed < this->entries[index].lastUsed) {
+          index = i;
+        }
+      }
+    }
+
+    Entry& entry = this->entries[index];
+    entry.uriHash = uriHash;
+    entry.isValid = true;
+    entry.lastUsed = millis();
+
+    strncpy(entry.validators.eTag, eTag ? eTag : "", sizeof(entry.validators.eTag) - 1);
+    entry.validators.eTag[sizeof(entry.validators.eTag) - 1] = '\0';
+    strncpy(entry.validators.lastModified, lastModified ? lastModified : "", sizeof(entry.validators.lastModified) - 1);
+    entry.validators.lastModified[sizeof(entry.validators.lastModified) - 1] = '\0';
+  }
+
+  void ValidatorCache::remove(const String& uri) {
+    const int index = this->indexOf(Hash(uri));
+    if(index >= 0) {
+      this->entries[index].isValid = false;
+    }
+  }
+
+  //
+  // - private
+  //
+  int ValidatorCache::indexOf(const uint32_t uriHash) const {
+    for(size_t i = 0; i < kMaxEntries; i++) {
+      if(this->entries[i].isValid && this->entries[i].uriHash == uriHash) {
+        return i;
+      }
+    }
+
+    return -1;
+  }
+
+  uint32_t ValidatorCache::Hash(const String& uri) {
+    // 32-bit FNV-1a.
+    uint32_t hash = 2166136261UL;
+
+    for(size_t i = 0; i < uri.length(); i++) {
+      hash ^= (uint8_t)uri[i];
+      hash *= 16777619UL;
+    }
+
+    return hash;
+  }
+}
@@ -0,0 +1,42 @@
+#ifndef _HTTP_VALIDATOR_CACHE_H_
+#define _HTTP_VALIDATOR_CACHE_H_
+
+#include <Arduino.h>
+#include "response_parser.h"
+
+namespace Http {
+  // Cache validators of a response, sent back as If-None-Match and
+  // If-Modified-Since so the server can answer 304 Not Modified.
+  struct Validators {
+    char eTag[Headers::kMaxValueLength];
+    char lastModified[Headers::kMaxValueLength];
+  };
+
+  // Remembers the validators of the last response per URI. URIs are only
+  // kept as a hash, they tend to be long and may contain API keys.
+  class ValidatorCache {
+    public:
+      ValidatorCache();
+
+      bool get(const String& uri, Validators& validators) const;
+      void put(const String& uri, const Headers& headers);
+      void remove(const String& uri);
+
+    private:
+      static const size_t kMaxEntries = 4;
+
+      struct Entry {
+        uint32_t uriHash;
+        bool isValid;
+        unsigned long lastUsed;
+        Validators validators;
+      };
+
+      Entry entries[kMaxEntries];
+
+      int indexOf(const uint32_t uriHash) const;
+      static uint32_t Hash(const String& uri);
+  };
+}
+
+#endif // _HTTP_VALIDATOR_CACHE_H_
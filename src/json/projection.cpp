@@ -0,0 +1,165 @@
+#include "projection.h"
+#include <string.h>
+
+namespace Json {
+  static const char kAnyElement[] PROGMEM = "[*]";
+
+  Projection::Projection(const Field* fields, const size_t numberOfFields) : fields(fields), numberOfFields(numberOfFields) {
+    this->path[0] = '\0';
+  }
+
+  void Projection::onValue(const ValueCallback callback) {
+    this->valueCallback = callback;
+  }
+
+  bool Projection::isComplete() const {
+    return this->didComplete;
+  }
+
+  void Projection::whitespace(char) {}
+
+  void Projection::startDocument() {
+    this->path[0] = '\0';
+    this->pathLength = 0;
+    this->isPathValid = true;
+    this->depth = 0;
+    this->skippedDepth = 0;
+    this->didComplete = false;
+  }
+
+  void Projection::key(String key) {
+    if(this->depth == 0 || this->skippedDepth > 0) {
+      return;
+    }
+
+    const Frame& frame = this->frames[this->depth - 1];
+
+    this->pathLength = frame.pathLength;
+    this->path[this->pathLength] = '\0';
+    this->isPathValid = frame.isValid
+      && (this->pathLength == 0 || this->append(".", 1))
+      && this->append(key.c_str(), key.length());
+  }
+
+  void Projection::value(String value) {
+    this->startValue();
+
+    if(this->skippedDepth > 0 || !this->isPathValid || !this->valueCallback) {
+      return;
+    }
+
+    const int field = this->find();
+    if(field < 0) {
+      return;
+    }
+
+    // Index of the element of the innermost array we're in.
+    size_t index = 0;
+    for(size_t i = this->depth; i > 0; i--) {
+      if(this->frames[i - 1].isArray) {
+        index = this->frames[i - 1].index - 1;
+        break;
+      }
+    }
+
+    this->valueCallback(this->fields[field].id, index, value.c_str());
+  }
+
+  void Projection::startArray() {
+    this->startValue();
+    this->push(true);
+  }
+
+  void Projection::startObject() {
+    this->startValue();
+    this->push(false);
+  }
+
+  void Projection::endArray() {
+    this->pop();
+  }
+
+  void Projection::endObject() {
+    this->pop();
+  }
+
+  void Projection::endDocument() {
+    this->didComplete = true;
+  }
+
+  //
+  // - private
+  //
+  void Projection::startValue() {
+    // Values in an object got their path from the key, elements of an array
+    // all share the array's path plus [*].
+    if(this->depth == 0 || this->skippedDepth > 0) {
+      return;
+    }
+
+    Frame& frame = this->frames[this->depth - 1];
+    if(!frame.isArray) {
+      return;
+    }
+
+    frame.index++;
+
+    this->pathLength = frame.pathLength;
+    this->path[this->pathLength] = '\0';
+    this->isPathValid = frame.isValid && this->append(kAnyElement, strlen(kAnyElement));
+  }
+
+  void Projection::push(const bool isArray) {
+    if(this->depth >= kMaxDepth || this->skippedDepth > 0) {
+      this->skippedDepth++;
+      return;
+    }
+
+    Frame& frame = this->frames[this->depth++];
+
+    frame.isArray = isArray;
+    frame.isValid = this->isPathValid;
+    frame.pathLength = this->pathLength;
+    frame.index = 0;
+  }
+
+  void Projection::pop() {
+    if(this->skippedDepth > 0) {
+      this->skippedDepth--;
+      return;
+    }
+
+    if(this->depth == 0) {
+      return;
+    }
+
+    const Frame& frame = this->frames[--this->depth];
+
+    // Back to the path of the key (or element) that held this container.
+    this->pathLength = frame.pathLength;
+    this->path[this->pathLength] = '\0';
+    this->isPathValid = frame.isValid;
+  }
+
+  bool Projection::append(const char* data, const size_t len) {
+    if(this->pathLength + len >= kMaxPathLength) {
+      return false;
+    }
+
+    memcpy(this->path + this->pathLength, data, len);
+    this->pathLength += len;
+    this->path[this->pathLength] = '\0';
+
+    return true;
+  }
+
+  int Projection::find() const {
+    for(size_t i = 0; i < this->numberOfFields; i++) {
+      if(strcmp(this->fields[i].path, this->path) == 0) {
+        return i;
+      }
+    }
+
+    return -1;
+  }
+}
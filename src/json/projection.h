@@ -0,0 +1,74 @@
+#ifndef _JSON_PROJECTION_H_
+#define _JSON_PROJECTION_H_
+
+#include <Arduino.h>
+#include <functional>
+#include <JsonListener.h>
+
+namespace Json {
+  // Picks a fixed set of fields out of a JSON document while it streams
+  // through JsonStreamingParser, without building the document in memory.
+  // Fields are given as paths, e.g. "current_observation.temp_c", with [*]
+  // for any element of an array, e.g. "forecast.forecastday[*].icon".
+  class Projection : public JsonListener {
+    public:
+      struct Field {
+        const char* path;
+        uint8_t id;
+      };
+
+      // Called for every scalar value on one of the paths, index is the
+      // element index of the innermost array on the path (0 if none).
+      typedef std::function<void(const uint8_t id, const size_t index, const char* value)> ValueCallback;
+
+      Projection(const Field* fields, const size_t numberOfFields);
+
+      void onValue(const ValueCallback callback);
+
+      // Whether the parser reached the end of the document.
+      bool isComplete() const;
+
+      // - JsonListener
+      void whitespace(char c) override;
+      void startDocument() override;
+      void key(String key) override;
+      void value(String value) override;
+      void endArray() override;
+      void endObject() override;
+      void endDocument() override;
+      void startArray() override;
+      void startObject() override;
+
+    private:
+      static const size_t kMaxPathLength = 96;
+      static const size_t kMaxDepth = 12;
+
+      struct Frame {
+        bool isArray;
+        bool isValid;
+        uint8_t pathLength;
+        uint16_t index;
+      };
+
+      const Field* fields;
+      size_t numberOfFields;
+      ValueCallback valueCallback;
+
+      char path[kMaxPathLength];
+      size_t pathLength = 0;
+      bool isPathValid = true;
+      Frame frames[kMaxDepth];
+      size_t depth = 0;
+      // Frames over kMaxDepth are only counted.
+      size_t skippedDepth = 0;
+      bool didComplete = false;
+
+      void startValue();
+      void push(const bool isArray);
+      void pop();
+      bool append(const char* data, const size_t len);
+      int find() const;
+  };
+}
+
+#endif // _JSON_PROJECTION_H_
@@ -0,0 +1,119 @@
+#include "discipline.h"
+
+namespace Ntp {
+  // 500 ppm, the most a decent crystal is off and the most the clock is
+  // sped up or slowed down.
+  const float Discipline::kMaxFrequency = 500e-6f;
+  const float Discipline::kMaxSlewRate = 500e-6f;
+  const float Discipline::kFrequencyTimeConstant = 2048e6f;
+
+  Discipline::Discipline() {}
+
+  bool Discipline::isSet() const {
+    return this->isClockSet;
+  }
+
+  int64_t Discipline::toTime(const int64_t local) const {
+    if(!this->isClockSet) {
+      return local;
+    }
+
+    const int64_t elapsed = local - this->referenceLocal;
+
+    return this->referenceTime + elapsed + (int64_t)(elapsed * this->frequency) + this->slewed(elapsed);
+  }
+
+  bool Discipline::update(const int64_t local, const int64_t offset) {
+    if(!this->isClockSet) {
+      this->referenceLocal = local;
+      this->referenceTime = local + offset;
+      this->slew = 0;
+      this->lastUpdate = local;
+      this->isClockSet = true;
+
+      return true;
+    }
+
+    // Start over from the current time, with what's left of the slew.
+    const int64_t elapsed = local - this->referenceLocal;
+    const int64_t remainingSlew = this->slew - this->slewed(elapsed);
+    const int64_t interval = local - this->lastUpdate;
+
+    this->referenceTime = this->toTime(local);
+    this->referenceLocal = local;
+    this->lastUpdate = local;
+
+    const int64_t magnitude = offset < 0 ? -offset : offset;
+
+    if(magnitude > kStepThreshold) {
+      this->referenceTime += offset;
+      this->slew = 0;
+      this->poll = kMinPoll;
+      this->stableUpdates = 0;
+
+      return true;
+    }
+
+    // Whatever the unfinished slew doesn't explain, drifted in since the last
+    // update.
+    if(interval > 0) {
+      const float drift = (float)(offset - remainingSlew) / interval;
+      const float gain = interval / (interval + kFrequencyTimeConstant);
+
+      this->frequency += drift * gain;
+
+      if(this->frequency > kMaxFrequency) {
+        this->frequency = kMaxFrequency;
+      } else if(this->frequency < -kMaxFrequency) {
+        this->frequency = -kMaxFrequency;
+      }
+    }
+
+    // The offset was measured against the clock as it is, it replaces the
+    // remaining slew.
+    this->slew = offset;
+
+    if(magnitude < kStableOffset) {
+      if(++this->stableUpdates >= kStableUpdates) {
+        this->stableUpdates = 0;
+
+        if(this->poll < kMaxPoll) {
+          this->poll++;
+        }
+      }
+    } else {
+      this->stableUpdates = 0;
+
+      if(this->poll > kMinPoll) {
+        this->poll--;
+      }
+    }
+
+    return false;
+  }
+
+  float Discipline::getFrequency() const {
+    return this->frequency * 1e6f;
+  }
+
+  uint32_t Discipline::getPollInterval() const {
+    return 1UL << this->poll;
+  }
+
+  //
+  // - private
+  //
+  int64_t Discipline::slewed(const int64_t elapsed) const {
+    const int64_t limit = (int64_t)(elapsed * kMaxSlewRate);
+
+    if(this->slew > limit) {
+      return limit;
+    }
+
+    if(this->slew < -limit) {
+      return -limit;
+    }
+
+    return this->slew;
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef _NTP_DISCIPLINE_H_
+#define _NTP_DISCIPLINE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Ntp {
+  // Turns the local clock (microseconds since boot) into the time in
+  // microseconds since the Unix epoch. Small offsets are slewed away at a
+  // bounded rate instead of stepping the clock, so it never runs backwards,
+  // and the crystal's frequency error is estimated from successive offsets.
+  // Once offsets stay small the poll interval grows, up to 2^kMaxPoll s.
+  class Discipline {
+    public:
+      // Offsets above this are stepped, in microseconds.
+      static const int64_t kStepThreshold = 128000;
+      // Offsets below this count towards a longer poll interval, in
+      // microseconds.
+      static const int64_t kStableOffset = 5000;
+      // Poll interval bounds as power of two seconds (64 s to ~2.3 h).
+      static const uint8_t kMinPoll = 6;
+      static const uint8_t kMaxPoll = 13;
+
+      Discipline();
+
+      bool isSet() const;
+
+      int64_t toTime(const int64_t local) const;
+
+      // Applies the offset measured at local, returns true when the clock
+      // was stepped (the first update always is).
+      bool update(const int64_t local, const int64_t offset);
+
+      // Frequency correction, in parts per million.
+      float getFrequency() const;
+      uint32_t getPollInterval() const;
+
+    private:
+      static const float kMaxFrequency;
+      static const float kMaxSlewRate;
+      // Weight of a frequency estimate grows with the time it was measured
+      // over, in microseconds.
+      static const float kFrequencyTimeConstant;
+      static const uint8_t kStableUpdates = 4;
+
+      bool isClockSet = false;
+      // At referenceLocal the time was referenceTime, it runs at 1 + frequency
+      // from there while slew is worked off.
+      int64_t referenceLocal = 0;
+      int64_t referenceTime = 0;
+      int64_t slew = 0;
+      float frequency = 0.0f;
+      int64_t lastUpdate = 0;
+      uint8_t poll = kMinPoll;
+      uint8_t stableUpdates = 0;
+
+      int64_t slewed(const int64_t elapsed) const;
+  };
+}
+
+#endif // _NTP_DISCIPLINE_H_
@@ -1,8 +1,10 @@
 #include "ntp_client.h"
 #include <TimeLib.h>
-#include <Timezone.h>
 #include <WiFi.h>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <math.h>
+#include <string.h>
 
 extern "C"{
   #include "lwip/opt.h"
@@ -16,80 +18,89 @@ static const char LogTag[] PROGMEM = "NtpClient";
 
 static xQueueHandle NtpQueue;
 static volatile TaskHandle_t NtpTaskHandle = NULL;
+// TimeLib takes a plain function to sync from.
+static Ntp::Client* TimeSource = NULL;
 
 namespace Ntp {
-  Client::Client() {}
-  Client::~Client() {}
+  // Until the rules from the configuration are set.
+  static const TimeChangeRule kUtc = { "UTC", Last, Sun, Mar, 1, 0 };
 
-  bool Client::getFormattedTime(String& _time) {
-    if(!this->didSynchronizeTime) {
-      return false;
-    }
+  Client::Client() : timeZone(kUtc, kUtc) {
+    // Replies and lookups of the servers finish on different tasks.
+    this->lock = xSemaphoreCreateRecursiveMutex();
 
-    int _hour   = hour();
-    int _minute = minute();
-    int _second = second();
+    static const char kTimeoutTimerName[] PROGMEM = "NtpClient::Timeout";
+    this->timeoutTimer = xTimerCreate(kTimeoutTimerName, pdMS_TO_TICKS(kRequestTimeout), pdFALSE, this, &Client::OnTimeoutTimer);
 
-    String formattedTime;
-
-    if (_hour < 10) {
-      formattedTime += F("0");
+    for(size_t i = 0; i < kMaxServers; i++) {
+      this->peers[i].client = this;
+      this->peers[i].host[0] = '\0';
+      this->peers[i].isPending = false;
+      this->peers[i].hasSample = false;
     }
-    formattedTime += String(_hour);
-    formattedTime += ":";
+  }
 
-    if (_minute < 10) {
-      formattedTime += F("0");
-    }
-    formattedTime += String(_minute);
-    formattedTime += F(":");
+  Client::~Client() {
+    xTimerDelete(this->timeoutTimer, portMAX_DELAY);
+    vSemaphoreDelete(this->lock);
+  }
 
-    if (_second < 10) {
-      formattedTime += F("0");
-    }
-    formattedTime += String(_second);
+  const char* Client::getFormattedTime() {
+    return this->refreshFormatted() ? this->formattedTime : NULL;
+  }
 
-    _time = formattedTime;
+  const char* Client::getFormattedShortTime() {
+    return this->refreshFormatted() ? this->formattedShortTime : NULL;
+  }
 
-    return true;
+  const char* Client::getFormattedDate() {
+    return this->refreshFormatted() ? this->formattedDate : NULL;
   }
 
-  bool Client::getFormattedDate(String& _date) {
+  bool Client::getUnixTime(unsigned long& unixTime) {
     if(!this->didSynchronizeTime) {
       return false;
     }
 
-    String formattedDate;
-
-    formattedDate = dayShortStr(weekday());
-    formattedDate += F(", ");
-    if(day() < 10) {
-        formattedDate += F("0");
-    }
-    formattedDate += String(day());
-    formattedDate += F(" ");
-    formattedDate += monthShortStr(month());
-    formattedDate += F(" ");
-    formattedDate += year();
-
-    _date = formattedDate;
+    unixTime = this->getClock() / 1000000LL;
 
     return true;
   }
 
-  bool Client::getUnixTime(unsigned long& unixTime) {
-    if(!this->didSynchronizeTime) {
-      return false;
-    }
-
-    unixTime = now();
+  void Client::setTimeZone(const TimeChangeRule& daylightSavingTime, const TimeChangeRule& standardTime) {
+    this->timeZone.setRules(daylightSavingTime, standardTime);
+  }
 
-    return true;
+  const Client::Statistics& Client::getStatistics() const {
+    return this->statistics;
   }
 
   void Client::setup(const String& ntpServer, const uint16_t port) {
-    this->ntpServer = ntpServer;
+    const char* ntpServers[] = { ntpServer.c_str() };
+
+    this->setup(ntpServers, 1, port);
+  }
+
+  void Client::setup(const char* const* ntpServers, const size_t numberOfServers, const uint16_t port) {
     this->ntpServerPort = port;
+    this->numberOfPeers = 0;
+
+    for(size_t i = 0; i < numberOfServers && this->numberOfPeers < kMaxServers; i++) {
+      if(ntpServers[i] == NULL || strlen(ntpServers[i]) == 0 || strlen(ntpServers[i]) >= kMaxHostLength) {
+        ESP_LOGE(LogTag, "skipping NTP server %d.", i);
+        continue;
+      }
+
+      Peer& peer = this->peers[this->numberOfPeers++];
+      strcpy(peer.host, ntpServers[i]);
+
+      peer.udp.onPacket([this, &peer](AsyncUDPPacket packet) {
+        // Taken first, everything after adds to the measured delay.
+        const int64_t receiveTime = this->getClock();
+
+        this->onPacket(peer, packet.data(), packet.length(), receiveTime);
+      });
+    }
 
     //
     if(!NtpQueue){
@@ -113,106 +124,357 @@ namespace Ntp {
     } else {
       ESP_LOGE(LogTag, "error creating NTP task.");
     }
+  }
 
-    this->udp.onPacket([this](AsyncUDPPacket packet) {
-      ESP_LOGI(LogTag, "got NTP packet from server.");
+  bool Client::isUpdateDue() const {
+    return !this->didSynchronizeTime || (long)(millis() - this->nextUpdateTime) >= 0;
+  }
 
-      uint8_t *packetBuffer = packet.data();
+  void Client::setResolver(Dns::Resolver* resolver) {
+    this->resolver = resolver;
+  }
 
-      unsigned long highWord = word(packetBuffer[40], packetBuffer[41]);
-      unsigned long lowWord = word(packetBuffer[42], packetBuffer[43]);
+  bool Client::update(std::function<void(bool)> _callback) {
+    // The timeout itself got lost, finish the stale update first.
+    if(this->isUpdatingTime && millis() - this->updateStartTime > 2 * kRequestTimeout) {
+      this->onTimeout();
+    }
 
-      // combine the four bytes (two words) into a long integer
-      // this is NTP time (seconds since Jan 1 1900):
-      unsigned long secsSince1900 = highWord << 16 | lowWord;
+    if(this->isUpdatingTime || this->numberOfPeers == 0) {
+      ESP_LOGE(LogTag, "already updating time or no servers.");
+      _callback(false);
 
-      // now convert NTP time into everyday time:
-      // Unix time starts on Jan 1 1970. In seconds, that's 2208988800:
-      const unsigned long seventyYears = 2208988800UL;
+      return false;
+    }
 
-      // subtract seventy years:
-      unsigned long epoch = secsSince1900 - seventyYears;
+    this->isUpdatingTime = true;
+    this->callback = _callback;
 
-      this->unixTime = epoch;
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
 
-      time_t localTime;
+    this->pendingPeers = this->numberOfPeers;
+    for(size_t i = 0; i < this->numberOfPeers; i++) {
+      this->peers[i].isPending = true;
+      this->peers[i].hasSample = false;
+    }
 
-      // @ToDo make configurable.
-      TimeChangeRule euCET  = { "CET", Last, Sun, Oct, 2, 60 };
-      TimeChangeRule euCEST = { "CEST", Last, Sun, Mar, 2, 120 };
+    // A lost lookup or reply would otherwise keep the update going forever.
+    this->updateStartTime = millis();
+    if(xTimerReset(this->timeoutTimer, 0) != pdPASS) {
+      ESP_LOGE(LogTag, "error starting timeout.");
+    }
 
-      Timezone euCentral(euCET, euCEST);
+    // A lookup can finish right away, the lock keeps the last one from
+    // completing the update before all were started.
+    for(size_t i = 0; i < this->numberOfPeers; i++) {
+      this->lookup(this->peers[i]);
+    }
 
-      localTime = euCentral.toLocal(this->unixTime);
+    xSemaphoreGiveRecursive(this->lock);
 
-      setTime(localTime);
+    return true;
+  }
 
-      this->didSynchronizeTime = true;
+  //
+  // - private
+  //
+  void Client::lookup(Peer& peer) {
+    ESP_LOGI(LogTag, "look up IP for hostname %s.", peer.host);
+
+    // Either way the address ends up on the NTP task through the queue,
+    // dns_gethostbyname calls back on the lwIP task.
+    if(this->resolver != NULL) {
+      this->resolver->resolve(peer.host, [this, &peer](bool success, const IPAddress& address) {
+        ip_addr_t ipAddress = IPADDR4_INIT((uint32_t)address);
+
+        this->dnsFoundCallback(peer, success ? &ipAddress : NULL);
+      });
+      return;
+    }
 
-      this->doCallback(true);
-    });
+    ip_addr_t ipAddress;
+    err_t error = dns_gethostbyname(peer.host, &ipAddress, (dns_found_callback)&DnsFoundCallback, &peer);
+    if(error == ERR_OK) {
+      ESP_LOGI(LogTag, "nice! directly returned ip.");
+      this->connect(peer, &ipAddress);
+    } else if(error != ERR_INPROGRESS) {
+      ESP_LOGE(LogTag, "could not look up %s (%d).", peer.host, error);
+      this->onPeerDone(peer);
+    }
   }
 
-  bool Client::update(std::function<void(bool)> _callback) {
+  bool Client::connect(Peer& peer, const ip_addr_t* ipAddress) {
     bool success = false;
 
-    if(this->isUpdatingTime) {
-      ESP_LOGE(LogTask, "already updating time.");
-      _callback(false);
+    ESP_LOGI(LogTag, "connecting to " IPSTR " (%s) %d.", IP2STR(&ipAddress->u_addr.ip4), peer.host, xPortGetCoreID());
 
-      return false;
-    }
+    if(peer.udp.connect(ipAddress, this->ntpServerPort)) {
+      ESP_LOGI(LogTag, "connected.");
 
-    this->isUpdatingTime = true;
-    this->callback = _callback;
+      uint8_t packet[Packet::kSize];
 
-    ESP_LOGI(LogTag, "look up IP for hostname %s.", this->ntpServer.c_str());
+      // A late reply to the previous request may be checked against these.
+      xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+      peer.requestTime = this->getClock();
+      peer.originate = Packet::FromUnixMicroseconds(peer.requestTime);
+      Packet::BuildRequest(packet, peer.originate);
+      xSemaphoreGiveRecursive(this->lock);
+
+      peer.udp.write(packet, Packet::kSize);
+      this->statistics.requests++;
 
-    ip_addr_t ipAddress;
-    err_t error = dns_gethostbyname(this->ntpServer.c_str(), &ipAddress, (dns_found_callback)&DnsFoundCallback, this);
-    if(error == ERR_OK) {
-      ESP_LOGI(LogTag, "nice! directly returned ip.");
-      success = this->connect(&ipAddress);
-    } else if(error == ERR_INPROGRESS) {
       success = true;
     } else {
-      // Throw error?
+      ESP_LOGE(LogTag, "failed connecting.");
+
+      this->onPeerDone(peer);
     }
 
     return success;
   }
 
-  bool Client::connect(const ip_addr_t* ipAddress) {
-    static const uint8_t timePacket[Client::kNTPPacketSize] = {
-      0b11100011,                         // LI, Version, Mode
-      0,                                  // Stratum, or type of clock
-      6,                                  // Polling Interval
-      0xec,                               // Peer Clock Precision
-      0,             0, 0, 0, 0, 0, 0, 0, // 8 bytes of zero for Root Delay & Root Dispersion
-      49,
-      0x4e,
-      49,
-      52
-    };
-    bool success = false;
+  int64_t Client::getClock() const {
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+    const int64_t time = this->discipline.toTime(esp_timer_get_time());
+    xSemaphoreGiveRecursive(this->lock);
 
-    ESP_LOGI(LogTag, "connecting to %s (%s) %d.", IPAddress(ipAddress->u_addr.ip4.addr).toString().c_str(), this->ntpServer.c_str(), xPortGetCoreID());
+    return time;
+  }
 
-    if(this->udp.connect(ipAddress, this->ntpServerPort)) {
-      ESP_LOGI(LogTag, "connected.");
-      udp.write(timePacket, Client::kNTPPacketSize);
+  time_t Client::getLocalTime() {
+    return this->timeZone.toLocal(now());
+  }
 
-      success = true;
-    } else {
-      ESP_LOGE(LogTag, "failed connecting.");
+  bool Client::refreshFormatted() {
+    if(!this->didSynchronizeTime) {
+      return false;
+    }
+
+    // Drawn every frame, but only rendered again once the second (minute,
+    // day) changed. TimeLib's own cache breaks the time down once.
+    const time_t localTime = this->getLocalTime();
+    if(this->hasFormattedTime && localTime == this->formattedAt) {
+      return true;
+    }
 
+    const bool isNewMinute = !this->hasFormattedTime || localTime / SECS_PER_MIN != this->formattedAt / SECS_PER_MIN;
+    const bool isNewDay = !this->hasFormattedTime || localTime / SECS_PER_DAY != this->formattedAt / SECS_PER_DAY;
+
+    if(isNewMinute) {
+      FormatTwoDigits(this->formattedShortTime, hour(localTime));
+      this->formattedShortTime[2] = ':';
+      FormatTwoDigits(this->formattedShortTime + 3, minute(localTime));
+      this->formattedShortTime[5] = '\0';
+
+      memcpy(this->formattedTime, this->formattedShortTime, 5);
+      this->formattedTime[5] = ':';
+    }
+
+    FormatTwoDigits(this->formattedTime + 6, second(localTime));
+    this->formattedTime[8] = '\0';
+
+    // "Mon, 01 Jan 2024", the short names are 3 characters.
+    if(isNewDay) {
+      char* date = this->formattedDate;
+      const int _year = year(localTime);
+
+      memcpy(date, dayShortStr(weekday(localTime)), 3);
+      date[3] = ',';
+      date[4] = ' ';
+      FormatTwoDigits(date + 5, day(localTime));
+      date[7] = ' ';
+      memcpy(date + 8, monthShortStr(month(localTime)), 3);
+      date[11] = ' ';
+      FormatTwoDigits(date + 12, _year / 100);
+      FormatTwoDigits(date + 14, _year % 100);
+      date[16] = '\0';
+    }
+
+    this->formattedAt = localTime;
+    this->hasFormattedTime = true;
+
+    return true;
+  }
+
+  void Client::onPacket(Peer& peer, const uint8_t* data, const size_t len, const int64_t receiveTime) {
+    ESP_LOGI(LogTag, "got NTP packet from %s.", peer.host);
+
+    // Replies come in on the AsyncUDP task, while the NTP task sends the
+    // next request or times the peer out.
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    Reply reply;
+    const Packet::Status status = Packet::Parse(data, len, peer.originate, reply);
+
+    bool isDone = false;
+    if(status == Packet::eBogus) {
+      // Late or duplicate answers to an earlier request, keep waiting.
+      ESP_LOGW(LogTag, "ignoring reply to an earlier request.");
+      this->statistics.rejected++;
+    } else if(peer.isPending && status != Packet::eValid) {
+      if(status == Packet::eKissOfDeath) {
+        ESP_LOGE(LogTag, "kiss of death from %s (%s).", peer.host, reply.referenceId);
+        this->statistics.kissOfDeath++;
+      } else {
+        ESP_LOGE(LogTag, "rejected reply from %s (%d).", peer.host, status);
+      }
+
+      this->statistics.rejected++;
+      isDone = true;
+    } else if(peer.isPending) {
+      const Sample sample = Packet::ComputeSample(peer.requestTime,
+                                                  Packet::ToUnixMicroseconds(reply.receive),
+                                                  Packet::ToUnixMicroseconds(reply.transmit),
+                                                  receiveTime);
+
+      ESP_LOGI(LogTag, "%s: offset %lld us, delay %lld us.", peer.host, sample.offset, sample.delay);
+
+      this->statistics.replies++;
+
+      peer.delay = sample.delay;
+      peer.candidate.offset = sample.offset;
+      peer.candidate.distance = sample.delay / 2 + reply.rootDelay / 2 + reply.rootDispersion;
+      if(peer.candidate.distance < kMinDistance) {
+        peer.candidate.distance = kMinDistance;
+      }
+      peer.hasSample = true;
+      isDone = true;
+    }
+
+    xSemaphoreGiveRecursive(this->lock);
+
+    if(isDone) {
+      this->onPeerDone(peer);
+    }
+  }
+
+  void Client::onPeerDone(Peer& peer) {
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    bool isDone = false;
+    if(peer.isPending) {
+      peer.isPending = false;
+      isDone = --this->pendingPeers == 0;
+    }
+
+    xSemaphoreGiveRecursive(this->lock);
+
+    if(isDone) {
+      this->synchronize();
+    }
+  }
+
+  void Client::onTimeout() {
+    // Left over from an earlier update, a new one was started meanwhile.
+    if(millis() - this->updateStartTime < kRequestTimeout / 2) {
+      return;
+    }
+
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+
+    // Nothing is pending when the last reply came in first.
+    bool isDone = false;
+    for(size_t i = 0; i < this->numberOfPeers; i++) {
+      Peer& peer = this->peers[i];
+
+      if(peer.isPending) {
+        ESP_LOGW(LogTag, "no reply from %s.", peer.host);
+
+        peer.isPending = false;
+        this->statistics.timeouts++;
+        isDone = --this->pendingPeers == 0;
+      }
+    }
+
+    xSemaphoreGiveRecursive(this->lock);
+
+    // Sync with the servers that did answer.
+    if(isDone) {
+      this->synchronize();
+    }
+  }
+
+  void Client::synchronize() {
+    Candidate candidates[kMaxServers];
+    bool survivors[kMaxServers];
+    Peer* candidatePeers[kMaxServers];
+    size_t numberOfCandidates = 0;
+
+    for(size_t i = 0; i < this->numberOfPeers; i++) {
+      if(this->peers[i].hasSample) {
+        candidatePeers[numberOfCandidates] = &this->peers[i];
+        candidates[numberOfCandidates++] = this->peers[i].candidate;
+      }
+    }
+
+    int64_t offset = 0;
+    const size_t numberOfSurvivors = Selection::Select(candidates, numberOfCandidates, survivors, offset);
+
+    this->statistics.candidates = numberOfCandidates;
+    this->statistics.survivors = numberOfSurvivors;
+
+    if(numberOfSurvivors == 0) {
+      ESP_LOGE(LogTag, "no majority among %d server(s).", numberOfCandidates);
+
+      this->nextUpdateTime = millis() + (1000UL << Discipline::kMinPoll);
       this->doCallback(false);
+      return;
     }
 
-    return success;
+    // Report the round trip of the closest survivor.
+    int64_t delay = 0;
+    int64_t distance = 0;
+    for(size_t i = 0; i < numberOfCandidates; i++) {
+      if(survivors[i] && (distance == 0 || candidates[i].distance < distance)) {
+        distance = candidates[i].distance;
+        delay = candidatePeers[i]->delay;
+      }
+    }
+
+    // The first offset is the whole time since 1970, only what's left after
+    // that says something about the clock.
+    if(this->didSynchronizeTime) {
+      const float residual = (float)offset;
+      this->jitterSquared += (residual * residual - this->jitterSquared) / 4.0f;
+      this->statistics.jitter = (uint32_t)sqrtf(this->jitterSquared);
+    }
+
+    this->statistics.offset = offset;
+    this->statistics.delay = delay;
+
+    ESP_LOGI(LogTag, "%d of %d server(s) agree, offset %lld us, jitter %u us.", numberOfSurvivors, numberOfCandidates, offset, this->statistics.jitter);
+
+    // Small offsets are slewed, so the clock keeps running forward.
+    xSemaphoreTakeRecursive(this->lock, portMAX_DELAY);
+    if(this->discipline.update(esp_timer_get_time(), offset)) {
+      this->statistics.steps++;
+    }
+    xSemaphoreGiveRecursive(this->lock);
+
+    this->statistics.frequency = this->discipline.getFrequency();
+    this->statistics.pollInterval = this->discipline.getPollInterval();
+    this->nextUpdateTime = millis() + this->statistics.pollInterval * 1000UL;
+
+    ESP_LOGI(LogTag, "frequency %.2f ppm, next sync in %u s.", this->statistics.frequency, this->statistics.pollInterval);
+
+    this->unixTime = this->getClock() / 1000000LL;
+
+    // TimeLib follows the disciplined clock (in UTC) instead of being set once per
+    // sync and drifting with the crystal in between.
+    if(!this->didSynchronizeTime) {
+      TimeSource = this;
+      setSyncInterval(kTimeLibSyncInterval);
+      setSyncProvider(&Client::SyncProvider);
+    }
+
+    this->didSynchronizeTime = true;
+
+    this->doCallback(true);
   }
 
   void Client::doCallback(bool success) {
+    xTimerStop(this->timeoutTimer, 0);
+
     if(this->callback) {
       this->callback(success);
     } else {
@@ -222,54 +484,77 @@ namespace Ntp {
     this->isUpdatingTime = false;
   }
 
-  void Client::dnsFoundCallback(const char *name, ip_addr_t* ipAddress) {
+  void Client::dnsFoundCallback(Peer& peer, ip_addr_t* ipAddress) {
+    QueueData data = { eLookedUp, this, &peer, IPADDR4_INIT(0) };
     if(ipAddress) {
-      QueueData* data = (QueueData *)malloc(sizeof(QueueData));
-
-      data->ipAddress = *ipAddress;
-      data->context = this;
-
-      ESP_LOGE(LogTag, "adding to queue (%s).", name);
-
-      if (xQueueSend(NtpQueue, &data, portMAX_DELAY) != pdPASS) {
-        ESP_LOGE(LogTag, "error adding to queue (%s)!", name);
+      data.ipAddress = *ipAddress;
+    } else {
+      data.event = eLookupFailed;
+    }
 
-        free((void*)data);
+    // Possibly called on the lwIP task, which must not block or take the
+    // lock. A dropped lookup is covered by the timeout.
+    if (xQueueSend(NtpQueue, &data, 0) != pdPASS) {
+      ESP_LOGE(LogTag, "error adding to queue (%s)!", peer.host);
+    }
+  }
 
-        this->doCallback(false);
-      }
-    } else {
-      ESP_LOGE(LogTag, "could not resolve IP for %s.", name);
+  void Client::FormatTwoDigits(char* buffer, const int value) {
+    buffer[0] = '0' + (value / 10) % 10;
+    buffer[1] = '0' + value % 10;
+  }
 
-      this->doCallback(false);
+  time_t Client::SyncProvider() {
+    if(TimeSource == NULL || !TimeSource->discipline.isSet()) {
+      return 0;
     }
+
+    return TimeSource->getClock() / 1000000LL;
   }
 
   void Client::DnsFoundCallback(const char* name, ip_addr_t* ipAddress, void* arg) {
     if(arg != NULL) {
-      Client *self = reinterpret_cast<Client *>(arg);
+      Peer *peer = reinterpret_cast<Peer *>(arg);
 
-      self->dnsFoundCallback(name, ipAddress);
+      peer->client->dnsFoundCallback(*peer, ipAddress);
     } else {
       ESP_LOGE(LogTag, "no callback set!");
     }
   }
 
-  // static void _udp_task(void *pvParameters){
+  void Client::OnTimeoutTimer(TimerHandle_t timer) {
+    Client* client = reinterpret_cast<Client *>(pvTimerGetTimerID(timer));
+
+    // The timer task has little stack, sync on the NTP task instead.
+    const QueueData data = { eTimedOut, client, NULL, IPADDR4_INIT(0) };
+    if(xQueueSend(NtpQueue, &data, 0) != pdPASS) {
+      ESP_LOGE(LogTag, "error adding timeout to queue!");
+    }
+  }
+
+  // Nothing runs on the lwIP task (see Dns::Resolver), lookups and
+  // timeouts are handled here.
   void Client::UdpTask(void* params) {
-    QueueData* data = NULL;
+    QueueData data;
 
     for (;;) {
       if(xQueueReceive(NtpQueue, &data, portMAX_DELAY) == pdTRUE) {
-        ESP_LOGI(LogTag, "got item from queue.");
-
-        data->context->connect(&data->ipAddress);
-
-        free((void*)data);
+        switch(data.event) {
+          case eLookedUp:
+            if(data.peer->isPending) {
+              data.client->connect(*data.peer, &data.ipAddress);
+            }
+            break;
+          case eLookupFailed:
+            ESP_LOGE(LogTag, "could not resolve IP for %s.", data.peer->host);
+
+            data.client->onPeerDone(*data.peer);
+            break;
+          case eTimedOut:
+            data.client->onTimeout();
+            break;
+        }
       }
-
-      // Needed?
-      delay(10);
     }
 
     ESP_LOGI(LogTag, "exit NTP task.");
@@ -1,6 +1,12 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <AsyncUDP.h>
+#include <freertos/timers.h>
+#include "dns/resolver.h"
+#include "packet.h"
+#include "selection.h"
+#include "discipline.h"
+#include "time_zone.h"
 
 extern "C" {
     #include "lwip/init.h"
@@ -16,34 +22,136 @@ class Client;
 namespace Ntp {
   class Client {
     public:
+      static const size_t kMaxServers = 4;
+      static const size_t kMaxHostLength = 64;
+
+      struct Statistics {
+        uint32_t requests;
+        uint32_t replies;
+        uint32_t rejected;
+        uint32_t kissOfDeath;
+        // Servers that didn't answer in time.
+        uint32_t timeouts;
+        // Servers that answered and agreed with the majority at the last
+        // sync, and the ones that answered at all.
+        uint8_t survivors;
+        uint8_t candidates;
+        // Of the last sync, in microseconds.
+        int64_t offset;
+        int64_t delay;
+        // RMS of the offsets left after the first sync, in microseconds.
+        uint32_t jitter;
+        // Times the clock had to be stepped instead of slewed.
+        uint32_t steps;
+        // Estimated frequency error of the clock, in parts per million.
+        float frequency;
+        // Time between syncs, in seconds.
+        uint32_t pollInterval;
+      };
+
       Client();
       ~Client();
 
       void setup(const String& ntpServer, const uint16_t port = 123);
+
+      // The servers are queried side by side, servers that disagree with
+      // the majority are left out. Host names are copied.
+      void setup(const char* const* ntpServers, const size_t numberOfServers, const uint16_t port = 123);
+      void setResolver(Dns::Resolver* resolver);
       bool update(std::function<void(bool)> _callback);
-      bool getFormattedTime(String& time);
-      bool getFormattedDate(String& _date);
+
+      // Whether the poll interval passed since the last sync. Sooner after
+      // a failed one, or when the time was never set.
+      bool isUpdateDue() const;
+      // Local time as "HH:MM:SS" or "HH:MM" and date as "Mon, 01 Jan 2024",
+      // NULL until the time is set. Rendered into fixed buffers at most
+      // once per second, the pointers stay valid.
+      const char* getFormattedTime();
+      const char* getFormattedShortTime();
+      const char* getFormattedDate();
+      // In UTC, only the formatted time and date are local.
       bool getUnixTime(unsigned long& unixTime);
+
+      // Rules as in lib/Timezone, UTC until set.
+      void setTimeZone(const TimeChangeRule& daylightSavingTime, const TimeChangeRule& standardTime);
+      const Statistics& getStatistics() const;
     private:
+      struct Peer {
+        Client* client;
+        char host[kMaxHostLength];
+        AsyncUDP udp;
+        bool isPending;
+        bool hasSample;
+        // Transmit timestamp of the outstanding request, as local time and
+        // as sent (the reply echoes it).
+        int64_t requestTime;
+        Timestamp originate;
+        int64_t delay;
+        Candidate candidate;
+      };
+
+      enum Event {
+        eLookedUp,
+        eLookupFailed,
+        eTimedOut
+      };
+
+      // Passed by value to the NTP task, peer is NULL when the update of
+      // client timed out.
       struct QueueData {
+        Event event;
+        Client* client;
+        Peer* peer;
         ip_addr_t ipAddress;
-        Client* context;
       };
 
-      static const int kNTPPacketSize = 48;
+      // Floor of a server's distance, covers our own clock's resolution.
+      static const int64_t kMinDistance = 1000;
+      // Servers that didn't answer by then are left out, in milliseconds.
+      static const uint32_t kRequestTimeout = 10000;
+      // Between syncs TimeLib counts on its own, in seconds.
+      static const time_t kTimeLibSyncInterval = 60;
+
       bool didSynchronizeTime = false;
       bool isUpdatingTime = false;
-      AsyncUDP udp;
       unsigned long unixTime;
-      String ntpServer;
+      Discipline discipline;
+      TimeZone timeZone;
+      bool hasFormattedTime = false;
+      time_t formattedAt = 0;
+      char formattedTime[9];
+      char formattedShortTime[6];
+      char formattedDate[17];
+      // In milliseconds, as millis().
+      unsigned long nextUpdateTime = 0;
+      unsigned long updateStartTime = 0;
+      TimerHandle_t timeoutTimer;
+      float jitterSquared = 0.0f;
+      Statistics statistics = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0f, 0 };
+      Peer peers[kMaxServers];
+      size_t numberOfPeers = 0;
+      size_t pendingPeers = 0;
       uint16_t ntpServerPort;
+      Dns::Resolver* resolver = NULL;
+      SemaphoreHandle_t lock;
       std::function<void(bool)> callback;
 
-      bool connect(const ip_addr_t* ipAddress);
+      void lookup(Peer& peer);
+      bool connect(Peer& peer, const ip_addr_t* ipAddress);
+      int64_t getClock() const;
+      void onPacket(Peer& peer, const uint8_t* data, const size_t len, const int64_t receiveTime);
+      void onPeerDone(Peer& peer);
+      void onTimeout();
+      void synchronize();
+      time_t getLocalTime();
+      bool refreshFormatted();
       void doCallback(bool success);
-      void dnsFoundCallback(const char* name, ip_addr_t* ipAddress);
+      void dnsFoundCallback(Peer& peer, ip_addr_t* ipAddress);
       static void DnsFoundCallback(const char* name, ip_addr_t* ipAddress, void* arg);
+      static void OnTimeoutTimer(TimerHandle_t timer);
       static void UdpTask(void* params);
+      static time_t SyncProvider();
+      static void FormatTwoDigits(char* buffer, const int value);
   };
 }
 
@@ -0,0 +1,146 @@
+#include "packet.h"
+#include <string.h>
+
+namespace Ntp {
+  // Seconds from 1900 to 1970.
+  static const int64_t kUnixEpoch = 2208988800LL;
+  static const int64_t kEraLength = 4294967296LL;
+  static const int64_t kMicrosecondsPerSecond = 1000000LL;
+
+  static const uint8_t kVersion = 4;
+  static const uint8_t kModeClient = 3;
+  static const uint8_t kModeServer = 4;
+  static const uint8_t kLeapUnsynchronized = 3;
+  static const uint8_t kMaxStratum = 15;
+
+  void Packet::BuildRequest(uint8_t* buffer, const Timestamp& transmit) {
+    // Everything but the header and transmit timestamp stays zero.
+    memset(buffer, 0, kSize);
+
+    buffer[0] = (kVersion << 3) | kModeClient;
+
+    Write32(buffer + 40, transmit.seconds);
+    Write32(buffer + 44, transmit.fraction);
+  }
+
+  Packet::Status Packet::Parse(const uint8_t* data, const size_t len, const Timestamp& originate, Reply& reply) {
+    if(data == NULL || len < kSize) {
+      return eTooShort;
+    }
+
+    reply.leap = data[0] >> 6;
+    reply.version = (data[0] >> 3) & 0x07;
+    reply.mode = data[0] & 0x07;
+    reply.stratum = data[1];
+    reply.poll = (int8_t)data[2];
+    reply.precision = (int8_t)data[3];
+    reply.rootDelay = ReadShort(data + 4);
+    reply.rootDispersion = ReadShort(data + 8);
+    memcpy(reply.referenceId, data + 12, 4);
+    reply.referenceId[4] = '\0';
+    reply.originate = ReadTimestamp(data + 24);
+    reply.receive = ReadTimestamp(data + 32);
+    reply.transmit = ReadTimestamp(data + 40);
+
+    if(reply.mode != kModeServer) {
+      return eNotServer;
+    }
+
+    if(reply.version < 1 || reply.version > kVersion) {
+      return eBadVersion;
+    }
+
+    // Stratum 0 carries a kiss code (e.g. RATE, DENY) in the reference id.
+    if(reply.stratum == 0) {
+      return eKissOfDeath;
+    }
+
+    if(reply.leap == kLeapUnsynchronized) {
+      return eUnsynchronized;
+    }
+
+    if(reply.stratum > kMaxStratum) {
+      return eBadStratum;
+    }
+
+    // Not the answer to our last request (late, duplicate or spoofed).
+    if(reply.originate.seconds != originate.seconds || reply.originate.fraction != originate.fraction) {
+      return eBogus;
+    }
+
+    if(reply.transmit.seconds == 0 && reply.transmit.fraction == 0) {
+      return eNoTransmitTime;
+    }
+
+    return eValid;
+  }
+
+  Sample Packet::ComputeSample(const int64_t t1, const int64_t t2, const int64_t t3, const int64_t t4) {
+    Sample sample;
+
+    sample.offset = ((t2 - t1) + (t3 - t4)) / 2;
+    sample.delay = (t4 - t1) - (t3 - t2);
+
+    // Can go slightly negative when the server's clock resolution is coarser
+    // than ours.
+    if(sample.delay < 0) {
+      sample.delay = 0;
+    }
+
+    return sample;
+  }
+
+  int64_t Packet::ToUnixMicroseconds(const Timestamp& timestamp) {
+    int64_t seconds = timestamp.seconds;
+    if((timestamp.seconds & 0x80000000) == 0) {
+      seconds += kEraLength;
+    }
+
+    const int64_t fraction = ((uint64_t)timestamp.fraction * kMicrosecondsPerSecond) >> 32;
+
+    return (seconds - kUnixEpoch) * kMicrosecondsPerSecond + fraction;
+  }
+
+  Timestamp Packet::FromUnixMicroseconds(const int64_t microseconds) {
+    int64_t seconds = microseconds / kMicrosecondsPerSecond;
+    int64_t remainder = microseconds % kMicrosecondsPerSecond;
+    if(remainder < 0) {
+      seconds -= 1;
+      remainder += kMicrosecondsPerSecond;
+    }
+
+    Timestamp timestamp;
+    timestamp.seconds = (uint32_t)(seconds + kUnixEpoch);
+    // Rounded up, so converting back gives the same microsecond.
+    timestamp.fraction = (uint32_t)((((uint64_t)remainder << 32) + kMicrosecondsPerSecond - 1) / kMicrosecondsPerSecond);
+
+    return timestamp;
+  }
+
+  //
+  // - private
+  //
+  uint32_t Packet::Read32(const uint8_t* data) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+  }
+
+  // 16.16 fixed point seconds to microseconds.
+  uint32_t Packet::ReadShort(const uint8_t* data) {
+    return ((uint64_t)Read32(data) * kMicrosecondsPerSecond) >> 16;
+  }
+
+  void Packet::Write32(uint8_t* data, const uint32_t value) {
+    data[0] = value >> 24;
+    data[1] = value >> 16;
+    data[2] = value >> 8;
+    data[3] = value;
+  }
+
+  Timestamp Packet::ReadTimestamp(const uint8_t* data) {
+    Timestamp timestamp;
+    timestamp.seconds = Read32(data);
+    timestamp.fraction = Read32(data + 4);
+
+    return timestamp;
+  }
+}
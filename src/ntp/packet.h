@@ -0,0 +1,81 @@
+#ifndef _NTP_PACKET_H_
+#define _NTP_PACKET_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Ntp {
+  // 32.32 fixed point seconds since 1900 (era 0) as sent on the wire.
+  struct Timestamp {
+    uint32_t seconds;
+    uint32_t fraction;
+  };
+
+  // Offset of the local clock to the server and the round trip delay, in
+  // microseconds. A positive offset means the local clock is behind.
+  struct Sample {
+    int64_t offset;
+    int64_t delay;
+  };
+
+  // The fields of a server reply that matter to an SNTP client.
+  struct Reply {
+    uint8_t leap;
+    uint8_t version;
+    uint8_t mode;
+    uint8_t stratum;
+    int8_t poll;
+    int8_t precision;
+    // Of the server to its reference clock, in microseconds.
+    uint32_t rootDelay;
+    uint32_t rootDispersion;
+    char referenceId[5];
+    Timestamp originate;
+    Timestamp receive;
+    Timestamp transmit;
+  };
+
+  // SNTPv4 (RFC 4330) packets, kept free of Arduino and lwIP so the math
+  // can be checked on a host.
+  class Packet {
+    public:
+      static const size_t kSize = 48;
+
+      enum Status {
+        eValid = 0,
+        eTooShort,
+        eNotServer,
+        eBadVersion,
+        eUnsynchronized,
+        eKissOfDeath,
+        eBadStratum,
+        eBogus,
+        eNoTransmitTime
+      };
+
+      // Client request, transmit is echoed by the server as originate.
+      static void BuildRequest(uint8_t* buffer, const Timestamp& transmit);
+
+      // Checks the reply to a request that was sent with originate as
+      // transmit timestamp.
+      static Status Parse(const uint8_t* data, const size_t len, const Timestamp& originate, Reply& reply);
+
+      // From the four timestamps of an exchange, all in microseconds since
+      // the Unix epoch: request sent (t1), received by the server (t2),
+      // answered by the server (t3) and the answer received (t4).
+      static Sample ComputeSample(const int64_t t1, const int64_t t2, const int64_t t3, const int64_t t4);
+
+      // Timestamps with the top bit cleared are taken to be after the era
+      // rollover in 2036.
+      static int64_t ToUnixMicroseconds(const Timestamp& timestamp);
+      static Timestamp FromUnixMicroseconds(const int64_t microseconds);
+
+    private:
+      static uint32_t Read32(const uint8_t* data);
+      static uint32_t ReadShort(const uint8_t* data);
+      static void Write32(uint8_t* data, const uint32_t value);
+      static Timestamp ReadTimestamp(const uint8_t* data);
+  };
+}
+
+#endif // _NTP_PACKET_H_
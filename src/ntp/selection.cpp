@@ -0,0 +1,111 @@
+#include "selection.h"
+
+namespace Ntp {
+  size_t Selection::Select(const Candidate* candidates, const size_t numberOfCandidates, bool* survivors, int64_t& offset) {
+    const size_t n = numberOfCandidates < kMaxCandidates ? numberOfCandidates : kMaxCandidates;
+    if(survivors != NULL) {
+      for(size_t i = 0; i < numberOfCandidates; i++) {
+        survivors[i] = false;
+      }
+    }
+
+    if(n == 0) {
+      return 0;
+    }
+
+    // Lower edges open an interval (+1), upper edges close one (-1).
+    Edge edges[2 * kMaxCandidates];
+    for(size_t i = 0; i < n; i++) {
+      edges[2 * i].value = candidates[i].offset - candidates[i].distance;
+      edges[2 * i].type = 1;
+      edges[2 * i + 1].value = candidates[i].offset + candidates[i].distance;
+      edges[2 * i + 1].type = -1;
+    }
+
+    Sort(edges, 2 * n);
+
+    // Allow for f falsetickers, as long as the rest is a majority.
+    int64_t low = 0;
+    int64_t high = 0;
+    bool found = false;
+
+    for(size_t f = 0; 2 * f < n && !found; f++) {
+      const int needed = n - f;
+      int count = 0;
+
+      for(size_t i = 0; i < 2 * n; i++) {
+        count += edges[i].type;
+        if(count >= needed) {
+          low = edges[i].value;
+          break;
+        }
+      }
+
+      count = 0;
+      for(size_t i = 2 * n; i > 0; i--) {
+        count -= edges[i - 1].type;
+        if(count >= needed) {
+          high = edges[i - 1].value;
+          break;
+        }
+      }
+
+      found = count >= needed && low <= high;
+    }
+
+    if(!found) {
+      return 0;
+    }
+
+    // Weighted by 1 / distance, the closest server counts most.
+    size_t numberOfSurvivors = 0;
+    float weights = 0.0f;
+    float sum = 0.0f;
+
+    for(size_t i = 0; i < n; i++) {
+      const Candidate& candidate = candidates[i];
+      const bool survives = candidate.offset - candidate.distance <= high && candidate.offset + candidate.distance >= low;
+
+      if(survives) {
+        if(survivors != NULL) {
+          survivors[i] = true;
+        }
+
+        const float weight = 1.0f / (candidate.distance > 0 ? candidate.distance : 1);
+
+        // Relative to the first survivor, the offsets can be far too large
+        // for a float before the first sync.
+        if(numberOfSurvivors == 0) {
+          offset = candidate.offset;
+        }
+
+        sum += weight * (candidate.offset - offset);
+        weights += weight;
+        numberOfSurvivors++;
+      }
+    }
+
+    offset += (int64_t)(sum / weights);
+
+    return numberOfSurvivors;
+  }
+
+  //
+  // - private
+  //
+  void Selection::Sort(Edge* edges, const size_t numberOfEdges) {
+    // Insertion sort, there are only a few. At the same value lower edges go
+    // first, so intervals that only touch still intersect.
+    for(size_t i = 1; i < numberOfEdges; i++) {
+      const Edge edge = edges[i];
+      size_t j = i;
+
+      while(j > 0 && (edges[j - 1].value > edge.value || (edges[j - 1].value == edge.value && edges[j - 1].type < edge.type))) {
+        edges[j] = edges[j - 1];
+        j--;
+      }
+
+      edges[j] = edge;
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef _NTP_SELECTION_H_
+#define _NTP_SELECTION_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Ntp {
+  // Offset measured against one server and how far off it may be (half the
+  // round trip plus the server's own root distance), in microseconds.
+  struct Candidate {
+    int64_t offset;
+    int64_t distance;
+  };
+
+  // Clock selection along the lines of RFC 5905: Marzullo's algorithm finds
+  // the smallest interval that most candidates agree on, candidates that
+  // don't overlap it are falsetickers. The survivors are averaged, weighted
+  // by their distance.
+  class Selection {
+    public:
+      static const size_t kMaxCandidates = 8;
+
+      // Returns the number of survivors, 0 when no majority agrees. survivors
+      // (may be NULL) marks which candidates were used.
+      static size_t Select(const Candidate* candidates, const size_t numberOfCandidates, bool* survivors, int64_t& offset);
+
+    private:
+      struct Edge {
+        int64_t value;
+        int8_t type;
+      };
+
+      static void Sort(Edge* edges, const size_t numberOfEdges);
+  };
+}
+
+#endif // _NTP_SELECTION_H_
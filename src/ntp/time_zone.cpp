@@ -0,0 +1,123 @@
+#include "time_zone.h"
+#include <limits>
+
+namespace Ntp {
+  TimeZone::TimeZone(const TimeChangeRule& daylightSavingTime, const TimeChangeRule& standardTime) {
+    this->setRules(daylightSavingTime, standardTime);
+  }
+
+  void TimeZone::setRules(const TimeChangeRule& daylightSavingTime, const TimeChangeRule& standardTime) {
+    this->daylightSavingTime = daylightSavingTime;
+    this->standardTime = standardTime;
+
+    // Empty period, the next conversion works it out.
+    this->periodStart = 0;
+    this->periodEnd = 0;
+  }
+
+  time_t TimeZone::toLocal(const time_t utc) {
+    if(utc < this->periodStart || utc >= this->periodEnd) {
+      this->updatePeriod(utc);
+    }
+
+    return utc + this->periodOffset;
+  }
+
+  const char* TimeZone::getAbbreviation(const time_t utc) {
+    if(utc < this->periodStart || utc >= this->periodEnd) {
+      this->updatePeriod(utc);
+    }
+
+    return this->periodRule->abbrev;
+  }
+
+  //
+  // - private
+  //
+  void TimeZone::updatePeriod(const time_t utc) {
+    const TimeChangeRule& daylight = this->daylightSavingTime;
+    const TimeChangeRule& standard = this->standardTime;
+
+    // Without daylight saving time there's a single period.
+    if(daylight.offset == standard.offset) {
+      this->periodStart = 0;
+      this->periodEnd = std::numeric_limits<time_t>::max();
+      this->periodOffset = standard.offset * SECS_PER_MIN;
+      this->periodRule = &this->standardTime;
+      return;
+    }
+
+    // The changes of the year before, this year and the next, in order.
+    struct Change {
+      time_t time;
+      const TimeChangeRule* rule;
+    } changes[6];
+
+    const int currentYear = year(utc);
+    size_t count = 0;
+
+    for(int y = currentYear - 1; y <= currentYear + 1; y++) {
+      const time_t dstStart = this->changeTime(daylight, y, standard.offset);
+      const time_t stdStart = this->changeTime(standard, y, daylight.offset);
+
+      // Southern hemisphere zones start daylight saving time late in the year.
+      if(dstStart < stdStart) {
+        changes[count++] = { dstStart, &this->daylightSavingTime };
+        changes[count++] = { stdStart, &this->standardTime };
+      } else {
+        changes[count++] = { stdStart, &this->standardTime };
+        changes[count++] = { dstStart, &this->daylightSavingTime };
+      }
+    }
+
+    for(size_t i = 0; i + 1 < count; i++) {
+      if(utc >= changes[i].time && utc < changes[i + 1].time) {
+        this->periodStart = changes[i].time;
+        this->periodEnd = changes[i + 1].time;
+        this->periodRule = changes[i].rule;
+        this->periodOffset = changes[i].rule->offset * SECS_PER_MIN;
+        return;
+      }
+    }
+
+    // Can't happen with sane rules, convert without caching.
+    this->periodStart = 0;
+    this->periodEnd = 0;
+    this->periodRule = &this->standardTime;
+    this->periodOffset = standard.offset * SECS_PER_MIN;
+  }
+
+  // Same as Timezone::toTime_t, the rule's local time converted to UTC with
+  // the offset that was in effect before the change.
+  time_t TimeZone::changeTime(const TimeChangeRule& rule, const int year, const int previousOffset) const {
+    int y = year;
+    uint8_t month = rule.month;
+    uint8_t week = rule.week;
+
+    // Last week: first week of the next month, minus a week.
+    if(week == Last) {
+      if(++month > 12) {
+        month = 1;
+        y++;
+      }
+      week = First;
+    }
+
+    tmElements_t tm;
+    tm.Hour = rule.hour;
+    tm.Minute = 0;
+    tm.Second = 0;
+    tm.Day = 1;
+    tm.Month = month;
+    tm.Year = y - 1970;
+
+    time_t t = makeTime(tm);
+    t += (7 * (week - 1) + (rule.dow - weekday(t) + 7) % 7) * SECS_PER_DAY;
+
+    if(rule.week == Last) {
+      t -= 7 * SECS_PER_DAY;
+    }
+
+    return t - previousOffset * SECS_PER_MIN;
+  }
+}
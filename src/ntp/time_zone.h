@@ -0,0 +1,38 @@
+#ifndef _NTP_TIME_ZONE_H_
+#define _NTP_TIME_ZONE_H_
+
+#include <Arduino.h>
+#include <TimeLib.h>
+#include <Timezone.h>
+
+namespace Ntp {
+  // UTC to local time with the rules of lib/Timezone. The period between two
+  // time changes that was last converted is kept, so converting is a range
+  // check and an add until the next change.
+  class TimeZone {
+    public:
+      TimeZone(const TimeChangeRule& daylightSavingTime, const TimeChangeRule& standardTime);
+
+      void setRules(const TimeChangeRule& daylightSavingTime, const TimeChangeRule& standardTime);
+
+      time_t toLocal(const time_t utc);
+
+      // Abbreviation of the rule in effect at utc, e.g. "CEST".
+      const char* getAbbreviation(const time_t utc);
+
+    private:
+      TimeChangeRule daylightSavingTime;
+      TimeChangeRule standardTime;
+
+      // [periodStart, periodEnd) in UTC, with its offset in seconds.
+      time_t periodStart = 0;
+      time_t periodEnd = 0;
+      long periodOffset = 0;
+      const TimeChangeRule* periodRule = NULL;
+
+      void updatePeriod(const time_t utc);
+      time_t changeTime(const TimeChangeRule& rule, const int year, const int previousOffset) const;
+  };
+}
+
+#endif // _NTP_TIME_ZONE_H_
@@ -0,0 +1,165 @@
+#include "client.h"
+#include <string.h>
+#include <stdlib.h>
+
+namespace openmeteo {
+  const Json::Projection::Field Client::kFields[] = {
+    { "current_weather.temperature", eTemperature },
+    { "current_weather.weathercode", eWeatherCode },
+    { "current_weather.is_day", eIsDay },
+    { "daily.time[*]", eForecastDate },
+    { "daily.weathercode[*]", eForecastWeatherCode },
+    { "daily.temperature_2m_max[*]", eForecastHighTemperature },
+    { "daily.temperature_2m_min[*]", eForecastLowTemperature }
+  };
+
+  const size_t Client::kNumberOfFields = sizeof(Client::kFields) / sizeof(Client::kFields[0]);
+
+  // WMO weather interpretation codes, mapped to the closest day icon.
+  const Client::WeatherCode Client::kWeatherCodes[] = {
+    { 0, Weather::eClear, "Clear sky" },
+    { 1, Weather::eMostlySunny, "Mainly clear" },
+    { 2, Weather::ePartlyCloudy, "Partly cloudy" },
+    { 3, Weather::eCloudy, "Overcast" },
+    { 45, Weather::eFog, "Fog" },
+    { 48, Weather::eFog, "Rime fog" },
+    { 51, Weather::eChanceRain, "Light drizzle" },
+    { 53, Weather::eChanceRain, "Drizzle" },
+    { 55, Weather::eChanceRain, "Dense drizzle" },
+    { 56, Weather::eSleet, "Freezing drizzle" },
+    { 57, Weather::eSleet, "Freezing drizzle" },
+    { 61, Weather::eRain, "Light rain" },
+    { 63, Weather::eRain, "Rain" },
+    { 65, Weather::eRain, "Heavy rain" },
+    { 66, Weather::eSleet, "Freezing rain" },
+    { 67, Weather::eSleet, "Freezing rain" },
+    { 71, Weather::eSnow, "Light snow" },
+    { 73, Weather::eSnow, "Snow" },
+    { 75, Weather::eSnow, "Heavy snow" },
+    { 77, Weather::eFlurries, "Snow grains" },
+    { 80, Weather::eChanceRain, "Rain showers" },
+    { 81, Weather::eChanceRain, "Rain showers" },
+    { 82, Weather::eChanceRain, "Heavy showers" },
+    { 85, Weather::eChanceSnow, "Snow showers" },
+    { 86, Weather::eChanceSnow, "Snow showers" },
+    { 95, Weather::eTstorms, "Thunderstorm" },
+    { 96, Weather::eTstorms, "Thunderstorm, hail" },
+    { 99, Weather::eTstorms, "Thunderstorm, hail" }
+  };
+
+  const size_t Client::kNumberOfWeatherCodes = sizeof(Client::kWeatherCodes) / sizeof(Client::kWeatherCodes[0]);
+
+  Client::Client(const String& latitude,
+                 const String& longitude,
+                 const String& name) : StreamingProvider(kFields, kNumberOfFields), latitude(latitude), longitude(longitude), name(name) {}
+
+  Client::~Client() {}
+
+  //
+  // - protected
+  //
+  String Client::getUri(const Weather::Feed feed) const {
+    const String uri = String(kApiUri) + "/v1/forecast?latitude=" + latitude + "&longitude=" + longitude;
+
+    if(feed == Weather::eObservation) {
+      return uri + "&current_weather=true";
+    }
+
+    return uri + "&daily=weathercode,temperature_2m_max,temperature_2m_min&timezone=auto&forecast_days=4";
+  }
+
+  void Client::beginParse(const Weather::Feed) {
+    this->weatherCode = -1;
+    this->isDay = true;
+
+    this->pendingConditions.setCity(this->name.c_str());
+  }
+
+  void Client::onValue(const uint8_t field, const size_t index, const char* value) {
+    Weather::Conditions& conditions = this->pendingConditions;
+
+    switch(field) {
+      case eTemperature:
+        conditions.setTemperature(atof(value));
+        break;
+      case eWeatherCode:
+        this->weatherCode = atoi(value);
+        this->updateIcon();
+        break;
+      case eIsDay:
+        this->isDay = atoi(value) != 0;
+        this->updateIcon();
+        break;
+      case eForecastDate:
+        conditions.setForecastTitle(index, WeekdayFromDate(value));
+        break;
+      case eForecastWeatherCode: {
+        const WeatherCode* weatherCode = FindWeatherCode(atoi(value));
+        conditions.setForecastIcon(index, weatherCode != NULL ? weatherCode->icon : Weather::eUnknownIcon);
+        break;
+      }
+      case eForecastHighTemperature:
+        conditions.setForecastHighTemperature(index, atof(value));
+        break;
+      case eForecastLowTemperature:
+        conditions.setForecastLowTemperature(index, atof(value));
+        break;
+      default:
+        break;
+    }
+  }
+
+  //
+  // - private
+  //
+  void Client::updateIcon() {
+    const WeatherCode* weatherCode = FindWeatherCode(this->weatherCode);
+
+    if(weatherCode == NULL) {
+      this->pendingConditions.setIcon(Weather::eUnknownIcon);
+      this->pendingConditions.setTitle("");
+      return;
+    }
+
+    // Night icons follow the day icons in the same order.
+    Weather::Icon icon = weatherCode->icon;
+    if(!this->isDay) {
+      icon = static_cast<Weather::Icon>(icon + (Weather::eNightChanceFlurries - Weather::eChanceFlurries));
+    }
+
+    this->pendingConditions.setIcon(icon);
+    this->pendingConditions.setTitle(weatherCode->title);
+  }
+
+  const Client::WeatherCode* Client::FindWeatherCode(const int code) {
+    for(size_t i = 0; i < kNumberOfWeatherCodes; i++) {
+      if(kWeatherCodes[i].code == code) {
+        return &kWeatherCodes[i];
+      }
+    }
+
+    return NULL;
+  }
+
+  const char* Client::WeekdayFromDate(const char* date) {
+    static const char* const kWeekdays[] = {
+      "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
+    };
+    static const int kMonthOffsets[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+
+    // YYYY-MM-DD, day of the week with Sakamoto's method.
+    int year = atoi(date);
+    const int month = strlen(date) >= 7 ? atoi(date + 5) : 0;
+    const int day = strlen(date) >= 10 ? atoi(date + 8) : 0;
+
+    if(month < 1 || month > 12 || day < 1 || day > 31) {
+      return "";
+    }
+
+    if(month < 3) {
+      year -= 1;
+    }
+
+    return kWeekdays[(year + year / 4 - year / 100 + year / 400 + kMonthOffsets[month - 1] + day) % 7];
+  }
+}
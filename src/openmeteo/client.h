@@ -0,0 +1,59 @@
+#include <Arduino.h>
+#include "weather/streaming_provider.h"
+
+#ifndef OPENMETEO_CLIENT_H_
+#define OPENMETEO_CLIENT_H_
+
+namespace openmeteo {
+  static const char kApiUri[] PROGMEM = "http://api.open-meteo.com";
+
+  // Current weather and daily forecast from Open-Meteo, no API key needed.
+  // The API doesn't name the location, name is shown as the city.
+  class Client : public Weather::StreamingProvider {
+    public:
+      Client(const String& latitude, const String& longitude, const String& name);
+      ~Client();
+
+    protected:
+      String getUri(const Weather::Feed feed) const override;
+      void beginParse(const Weather::Feed feed) override;
+      void onValue(const uint8_t field, const size_t index, const char* value) override;
+
+    private:
+      enum Field {
+        eTemperature,
+        eWeatherCode,
+        eIsDay,
+        eForecastDate,
+        eForecastWeatherCode,
+        eForecastHighTemperature,
+        eForecastLowTemperature
+      };
+
+      struct WeatherCode {
+        uint8_t code;
+        Weather::Icon icon;
+        const char* title;
+      };
+
+      static const Json::Projection::Field kFields[];
+      static const size_t kNumberOfFields;
+      static const WeatherCode kWeatherCodes[];
+      static const size_t kNumberOfWeatherCodes;
+
+      String latitude;
+      String longitude;
+      String name;
+
+      // The icon depends on both, which may come in either order.
+      int weatherCode = -1;
+      bool isDay = true;
+
+      void updateIcon();
+
+      static const WeatherCode* FindWeatherCode(const int code);
+      static const char* WeekdayFromDate(const char* date);
+  };
+}
+
+#endif // OPENMETEO_CLIENT_H_
@@ -15,6 +15,10 @@ namespace Mqtt {
     this->reconnects = 0;
   }
 
+  void Publisher::setResolver(Dns::Resolver* resolver) {
+    this->resolver = resolver;
+  }
+
   bool Publisher::publish(const String& topic, const String& payload, std::function<void(bool)> callback) {
     bool success = false;
 
@@ -72,6 +76,11 @@ namespace Mqtt {
       return;
     }
 
+    // Wait for the broker's address, the publish timeout still applies.
+    if(this->isResolving) {
+      return;
+    }
+
     if (!this->mqttClient.connected() && now - this->lastReconnect > kConnectTimeout) {
       this->lastReconnect = now;
 
@@ -86,6 +95,23 @@ namespace Mqtt {
   }
 
   bool Publisher::reconnect() {
+    // Connect by address when the resolver has it, otherwise look it up and
+    // try again once it's there.
+    if(this->resolver != NULL) {
+      IPAddress address;
+
+      if(!this->resolver->get(this->settings.broker.c_str(), address)) {
+        this->resolve();
+        return false;
+      }
+
+      // TLS needs the broker's name for SNI and to verify the certificate,
+      // keep connecting by name. The lookup behind it is cached by now.
+      if(!this->isSecure) {
+        this->mqttClient.setServer(address, this->settings.port);
+      }
+    }
+
     Serial.println("(re)connecting..");
     if (this->mqttClient.connect(this->settings.broker.c_str(), this->settings.username.c_str(), this->settings.password.c_str())) {
       ESP_LOGI(LogTag, "connecting to MQTT broker.");
@@ -94,6 +120,14 @@ namespace Mqtt {
     return this->mqttClient.connected();
   }
 
+  void Publisher::resolve() {
+    this->isResolving = true;
+
+    this->resolver->resolve(this->settings.broker.c_str(), [this](bool success, const IPAddress& address) {
+      this->isResolving = false;
+    });
+  }
+
   void Publisher::fireCallback(bool success) {
     if(this->context.callback) {
       this->context.callback(success);
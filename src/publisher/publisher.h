@@ -5,6 +5,8 @@
 #include <Arduino.h>
 #include <PubSubClient.h>
 #include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+#include "dns/resolver.h"
 
 namespace Mqtt {
   class Publisher {
@@ -27,18 +29,25 @@ namespace Mqtt {
       } context;
 
       PubSubClient mqttClient;
+      Dns::Resolver* resolver = NULL;
+      bool isResolving = false;
+      // Connects by name over TLS, see reconnect().
+      bool isSecure = false;
       bool isPublishing;
       unsigned long lastReconnect;
       uint8_t reconnects;
       unsigned long publishTimer;
 
       bool reconnect();
+      void resolve();
       void fireCallback(bool success);
     public:
       Publisher(const WiFiClient& client) : mqttClient((WiFiClient&)client) {};
+      Publisher(const WiFiClientSecure& client) : mqttClient((WiFiClientSecure&)client), isSecure(true) {};
       ~Publisher() {};
 
       void setup(const String& broker, const uint16_t port, const String& username, const String& password);
+      void setResolver(Dns::Resolver* resolver);
       bool publish(const String& topic, const String& payload, std::function<void(bool)> callback);
       void loop();
   };
@@ -0,0 +1,238 @@
+#include "weather_cache.h"
+#include <string.h>
+#include <math.h>
+#include <esp_log.h>
+
+static const char LogTag[] PROGMEM = "WeatherCache";
+
+static const char kNamespace[] PROGMEM = "weather";
+static const char kRecordKey[] PROGMEM = "conditions";
+
+namespace {
+  enum {
+    eHasObservation = 1 << 0,
+    eHasForecasts = 1 << 1
+  };
+
+  // Bounds checked little endian writer, ok turns false once the buffer
+  // is full.
+  struct Writer {
+    uint8_t* buffer;
+    size_t size;
+    size_t offset;
+    bool ok;
+
+    void put(const uint8_t value) {
+      if(this->offset >= this->size) {
+        this->ok = false;
+        return;
+      }
+
+      this->buffer[this->offset++] = value;
+    }
+
+    void put16(const int16_t value) {
+      this->put(value & 0xff);
+      this->put((value >> 8) & 0xff);
+    }
+
+    void put32(const uint32_t value) {
+      this->put16(value & 0xffff);
+      this->put16(value >> 16);
+    }
+
+    void putTemperature(const float temperature) {
+      this->put16((int16_t)lroundf(temperature * 10.0f));
+    }
+
+    void putString(const char* value, const size_t maxLength) {
+      const size_t length = strnlen(value, maxLength - 1);
+
+      this->put(length);
+      for(size_t i = 0; i < length; i++) {
+        this->put(value[i]);
+      }
+    }
+  };
+
+  struct Reader {
+    const uint8_t* buffer;
+    size_t size;
+    size_t offset;
+    bool ok;
+
+    uint8_t get() {
+      if(this->offset >= this->size) {
+        this->ok = false;
+        return 0;
+      }
+
+      return this->buffer[this->offset++];
+    }
+
+    int16_t get16() {
+      const uint8_t low = this->get();
+      return (int16_t)(low | (this->get() << 8));
+    }
+
+    uint32_t get32() {
+      const uint16_t low = this->get16();
+      return low | ((uint32_t)(uint16_t)this->get16() << 16);
+    }
+
+    float getTemperature() {
+      return this->get16() / 10.0f;
+    }
+
+    // value has room for maxLength bytes including the terminator.
+    void getString(char* value, const size_t maxLength) {
+      const size_t length = this->get();
+
+      if(length >= maxLength) {
+        this->ok = false;
+      }
+
+      for(size_t i = 0; i < length && this->ok; i++) {
+        value[i] = this->get();
+      }
+
+      value[this->ok ? length : 0] = '\0';
+    }
+  };
+}
+
+namespace Storage {
+  bool WeatherCache::load(Weather::Conditions& conditions, unsigned long& fetchTime) {
+    uint8_t buffer[kMaxRecordSize];
+
+    Preferences preferences;
+    if(!preferences.begin(kNamespace, true)) {
+      return false;
+    }
+
+    const size_t size = preferences.getBytes(kRecordKey, buffer, sizeof(buffer));
+    preferences.end();
+
+    if(size == 0) {
+      ESP_LOGI(LogTag, "no conditions stored.");
+      return false;
+    }
+
+    if(!Deserialize(buffer, size, conditions, fetchTime)) {
+      ESP_LOGE(LogTag, "invalid record (%d bytes).", size);
+      return false;
+    }
+
+    ESP_LOGI(LogTag, "restored conditions from %lu.", fetchTime);
+
+    return true;
+  }
+
+  bool WeatherCache::save(const Weather::Conditions& conditions, const unsigned long fetchTime) {
+    if(this->didSave && millis() - this->saveTime < kMinSaveInterval) {
+      return false;
+    }
+
+    uint8_t buffer[kMaxRecordSize];
+
+    const size_t size = Serialize(conditions, fetchTime, buffer, sizeof(buffer));
+    if(size == 0) {
+      return false;
+    }
+
+    Preferences preferences;
+    if(!preferences.begin(kNamespace, false)) {
+      ESP_LOGE(LogTag, "could not open preferences.");
+      return false;
+    }
+
+    const bool success = preferences.putBytes(kRecordKey, buffer, size) == size;
+    preferences.end();
+
+    if(success) {
+      this->didSave = true;
+      this->saveTime = millis();
+    }
+
+    ESP_LOGI(LogTag, "saved conditions (%d bytes, %d).", size, success);
+
+    return success;
+  }
+
+  //
+  // - private
+  //
+  size_t WeatherCache::Serialize(const Weather::Conditions& conditions, const unsigned long fetchTime, uint8_t* buffer, const size_t size) {
+    Writer writer = { buffer, size, 0, true };
+
+    writer.put(kVersion);
+    writer.put((conditions.isValid() ? eHasObservation : 0) | (conditions.hasForecasts() ? eHasForecasts : 0));
+    writer.put32(fetchTime);
+
+    const Weather::Conditions::Observation& observation = conditions.getCurrentObservation();
+    writer.putTemperature(observation.temperature);
+    writer.put(observation.icon);
+    writer.putString(observation.city, Weather::Conditions::kMaxCityLength);
+    writer.putString(observation.title, Weather::Conditions::kMaxTitleLength);
+
+    for(size_t i = 0; i < Weather::Conditions::kMaxForecasts; i++) {
+      const Weather::Conditions::Forecast& forecast = conditions.getForecastForPeriod(i);
+      writer.putString(forecast.title, Weather::Conditions::kMaxDayLength);
+      writer.put(forecast.icon);
+      writer.putTemperature(forecast.lowTemperature);
+      writer.putTemperature(forecast.highTemperature);
+    }
+
+    return writer.ok ? writer.offset : 0;
+  }
+
+  bool WeatherCache::Deserialize(const uint8_t* buffer, const size_t size, Weather::Conditions& conditions, unsigned long& fetchTime) {
+    Reader reader = { buffer, size, 0, true };
+
+    if(reader.get() != kVersion) {
+      return false;
+    }
+
+    const uint8_t flags = reader.get();
+    const unsigned long time = reader.get32();
+
+    // Decoded into a copy, conditions is left alone on a bad record.
+    Weather::Conditions restored;
+    char text[Weather::Conditions::kMaxTitleLength];
+
+    const float temperature = reader.getTemperature();
+    const uint8_t icon = reader.get();
+    if(flags & eHasObservation) {
+      restored.setTemperature(temperature);
+      restored.setIcon(icon < Weather::eNumberOfIcons ? static_cast<Weather::Icon>(icon) : Weather::eUnknownIcon);
+    }
+
+    reader.getString(text, Weather::Conditions::kMaxCityLength);
+    restored.setCity(text);
+    reader.getString(text, Weather::Conditions::kMaxTitleLength);
+    restored.setTitle(text);
+
+    for(size_t i = 0; i < Weather::Conditions::kMaxForecasts; i++) {
+      reader.getString(text, Weather::Conditions::kMaxDayLength);
+      const uint8_t forecastIcon = reader.get();
+      const float low = reader.getTemperature();
+      const float high = reader.getTemperature();
+
+      if(flags & eHasForecasts) {
+        restored.setForecastTitle(i, text);
+        restored.setForecastIcon(i, forecastIcon < Weather::eNumberOfIcons ? static_cast<Weather::Icon>(forecastIcon) : Weather::eUnknownIcon);
+        restored.setForecastLowTemperature(i, low);
+        restored.setForecastHighTemperature(i, high);
+      }
+    }
+
+    if(!reader.ok || !restored.isValid()) {
+      return false;
+    }
+
+    conditions = restored;
+    fetchTime = time;
+
+    return true;
+  }
+}
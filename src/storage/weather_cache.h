@@ -0,0 +1,36 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include "weather/conditions.h"
+
+#ifndef STORAGE_WEATHER_CACHE_H_
+#define STORAGE_WEATHER_CACHE_H_
+
+namespace Storage {
+  // Keeps the last good conditions in flash (NVS) so they can be shown
+  // right after a reboot, tagged with the time they were fetched. Records
+  // are packed by hand, temperatures in tenths of a degree and strings
+  // without their unused buffer space.
+  class WeatherCache {
+    public:
+      static const uint32_t kMinSaveInterval = 30 * 60 * 1000;
+
+      // Returns false when there's no (usable) record.
+      bool load(Weather::Conditions& conditions, unsigned long& fetchTime);
+
+      // Writes at most once per kMinSaveInterval to spare the flash, returns
+      // true when the record was written.
+      bool save(const Weather::Conditions& conditions, const unsigned long fetchTime);
+
+    private:
+      static const uint8_t kVersion = 1;
+      static const size_t kMaxRecordSize = 160;
+
+      bool didSave = false;
+      unsigned long saveTime = 0;
+
+      static size_t Serialize(const Weather::Conditions& conditions, const unsigned long fetchTime, uint8_t* buffer, const size_t size);
+      static bool Deserialize(const uint8_t* buffer, const size_t size, Weather::Conditions& conditions, unsigned long& fetchTime);
+  };
+}
+
+#endif // STORAGE_WEATHER_CACHE_H_
@@ -0,0 +1,58 @@
+#include "allocation_counter.h"
+#include <stdlib.h>
+
+#ifdef COUNT_ALLOCATIONS
+static volatile TaskHandle_t CountedTask = NULL;
+static volatile uint32_t Count = 0;
+
+static inline void CountAllocation() {
+  if(CountedTask != NULL && xTaskGetCurrentTaskHandle() == CountedTask) {
+    Count++;
+  }
+}
+
+// Linked with -Wl,--wrap=malloc etc., operator new ends up here as well.
+extern "C" {
+  void* __real_malloc(size_t size);
+  void* __real_calloc(size_t count, size_t size);
+  void* __real_realloc(void* ptr, size_t size);
+
+  void* __wrap_malloc(size_t size) {
+    CountAllocation();
+    return __real_malloc(size);
+  }
+
+  void* __wrap_calloc(size_t count, size_t size) {
+    CountAllocation();
+    return __real_calloc(count, size);
+  }
+
+  void* __wrap_realloc(void* ptr, size_t size) {
+    CountAllocation();
+    return __real_realloc(ptr, size);
+  }
+}
+
+bool AllocationCounter::IsEnabled() {
+  return true;
+}
+
+void AllocationCounter::SetTask(TaskHandle_t task) {
+  CountedTask = task;
+}
+
+uint32_t AllocationCounter::GetCount() {
+  return Count;
+}
+#else
+bool AllocationCounter::IsEnabled() {
+  return false;
+}
+
+void AllocationCounter::SetTask(TaskHandle_t) {
+}
+
+uint32_t AllocationCounter::GetCount() {
+  return 0;
+}
+#endif // COUNT_ALLOCATIONS
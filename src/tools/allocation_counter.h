@@ -0,0 +1,20 @@
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#ifndef ALLOCATION_COUNTER_H_
+#define ALLOCATION_COUNTER_H_
+
+// Counts malloc/calloc/realloc calls made by a single task. Only active
+// when built with -DCOUNT_ALLOCATIONS and the allocator wrapped, see
+// platformio.ini.
+class AllocationCounter {
+  public:
+    static bool IsEnabled();
+
+    // Task to count, NULL stops counting.
+    static void SetTask(TaskHandle_t task);
+    static uint32_t GetCount();
+};
+
+#endif // ALLOCATION_COUNTER_H_
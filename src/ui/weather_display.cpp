@@ -2,14 +2,16 @@
 #include "fonts/lato.h"
 #include "fonts/meteocons.h"
 #include "weather_station_images.h"
+#include "tools/allocation_counter.h"
 #include <vector>
 #include <esp_log.h>
+#include <math.h>
 
 static const char LogTag[] PROGMEM = "WeatherDisplay";
 
 WeatherDisplay::WeatherDisplay(OLEDDisplay& display
   , Ntp::Client& ntpClient
-  , wunderground::Conditions& conditions
+  , Weather::Conditions& conditions
   , Sensors::Environment::Measurement& environmentMeasurement
   , Sensors::AirQuality::Measurement& airQualityMeasurement)
   : display(display)
@@ -70,16 +72,37 @@ void WeatherDisplay::setWifiQuality(const int8_t quality) {
     wifiQuality = quality;
 }
 
+void WeatherDisplay::setConditionsTime(const unsigned long unixTime) {
+  this->conditionsTime = unixTime;
+}
+
 int WeatherDisplay::update() {
   if(this->framesEnabled & Frames::eBootScreen) {
     this->drawBootScreen();
   } else {
-    return this->ui.update();
+    const uint32_t allocations = AllocationCounter::GetCount();
+
+    const int remainingTimeBudget = this->ui.update();
+
+    this->frameAllocations = AllocationCounter::GetCount() - allocations;
+    if(this->frameAllocations > this->maxFrameAllocations) {
+      this->maxFrameAllocations = this->frameAllocations;
+    }
+
+    return remainingTimeBudget;
   }
 
   return 800;
 }
 
+uint32_t WeatherDisplay::getFrameAllocations() const {
+  return this->frameAllocations;
+}
+
+uint32_t WeatherDisplay::getMaxFrameAllocations() const {
+  return this->maxFrameAllocations;
+}
+
 bool WeatherDisplay::isInTransition() {
   OLEDDisplayUiState* uiState = this->ui.getUiState();
 
@@ -150,13 +173,13 @@ void WeatherDisplay::DrawHeaderOverlay(OLEDDisplay        *display,
     display->setColor(WHITE);
     display->setFont(ArialMT_Plain_10);
     display->setTextAlignment(TEXT_ALIGN_LEFT);
-    display->drawString(0, 54,
-                        String(state->currentFrame + 1) + F("/") +
-                        String(self->numberOfFrames));
 
-    String time;
-    if(self->ntpClient.getFormattedTime(time)) {
-      time = time.substring(0, 5);
+    char text[24];
+    snprintf(text, sizeof(text), "%d/%d", state->currentFrame + 1, self->numberOfFrames);
+    display->drawString(0, 54, text);
+
+    const char* time = self->ntpClient.getFormattedShortTime();
+    if(time != NULL) {
       display->setTextAlignment(TEXT_ALIGN_LEFT);
       display->drawString(21, 54, time);
     }
@@ -171,22 +194,21 @@ void WeatherDisplay::DrawHeaderOverlay(OLEDDisplay        *display,
 
     display->setTextAlignment(TEXT_ALIGN_LEFT);
 
-    wunderground::Conditions::Observation observation;
-    self->conditions.getCurrentObservation(observation);
+    const Weather::Conditions::Observation& observation = self->conditions.getCurrentObservation();
 
-    String indoorTemperature = F("-");
-    String outdoorTemperature = F("-");
+    char indoorTemperature[12] = "-";
+    char outdoorTemperature[12] = "-";
 
     if(self->environmentMeasurement.temperature > 0) {
-      indoorTemperature = String(self->environmentMeasurement.temperature, 1);
+      FormatDecimal(indoorTemperature, sizeof(indoorTemperature), self->environmentMeasurement.temperature, 1);
     }
 
     if(observation.temperature > 0) {
-      outdoorTemperature = String(observation.temperature, 1);
+      FormatDecimal(outdoorTemperature, sizeof(outdoorTemperature), observation.temperature, 1);
     }
 
-    String temp = indoorTemperature + F(" | ") + outdoorTemperature + F("°C");
-    display->drawString(53, 54, temp);
+    snprintf(text, sizeof(text), "%s | %s°C", indoorTemperature, outdoorTemperature);
+    display->drawString(53, 54, text);
 
     display->drawHorizontalLine(0, 52, 128);
   }
@@ -206,18 +228,16 @@ void WeatherDisplay::DrawDateTime(OLEDDisplay        *display,
     display->setTextAlignment(TEXT_ALIGN_CENTER);
     display->setFont(ArialMT_Plain_10);
 
-    String date;
-    self->ntpClient.getFormattedDate(date);
+    const char* date = self->ntpClient.getFormattedDate();
     // int textWidth = display->getStringWidth(date);
 
-    display->drawString(64 + x, 5 + y, date);
+    display->drawString(64 + x, 5 + y, date != NULL ? date : "");
     display->setFont(ArialMT_Plain_24);
 
-    String time;
-    self->ntpClient.getFormattedTime(time);
+    const char* time = self->ntpClient.getFormattedTime();
     // int textWidth = display->getStringWidth(time);
 
-    display->drawString(64 + x, 15 + y, time);
+    display->drawString(64 + x, 15 + y, time != NULL ? time : "");
     display->setTextAlignment(TEXT_ALIGN_LEFT);
 
     display->setTextAlignment(TEXT_ALIGN_CENTER);
@@ -226,7 +246,9 @@ void WeatherDisplay::DrawDateTime(OLEDDisplay        *display,
     uint16_t eco2 = self->airQualityMeasurement.eCo2;
     uint16_t tvoc = self->airQualityMeasurement.tVoc;
     if(eco2 > 0) {
-      display->drawString(64 + x, 38 + y, String(eco2) + F("ppm | ") + String(tvoc) + F("ppb"));
+      char airQuality[24];
+      snprintf(airQuality, sizeof(airQuality), "%uppm | %uppb", eco2, tvoc);
+      display->drawString(64 + x, 38 + y, airQuality);
     }
   }
 }
@@ -242,26 +264,35 @@ void WeatherDisplay::DrawCurrentWeather(OLEDDisplay        *display,
   const WeatherDisplay *self = static_cast<WeatherDisplay *>(state->userData);
 
   if (self != NULL) {
-
-    wunderground::Conditions::Observation observation;
-    self->conditions.getCurrentObservation(observation);
+    const Weather::Conditions::Observation& observation = self->conditions.getCurrentObservation();
 
     display->setTextAlignment(TEXT_ALIGN_LEFT);
     display->setFont(Lato_Regular_9);
-    display->drawString(46 + x, 38 + y, observation.city);
+
+    // Conditions restored after a reboot or kept through an outage.
+    unsigned long unixTime = 0;
+    if(self->conditionsTime > 0 && self->ntpClient.getUnixTime(unixTime)
+      && unixTime > self->conditionsTime + kStaleConditionsAge) {
+      char age[16];
+      snprintf(age, sizeof(age), "%luh old", (unixTime - self->conditionsTime) / 3600);
+      display->drawString(46 + x, 38 + y, age);
+    } else {
+      display->drawString(46 + x, 38 + y, observation.city);
+    }
 
     display->setFont(ArialMT_Plain_10);
     display->drawString(52 + x, 5 + y, observation.title);
 
     display->setFont(ArialMT_Plain_24);
-    String temp = String(observation.temperature, 1) + F("°C");
+    char temp[16];
+    FormatDecimal(temp, sizeof(temp) - 3, observation.temperature, 1);
+    strcat(temp, "°C");
 
     display->drawString(52 + x, 15 + y, temp);
     // int tempWidth = display->getStringWidth(temp);
 
     display->setFont(Meteocons_Plain_42);
-    String weatherIcon;
-    ConvertIconTextToMeteoconIcon(observation.icon, weatherIcon);
+    const char* weatherIcon = MeteoconGlyph(observation.icon);
 
     int weatherIconWidth = display->getStringWidth(weatherIcon);
     display->drawString(24 + x - weatherIconWidth / 2, 05 + y, weatherIcon);
@@ -287,14 +318,22 @@ void WeatherDisplay::DrawIndoorTemperature(OLEDDisplay        *display,
     display->setTextAlignment(TEXT_ALIGN_LEFT);
     display->setFont(ArialMT_Plain_16);
 
+    char text[20];
+
     float temperature = self->environmentMeasurement.temperature;
     float humidity    = self->environmentMeasurement.humidity;
-    display->drawString(4 + x, 12 + y, String(temperature) + F("°C"));
-    display->drawString(4 + x, 30 + y, String(humidity) + F("%H"));
+    FormatDecimal(text, sizeof(text) - 3, temperature, 2);
+    strcat(text, "°C");
+    display->drawString(4 + x, 12 + y, text);
+    FormatDecimal(text, sizeof(text) - 2, humidity, 2);
+    strcat(text, "%H");
+    display->drawString(4 + x, 30 + y, text);
 
     display->setFont(ArialMT_Plain_10);
     float pressure = self->environmentMeasurement.pressure;
-    display->drawString(70 + x, 14 + y, String(pressure) + F("hPa"));
+    FormatDecimal(text, sizeof(text) - 3, pressure, 2);
+    strcat(text, "hPa");
+    display->drawString(70 + x, 14 + y, text);
 
     uint16_t eco2 = self->airQualityMeasurement.eCo2;
     uint16_t tvoc = self->airQualityMeasurement.tVoc;
@@ -302,9 +341,11 @@ void WeatherDisplay::DrawIndoorTemperature(OLEDDisplay        *display,
     // Check if values make sense, let's assume we're not measuring in a
     // clean room, so anything > 0 is ok.
     if(eco2 > 0) {
-      display->drawString(78 + x, 26 + y, String(eco2) + F("ppm"));
+      snprintf(text, sizeof(text), "%uppm", eco2);
+      display->drawString(78 + x, 26 + y, text);
 
-      display->drawString(78 + x, 36 + y, String(tvoc) + F("ppb"));
+      snprintf(text, sizeof(text), "%uppb", tvoc);
+      display->drawString(78 + x, 36 + y, text);
     }
   }
 }
@@ -334,105 +375,81 @@ void WeatherDisplay::DrawForecastDetails(const WeatherDisplay *self,
   display->setTextAlignment(TEXT_ALIGN_CENTER);
   display->setFont(ArialMT_Plain_10);
 
-  wunderground::Conditions::Forecast forecast;
-  self->conditions.getForecastForPeriod(dayIndex, forecast);
+  const Weather::Conditions::Forecast& forecast = self->conditions.getForecastForPeriod(dayIndex);
 
-  String day = forecast.title.substring(0, 3);
-  day.toUpperCase();
+  // First three letters of the week day, upper case.
+  char day[4] = { 0 };
+  for(size_t i = 0; i < sizeof(day) - 1 && forecast.title[i] != '\0'; i++) {
+    day[i] = toupper(forecast.title[i]);
+  }
   display->drawString(x + 20, y, day);
 
-  String forecastIcon;
-  ConvertIconTextToMeteoconIcon(forecast.icon, forecastIcon);
+  const char* forecastIcon = MeteoconGlyph(forecast.icon);
 
   display->setFont(Meteocons_Plain_21);
   display->drawString(x + 20, y + 12, forecastIcon);
 
   display->setFont(ArialMT_Plain_10);
-  display->drawString(x + 20, y + 34, String((int)round(
-                      forecast.lowTemperature)) + "|" +
-                      String((int)round(forecast.highTemperature)));
+  char temperatures[16];
+  snprintf(temperatures, sizeof(temperatures), "%ld|%ld",
+           lroundf(forecast.lowTemperature), lroundf(forecast.highTemperature));
+  display->drawString(x + 20, y + 34, temperatures);
   display->setTextAlignment(TEXT_ALIGN_LEFT);
 }
 
-void WeatherDisplay::ConvertIconTextToMeteoconIcon(const String& iconText,
-                                                   String      & icon) {
-    if (iconText == F("chanceflurries")) {
-        icon = F("F");
-    } else if (iconText == F("chancerain")) {
-        icon = F("Q");
-    } else if (iconText == F("chancesleet")) {
-        icon = F("W");
-    } else if (iconText == F("chancesnow")) {
-        icon = F("V");
-    } else if (iconText == F("chancetstorms")) {
-        icon = F("S");
-    } else if (iconText == F("clear")) {
-        icon = F("B");
-    } else if (iconText == F("cloudy")) {
-        icon = F("Y");
-    } else if (iconText == F("flurries")) {
-        icon = F("F");
-    } else if (iconText == F("fog")) {
-        icon = F("M");
-    } else if (iconText == F("hazy")) {
-        icon = F("E");
-    } else if (iconText == F("mostlycloudy")) {
-        icon = F("Y");
-    } else if (iconText == F("mostlysunny")) {
-        icon = F("H");
-    } else if (iconText == F("partlycloudy")) {
-        icon = F("H");
-    } else if (iconText == F("partlysunny")) {
-        icon = F("J");
-    } else if (iconText == F("sleet")) {
-        icon = F("W");
-    } else if (iconText == F("rain")) {
-        icon = F("R");
-    } else if (iconText == F("snow")) {
-        icon = F("W");
-    } else if (iconText == F("sunny")) {
-        icon = F("B");
-    } else if (iconText == F("tstorms")) {
-        icon = F("0");
-    } else if (iconText == F("nt_chanceflurries")) {
-        icon = F("F");
-    } else if (iconText == F("nt_chancerain")) {
-        icon = F("7");
-    } else if (iconText == F("nt_chancesleet")) {
-        icon = F("#");
-    } else if (iconText == F("nt_chancesnow")) {
-        icon = F("#");
-    } else if (iconText == F("nt_chancetstorms")) {
-        icon = F("&");
-    } else if (iconText == F("nt_clear")) {
-        icon = F("2");
-    } else if (iconText == F("nt_cloudy")) {
-        icon = F("Y");
-    } else if (iconText == F("nt_flurries")) {
-        icon = F("9");
-    } else if (iconText == F("nt_fog")) {
-        icon = F("M");
-    } else if (iconText == F("nt_hazy")) {
-        icon = F("E");
-    } else if (iconText == F("nt_mostlycloudy")) {
-        icon = F("5");
-    } else if (iconText == F("nt_mostlysunny")) {
-        icon = F("3");
-    } else if (iconText == F("nt_partlycloudy")) {
-        icon = F("4");
-    } else if (iconText == F("nt_partlysunny")) {
-        icon = F("4");
-    } else if (iconText == F("nt_sleet")) {
-        icon = F("9");
-    } else if (iconText == F("nt_rain")) {
-        icon = F("7");
-    } else if (iconText == F("nt_snow"))  {
-        icon = F("#");
-    } else if (iconText == F("nt_sunny")) {
-        icon = F("4");
-    } else if (iconText == F("nt_tstorms")) {
-        icon = F("&");
-    } else {
-        icon = F(")");
-    }
+void WeatherDisplay::FormatDecimal(char* buffer, const size_t size, const float value, const uint8_t decimals) {
+  // Fixed point through integer printf, float formatting may allocate.
+  const long scale = decimals >= 2 ? 100 : 10;
+  const long scaled = lroundf(value * scale);
+  const unsigned long magnitude = scaled < 0 ? -scaled : scaled;
+
+  snprintf(buffer, size, decimals >= 2 ? "%s%lu.%02lu" : "%s%lu.%lu",
+           scaled < 0 ? "-" : "", magnitude / scale, magnitude % scale);
+}
+
+const char* WeatherDisplay::MeteoconGlyph(const Weather::Icon icon) {
+  // Meteocons glyph per icon, in the order of Weather::Icon.
+  static constexpr const char* kGlyphs[Weather::eNumberOfIcons] = {
+    ")", // eUnknownIcon
+    "F", // eChanceFlurries
+    "Q", // eChanceRain
+    "W", // eChanceSleet
+    "V", // eChanceSnow
+    "S", // eChanceTstorms
+    "B", // eClear
+    "Y", // eCloudy
+    "F", // eFlurries
+    "M", // eFog
+    "E", // eHazy
+    "Y", // eMostlyCloudy
+    "H", // eMostlySunny
+    "H", // ePartlyCloudy
+    "J", // ePartlySunny
+    "W", // eSleet
+    "R", // eRain
+    "W", // eSnow
+    "B", // eSunny
+    "0", // eTstorms
+    "F", // eNightChanceFlurries
+    "7", // eNightChanceRain
+    "#", // eNightChanceSleet
+    "#", // eNightChanceSnow
+    "&", // eNightChanceTstorms
+    "2", // eNightClear
+    "Y", // eNightCloudy
+    "9", // eNightFlurries
+    "M", // eNightFog
+    "E", // eNightHazy
+    "5", // eNightMostlyCloudy
+    "3", // eNightMostlySunny
+    "4", // eNightPartlyCloudy
+    "4", // eNightPartlySunny
+    "9", // eNightSleet
+    "7", // eNightRain
+    "#", // eNightSnow
+    "4", // eNightSunny
+    "&",  // eNightTstorms
+  };
+
+  return icon < Weather::eNumberOfIcons ? kGlyphs[icon] : kGlyphs[Weather::eUnknownIcon];
 }
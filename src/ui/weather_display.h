@@ -1,7 +1,7 @@
 #include <OLEDDisplayUi.h>
 #include <SSD1306Wire.h>
 #include "ntp/ntp_client.h"
-#include "wunderground/Conditions.h"
+#include "weather/conditions.h"
 #include "sensors/environment.h"
 #include "sensors/air_quality.h"
 
@@ -23,35 +23,48 @@ class WeatherDisplay {
   public:
     WeatherDisplay(OLEDDisplay& display
       , Ntp::Client& ntpClient
-      , wunderground::Conditions& conditions
+      , Weather::Conditions& conditions
       , Sensors::Environment::Measurement& environmentMeasurement
       , Sensors::AirQuality::Measurement& airQualityMeasurement);
 
     void setup();
     int update();
 
+    // Heap allocations made by the last and the worst frame, stays 0 unless
+    // AllocationCounter is enabled.
+    uint32_t getFrameAllocations() const;
+    uint32_t getMaxFrameAllocations() const;
+
     void addFrame(const Frames::Flags frame);
     void removeFrame(const Frames::Flags frame);
 
     void setWifiQuality(const int8_t quality);
+
+    // Unix time the conditions were fetched at, older conditions are shown
+    // with their age instead of the city.
+    void setConditionsTime(const unsigned long unixTime);
     bool isInTransition();
   private:
     Frames::Flags framesEnabled = Frames::eBootScreen;
 
     static const size_t kMaxFrameSize = 5;
+    static const unsigned long kStaleConditionsAge = 60 * 60; // in seconds
     FrameCallback frames[kMaxFrameSize];
 
     OLEDDisplay& display;
     OLEDDisplayUi ui;
     Ntp::Client& ntpClient;
-    wunderground::Conditions& conditions;
+    Weather::Conditions& conditions;
     Sensors::Environment::Measurement& environmentMeasurement;
     Sensors::AirQuality::Measurement& airQualityMeasurement;
 
     int numberOfFrames;
     int8_t wifiQuality;
+    unsigned long conditionsTime = 0;
     int progress;
     int progressDirection;
+    uint32_t frameAllocations = 0;
+    uint32_t maxFrameAllocations = 0;
 
     void updateFrames();
     void drawBootScreen();
@@ -79,8 +92,8 @@ class WeatherDisplay {
                              int16_t y);
     static void DrawHeaderOverlay(OLEDDisplay *display,
                                   OLEDDisplayUiState *state);
-    static void ConvertIconTextToMeteoconIcon(const String& iconText,
-                                              String& icon);
+    static void FormatDecimal(char* buffer, const size_t size, const float value, const uint8_t decimals);
+    static const char* MeteoconGlyph(const Weather::Icon icon);
 };
 
 #endif // _UI_WEATHER_DISPLAY_H_
@@ -0,0 +1,114 @@
+#include "conditions.h"
+
+namespace Weather {
+  Conditions::Conditions() {
+    this->reset();
+  }
+
+  void Conditions::reset() {
+    memset(&this->observation, 0, sizeof(this->observation));
+    memset(this->forecasts, 0, sizeof(this->forecasts));
+
+    this->hasTemperature = false;
+    this->hasForecast = false;
+  }
+
+  void Conditions::setCity(const char* city) {
+    Copy(this->observation.city, sizeof(this->observation.city), city);
+  }
+
+  void Conditions::setTitle(const char* title) {
+    Copy(this->observation.title, sizeof(this->observation.title), title);
+  }
+
+  void Conditions::setTemperature(const float temperature) {
+    this->observation.temperature = temperature;
+    this->hasTemperature = true;
+  }
+
+  void Conditions::setIcon(const Icon icon) {
+    this->observation.icon = icon;
+  }
+
+  void Conditions::setForecastTitle(const size_t period, const char* title) {
+    if(period < kMaxForecasts) {
+      this->hasForecast = true;
+      Copy(this->forecasts[period].title, sizeof(this->forecasts[period].title), title);
+    }
+  }
+
+  void Conditions::setForecastIcon(const size_t period, const Icon icon) {
+    if(period < kMaxForecasts) {
+      this->hasForecast = true;
+      this->forecasts[period].icon = icon;
+    }
+  }
+
+  void Conditions::setForecastLowTemperature(const size_t period, const float temperature) {
+    if(period < kMaxForecasts) {
+      this->hasForecast = true;
+      this->forecasts[period].lowTemperature = temperature;
+    }
+  }
+
+  void Conditions::setForecastHighTemperature(const size_t period, const float temperature) {
+    if(period < kMaxForecasts) {
+      this->hasForecast = true;
+      this->forecasts[period].highTemperature = temperature;
+    }
+  }
+
+  void Conditions::copyObservation(const Conditions& other) {
+    this->observation = other.observation;
+    this->hasTemperature = other.hasTemperature;
+  }
+
+  void Conditions::copyForecasts(const Conditions& other) {
+    memcpy(this->forecasts, other.forecasts, sizeof(this->forecasts));
+    this->hasForecast = other.hasForecast;
+  }
+
+  bool Conditions::isValid() const {
+    return this->hasTemperature;
+  }
+
+  bool Conditions::hasForecasts() const {
+    return this->hasForecast;
+  }
+
+  const Conditions::Observation& Conditions::getCurrentObservation() const {
+    return this->observation;
+  }
+
+  const Conditions::Forecast& Conditions::getForecastForPeriod(const int period) const {
+    static const Forecast kEmptyForecast = { "", eUnknownIcon, 0, 0 };
+
+    if(period < 0 || (size_t)period >= kMaxForecasts) {
+      return kEmptyForecast;
+    }
+
+    return this->forecasts[period];
+  }
+
+  void Conditions::printConditions() {
+
+  }
+
+  //
+  // - private
+  //
+  void Conditions::Copy(char* buffer, const size_t size, const char* value) {
+    size_t length = strlen(value);
+
+    // Don't cut a multi-byte UTF-8 character in half.
+    if(length >= size) {
+      length = size - 1;
+      while(length > 0 && (value[length] & 0xC0) == 0x80) {
+        length--;
+      }
+    }
+
+    memcpy(buffer, value, length);
+    buffer[length] = '\0';
+  }
+}
@@ -0,0 +1,70 @@
+#include <Arduino.h>
+#include "icon.h"
+
+#ifndef WEATHER_CONDITIONS_H_
+#define WEATHER_CONDITIONS_H_
+
+namespace Weather {
+  class Conditions {
+    public:
+      static const size_t kMaxTitleLength = 32;
+      static const size_t kMaxCityLength = 32;
+      static const size_t kMaxDayLength = 12;
+      static const size_t kMaxForecasts = 4;
+
+      // Plain data with inline buffers, copying doesn't touch the heap.
+      // Strings longer than the buffers are cut off.
+      struct Forecast {
+        char title[kMaxDayLength];
+        Icon icon;
+        float lowTemperature;
+        float highTemperature;
+      };
+
+      struct Observation {
+        float temperature;
+        char city[kMaxCityLength];
+        Icon icon;
+        char title[kMaxTitleLength];
+      };
+
+      Conditions();
+
+      void reset();
+
+      // Filled in by the providers while parsing, forecasts for periods out
+      // of range are ignored.
+      void setCity(const char* city);
+      void setTitle(const char* title);
+      void setTemperature(const float temperature);
+      void setIcon(const Icon icon);
+      void setForecastTitle(const size_t period, const char* title);
+      void setForecastIcon(const size_t period, const Icon icon);
+      void setForecastLowTemperature(const size_t period, const float temperature);
+      void setForecastHighTemperature(const size_t period, const float temperature);
+
+      // Take over the observation or the forecasts of other.
+      void copyObservation(const Conditions& other);
+      void copyForecasts(const Conditions& other);
+
+      // Whether there's at least a current temperature.
+      bool isValid() const;
+      // Whether any forecast period was set.
+      bool hasForecasts() const;
+
+      const Observation& getCurrentObservation() const;
+      // Returns an empty forecast for a period out of range.
+      const Forecast& getForecastForPeriod(const int period) const;
+      void printConditions();
+
+    private:
+      Observation observation;
+      Forecast forecasts[kMaxForecasts];
+      bool hasTemperature;
+      bool hasForecast;
+
+      static void Copy(char* buffer, const size_t size, const char* value);
+  };
+}
+
+#endif // WEATHER_CONDITIONS_H_
@@ -0,0 +1,110 @@
+#include "icon.h"
+#include <string.h>
+
+namespace Weather {
+  // Icon names are mapped with a perfect hash: FNV-1a with a seed picked so
+  // that the top 6 bits of the hash differ for every name. The slot table is
+  // generated by the compiler from the names, a lookup is one hash, one
+  // table index and one compare.
+  static constexpr uint32_t kHashSeed = 726977;
+  static constexpr uint32_t kHashPrime = 16777619;
+  static constexpr size_t kSlotBits = 6;
+  static constexpr size_t kNumberOfSlots = 1 << kSlotBits;
+
+  // Names in the order of the Icon enum.
+  static constexpr const char* kIconNames[eNumberOfIcons] = {
+    "",
+    "chanceflurries",
+    "chancerain",
+    "chancesleet",
+    "chancesnow",
+    "chancetstorms",
+    "clear",
+    "cloudy",
+    "flurries",
+    "fog",
+    "hazy",
+    "mostlycloudy",
+    "mostlysunny",
+    "partlycloudy",
+    "partlysunny",
+    "sleet",
+    "rain",
+    "snow",
+    "sunny",
+    "tstorms",
+    "nt_chanceflurries",
+    "nt_chancerain",
+    "nt_chancesleet",
+    "nt_chancesnow",
+    "nt_chancetstorms",
+    "nt_clear",
+    "nt_cloudy",
+    "nt_flurries",
+    "nt_fog",
+    "nt_hazy",
+    "nt_mostlycloudy",
+    "nt_mostlysunny",
+    "nt_partlycloudy",
+    "nt_partlysunny",
+    "nt_sleet",
+    "nt_rain",
+    "nt_snow",
+    "nt_sunny",
+    "nt_tstorms"
+  };
+
+  static constexpr uint32_t Hash(const char* name, const uint32_t hash = kHashSeed) {
+    return *name == '\0' ? hash : Hash(name + 1, (hash ^ (uint8_t)*name) * kHashPrime);
+  }
+
+  static constexpr size_t Slot(const uint32_t hash) {
+    return hash >> (32 - kSlotBits);
+  }
+
+  static constexpr bool Collides(const size_t i, const size_t j) {
+    return j < eNumberOfIcons
+      && (Slot(Hash(kIconNames[i])) == Slot(Hash(kIconNames[j])) || Collides(i, j + 1));
+  }
+
+  static constexpr bool IsPerfect(const size_t i = 1) {
+    return i >= eNumberOfIcons || (!Collides(i, i + 1) && IsPerfect(i + 1));
+  }
+
+  static_assert(IsPerfect(), "icon names share a slot, pick another kHashSeed.");
+
+  static constexpr Icon IconAtSlot(const size_t slot, const size_t i = 1) {
+    return i >= eNumberOfIcons
+      ? eUnknownIcon
+      : (Slot(Hash(kIconNames[i])) == slot ? static_cast<Icon>(i) : IconAtSlot(slot, i + 1));
+  }
+
+  #define ICON_SLOTS_4(n) IconAtSlot(n), IconAtSlot(n + 1), IconAtSlot(n + 2), IconAtSlot(n + 3)
+  #define ICON_SLOTS_16(n) ICON_SLOTS_4(n), ICON_SLOTS_4(n + 4), ICON_SLOTS_4(n + 8), ICON_SLOTS_4(n + 12)
+
+  static_assert(kNumberOfSlots == 64, "slot table initializer expects 64 slots.");
+
+  static constexpr Icon kIconSlots[kNumberOfSlots] = {
+    ICON_SLOTS_16(0), ICON_SLOTS_16(16), ICON_SLOTS_16(32), ICON_SLOTS_16(48)
+  };
+
+  #undef ICON_SLOTS_16
+  #undef ICON_SLOTS_4
+
+  Icon IconFromName(const char* name, const size_t len) {
+    uint32_t hash = kHashSeed;
+    for(size_t i = 0; i < len; i++) {
+      hash = (hash ^ (uint8_t)name[i]) * kHashPrime;
+    }
+
+    // Any string lands in some slot, make sure it's really this icon.
+    const Icon icon = kIconSlots[Slot(hash)];
+    const char* iconName = kIconNames[icon];
+
+    if(icon == eUnknownIcon || strlen(iconName) != len || strncmp(iconName, name, len) != 0) {
+      return eUnknownIcon;
+    }
+
+    return icon;
+  }
+}
@@ -0,0 +1,57 @@
+#include <Arduino.h>
+
+#ifndef WEATHER_ICON_H_
+#define WEATHER_ICON_H_
+
+namespace Weather {
+  // Weather icons, named after the Weather Underground icon set. Night
+  // variants (nt_ prefix) included.
+  enum Icon : uint8_t {
+    eUnknownIcon = 0,
+    eChanceFlurries,
+    eChanceRain,
+    eChanceSleet,
+    eChanceSnow,
+    eChanceTstorms,
+    eClear,
+    eCloudy,
+    eFlurries,
+    eFog,
+    eHazy,
+    eMostlyCloudy,
+    eMostlySunny,
+    ePartlyCloudy,
+    ePartlySunny,
+    eSleet,
+    eRain,
+    eSnow,
+    eSunny,
+    eTstorms,
+    eNightChanceFlurries,
+    eNightChanceRain,
+    eNightChanceSleet,
+    eNightChanceSnow,
+    eNightChanceTstorms,
+    eNightClear,
+    eNightCloudy,
+    eNightFlurries,
+    eNightFog,
+    eNightHazy,
+    eNightMostlyCloudy,
+    eNightMostlySunny,
+    eNightPartlyCloudy,
+    eNightPartlySunny,
+    eNightSleet,
+    eNightRain,
+    eNightSnow,
+    eNightSunny,
+    eNightTstorms,
+    eNumberOfIcons
+  };
+
+  // Maps a Weather Underground icon name (not necessarily NUL terminated)
+  // to its Icon, eUnknownIcon if there's no such icon.
+  Icon IconFromName(const char* name, const size_t len);
+}
+
+#endif // WEATHER_ICON_H_
@@ -0,0 +1,71 @@
+#include <Arduino.h>
+#include <functional>
+#include "dns/resolver.h"
+#include "http/connection_pool.h"
+#include "http/secure_transport.h"
+#include "conditions.h"
+
+#ifndef WEATHER_PROVIDER_H_
+#define WEATHER_PROVIDER_H_
+
+namespace Weather {
+  // Current conditions and the forecast are fetched on their own schedule.
+  enum Feed {
+    eObservation = 0,
+    eForecast,
+    eNumberOfFeeds
+  };
+
+  // Bit (1 << feed) is set for every feed an update fetched successfully,
+  // a 304 Not Modified included.
+  typedef uint8_t FetchedFeeds;
+
+  struct FeedStatistics {
+    uint32_t fetches;
+    uint32_t notModified;
+    uint32_t failures;
+    // Received from the server, and handed to the parser after inflating.
+    uint32_t bytes;
+    uint32_t decodedBytes;
+    // From sending the request to the end of the response, in milliseconds.
+    uint32_t lastFetchTime;
+    uint32_t maxFetchTime;
+    uint32_t totalFetchTime;
+    // Spent in the JSON parser and projection, in microseconds.
+    uint32_t parseTime;
+    // Lowest free heap seen while a body was parsed, 0 before the first one.
+    uint32_t minFreeHeap;
+  };
+
+  // A source of current conditions and forecast.
+  class Provider {
+    public:
+      typedef std::function<void(bool, FetchedFeeds, Conditions&)> Callback;
+
+      virtual ~Provider() {}
+
+      virtual void setResolver(Dns::Resolver* resolver) = 0;
+
+      // Keep the connection to the server open between requests.
+      virtual void setConnectionPool(Http::ConnectionPool* pool) = 0;
+
+      // How long the data of a feed is used before it's fetched again.
+      virtual void setTtl(const Feed feed, const uint32_t ttl /* in milliseconds */) = 0;
+
+      // Seeds the last good conditions, e.g. restored from flash. They're
+      // handed out until the feeds were fetched again.
+      virtual void setConditions(const Conditions& conditions) = 0;
+
+      // Fetches the feeds that went stale, on failure the callback gets the
+      // last good conditions (if any). Nothing is fetched while no feed is
+      // due, success then only says the conditions are valid.
+      virtual void update(const Callback callback) = 0;
+
+      virtual const FeedStatistics& getStatistics(const Feed feed) const = 0;
+
+      // Handshakes with the server, when it's reached over https.
+      virtual const Http::TlsSessionCache::Statistics& getTlsStatistics() const = 0;
+  };
+}
+
+#endif // WEATHER_PROVIDER_H_
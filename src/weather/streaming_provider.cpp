@@ -0,0 +1,227 @@
+#include "streaming_provider.h"
+#include <string.h>
+#include <esp_log.h>
+#include <esp_system.h>
+
+static const char LogTag[] PROGMEM = "WeatherProvider";
+
+namespace Weather {
+  StreamingProvider::StreamingProvider(const Json::Projection::Field* fields, const size_t numberOfFields) : projection(fields, numberOfFields) {
+    this->http.setConditionalRequests(true);
+    // No compression, the bodies are a few KB and inflating one takes a 43 KB
+    // block of heap (see test/test_http_inflate).
+    this->http.setCompression(false);
+
+    this->parser.setListener(&this->projection);
+
+    this->projection.onValue([this](const uint8_t field, const size_t index, const char* value) {
+      this->onValue(field, index, value);
+    });
+
+    memset(this->feeds, 0, sizeof(this->feeds));
+    this->feeds[eObservation].ttl = kDefaultObservationTtl;
+    this->feeds[eForecast].ttl = kDefaultForecastTtl;
+  }
+
+  StreamingProvider::~StreamingProvider() {}
+
+  void StreamingProvider::setResolver(Dns::Resolver* resolver) {
+    this->http.setResolver(resolver);
+  }
+
+  void StreamingProvider::setConnectionPool(Http::ConnectionPool* pool) {
+    this->http.setConnectionPool(pool);
+  }
+
+  void StreamingProvider::setTtl(const Feed feed, const uint32_t ttl) {
+    if(feed < eNumberOfFeeds) {
+      this->feeds[feed].ttl = ttl;
+    }
+  }
+
+  void StreamingProvider::setConditions(const Conditions& conditions) {
+    this->conditions = conditions;
+  }
+
+  const FeedStatistics& StreamingProvider::getStatistics(const Feed feed) const {
+    return this->feeds[feed < eNumberOfFeeds ? feed : eObservation].statistics;
+  }
+
+  const Http::TlsSessionCache::Statistics& StreamingProvider::getTlsStatistics() const {
+    return this->http.getTlsStatistics();
+  }
+
+  void StreamingProvider::update(const Callback callback) {
+    // The feeds share the parser, an update that's still running covers
+    // this one.
+    if(this->isUpdating) {
+      ESP_LOGW(LogTag, "update in progress.");
+      callback(this->conditions.isValid(), 0, this->conditions);
+      return;
+    }
+
+    this->isUpdating = true;
+    this->updateFrom(eObservation, false, 0, callback);
+  }
+
+  //
+  // - private
+  //
+  bool StreamingProvider::isDue(const Feed feed, const unsigned long now) const {
+    const FeedState& state = this->feeds[feed];
+
+    if(state.failures > 0) {
+      return (long)(now - state.retryTime) >= 0;
+    }
+
+    return !state.hasData || now - state.fetchTime >= state.ttl;
+  }
+
+  void StreamingProvider::updateFrom(const int first, const bool failed, const FetchedFeeds fetched, const Callback callback) {
+    const unsigned long now = millis();
+
+    // Feeds are fetched one after the other, the next one starts from the
+    // callback of the previous.
+    for(int i = first; i < eNumberOfFeeds; i++) {
+      const Feed feed = static_cast<Feed>(i);
+
+      if(this->isDue(feed, now)) {
+        this->fetch(feed, [this, i, failed, fetched, callback](bool success) {
+          this->updateFrom(i + 1, failed || !success, success ? fetched | (1 << i) : fetched, callback);
+        });
+        return;
+      }
+    }
+
+    this->isUpdating = false;
+
+    callback(!failed && this->conditions.isValid(), fetched, this->conditions);
+  }
+
+  void StreamingProvider::fetch(const Feed feed, const std::function<void(bool)> callback) {
+    const String uri = this->getUri(feed);
+
+    this->pendingConditions.reset();
+    this->parser.reset();
+    this->projection.startDocument();
+    this->beginParse(feed);
+
+    // Only the provider's fields are picked out while the body streams
+    // through the parser.
+    auto onBody = [this, feed](const char* data, size_t len) {
+      FeedStatistics& statistics = this->feeds[feed].statistics;
+      const unsigned long start = micros();
+
+      for(size_t i = 0; i < len; i++) {
+        this->parser.parse(data[i]);
+      }
+
+      statistics.parseTime += micros() - start;
+      statistics.decodedBytes += len;
+
+      const uint32_t freeHeap = ESP.getFreeHeap();
+      if(statistics.minFreeHeap == 0 || freeHeap < statistics.minFreeHeap) {
+        statistics.minFreeHeap = freeHeap;
+      }
+    };
+
+    this->feeds[feed].statistics.fetches++;
+
+    const unsigned long start = millis();
+
+    this->http.get(uri, onBody, [this, feed, uri, start, callback](bool success, const Http::Response& response) {
+      ESP_LOGI(LogTag, "get callback feed %d (%d).", feed, response.statusCode);
+
+      FeedState& state = this->feeds[feed];
+
+      const uint32_t fetchTime = millis() - start;
+      state.statistics.bytes += response.receivedBytes;
+      state.statistics.lastFetchTime = fetchTime;
+      state.statistics.totalFetchTime += fetchTime;
+      if(fetchTime > state.statistics.maxFetchTime) {
+        state.statistics.maxFetchTime = fetchTime;
+      }
+
+      // Nothing changed upstream since the last fetch, keep the data we
+      // already have.
+      if(success && response.statusCode == 304 && state.hasData) {
+        ESP_LOGI(LogTag, "feed %d not modified.", feed);
+
+        state.statistics.notModified++;
+        this->onFetched(feed, true);
+        callback(true);
+        return;
+      }
+
+      if(!success || response.statusCode != 200) {
+        ESP_LOGE(LogTag, "request failed (%d).", response.statusCode);
+
+        // A 304 is of no use without earlier data.
+        if(response.statusCode == 304) {
+          this->http.forgetValidators(uri);
+        }
+
+        this->onFetched(feed, false);
+        callback(false);
+        return;
+      }
+
+      if(this->projection.isComplete() && this->isValid(feed)) {
+        if(feed == eObservation) {
+          this->conditions.copyObservation(this->pendingConditions);
+        } else {
+          this->conditions.copyForecasts(this->pendingConditions);
+        }
+      } else {
+        ESP_LOGE(LogTag, "invalid JSON response.");
+        success = false;
+
+        // Make sure the next request gets a full response again.
+        this->http.forgetValidators(uri);
+      }
+
+      this->onFetched(feed, success);
+      callback(success);
+    });
+  }
+
+  void StreamingProvider::onFetched(const Feed feed, const bool success) {
+    FeedState& state = this->feeds[feed];
+    const unsigned long now = millis();
+
+    if(success) {
+      state.hasData = true;
+      state.fetchTime = now;
+      state.failures = 0;
+      return;
+    }
+
+    state.statistics.failures++;
+
+    // Double the delay with every failure in a row.
+    if(state.failures < 31) {
+      state.failures++;
+    }
+
+    uint32_t delay = kMaxRetryDelay;
+    if(state.failures <= 16 && (kMinRetryDelay << (state.failures - 1)) < kMaxRetryDelay) {
+      delay = kMinRetryDelay << (state.failures - 1);
+    }
+
+    // Spread the retries over the second half of the delay, so a shared
+    // outage doesn't end with everyone retrying at the same moment.
+    delay = delay / 2 + esp_random() % (delay / 2 + 1);
+
+    state.retryTime = now + delay;
+
+    ESP_LOGW(LogTag, "feed %d failed %d time(s), retry in %u ms.", feed, state.failures, delay);
+  }
+
+  bool StreamingProvider::isValid(const Feed feed) const {
+    if(feed == eObservation) {
+      return this->pendingConditions.isValid();
+    }
+
+    return this->pendingConditions.hasForecasts();
+  }
+}
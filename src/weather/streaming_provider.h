@@ -0,0 +1,75 @@
+#include <Arduino.h>
+#include <JsonListener.h>
+#include <JsonStreamingParser.h>
+#include "http/http_client.h"
+#include "json/projection.h"
+#include "provider.h"
+
+#ifndef WEATHER_STREAMING_PROVIDER_H_
+#define WEATHER_STREAMING_PROVIDER_H_
+
+namespace Weather {
+  // Base for providers with a JSON API. The response streams through a
+  // Json::Projection with the provider's fields, the document is never kept
+  // in memory. Handles conditional requests (304) and keeps the last good
+  // conditions. Observation and forecast are separate requests, each fetched
+  // once its TTL expired and retried with a jittered exponential backoff
+  // after a failure.
+  class StreamingProvider : public Provider {
+    public:
+      static const uint32_t kDefaultObservationTtl = 5 * 60 * 1000;
+      static const uint32_t kDefaultForecastTtl = 3 * 60 * 60 * 1000;
+
+      StreamingProvider(const Json::Projection::Field* fields, const size_t numberOfFields);
+      virtual ~StreamingProvider();
+
+      void setResolver(Dns::Resolver* resolver) override;
+      void setConnectionPool(Http::ConnectionPool* pool) override;
+      void setTtl(const Feed feed, const uint32_t ttl) override;
+      void setConditions(const Conditions& conditions) override;
+      void update(const Callback callback) override;
+      const FeedStatistics& getStatistics(const Feed feed) const override;
+      const Http::TlsSessionCache::Statistics& getTlsStatistics() const override;
+
+    protected:
+      Http::Client http;
+      // Filled while the response streams in, only the part of the feed is
+      // copied to conditions once it parsed completely.
+      Conditions pendingConditions;
+
+      virtual String getUri(const Feed feed) const = 0;
+
+      // Called before a new response is parsed.
+      virtual void beginParse(const Feed) {}
+
+      // Called for every value on one of the provider's fields.
+      virtual void onValue(const uint8_t field, const size_t index, const char* value) = 0;
+
+    private:
+      static const uint32_t kMinRetryDelay = 60 * 1000;
+      static const uint32_t kMaxRetryDelay = 30 * 60 * 1000;
+
+      struct FeedState {
+        uint32_t ttl;
+        bool hasData;
+        unsigned long fetchTime;
+        uint8_t failures;
+        unsigned long retryTime;
+        FeedStatistics statistics;
+      };
+
+      JsonStreamingParser parser;
+      Json::Projection projection;
+      Conditions conditions;
+      FeedState feeds[eNumberOfFeeds];
+      bool isUpdating = false;
+
+      bool isDue(const Feed feed, const unsigned long now) const;
+      void updateFrom(const int first, const bool failed, const FetchedFeeds fetched, const Callback callback);
+      void fetch(const Feed feed, const std::function<void(bool)> callback);
+      void onFetched(const Feed feed, const bool success);
+      bool isValid(const Feed feed) const;
+  };
+}
+
+#endif // WEATHER_STREAMING_PROVIDER_H_
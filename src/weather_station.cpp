@@ -1,6 +1,9 @@
 #include "weather_station.h"
 #include "tools/timer.h"
+#include "tools/allocation_counter.h"
 #include "config.h"
+#include "wunderground/client.h"
+#include "openmeteo/client.h"
 #include <esp_log.h>
 
 volatile SemaphoreHandle_t WeatherStation::SuperShortIntervalTimerSemaphore = xSemaphoreCreateBinary();
@@ -20,11 +23,23 @@ WeatherStation::WeatherStation(WiFiManager& wifiManager)
     , wifiManager(wifiManager)
     , display(WSConfig::kSpiResetPin, WSConfig::kSpiDcPin, WSConfig::kSpiCsPin, spi)
     , weatherDisplay(display, ntpClient, conditions, environmentMeasurement, airQualityMeasurement)
-    , wunderground(WSConfig::kWundergroundApiKey, WSConfig::kWundergroundLanguage, WSConfig::kWundergroundLocation)
     , environmentSensor(w0)
-    , airQualitySensor(w0) {}
+    , airQualitySensor(w0) {
+  // Only the configured provider is created, each has its own HTTP client.
+  if(WSConfig::kWeatherProvider == WSConfig::kWeatherProviderOpenMeteo) {
+    this->weatherProvider = new openmeteo::Client(WSConfig::kOpenMeteoLatitude,
+                                                  WSConfig::kOpenMeteoLongitude,
+                                                  WSConfig::kOpenMeteoLocationName);
+  } else {
+    this->weatherProvider = new wunderground::Client(WSConfig::kWundergroundApiKey,
+                                                     WSConfig::kWundergroundLanguage,
+                                                     WSConfig::kWundergroundLocation);
+  }
+}
 
-WeatherStation::~WeatherStation() {}
+WeatherStation::~WeatherStation() {
+  delete this->weatherProvider;
+}
 
 void WeatherStation::setup() {
   this->w0.begin(WSConfig::kI2cSdaPin, WSConfig::kI2cSclPin, 400000);
@@ -33,6 +48,7 @@ void WeatherStation::setup() {
     WSConfig::kMqttBrokerPort,
     WSConfig::kMqttBrokerUsername,
     WSConfig::kMqttBrokerPassword);
+  this->mqttPublisher.setResolver(&this->resolver);
 
   this->environmentSensor.setup();
   this->airQualitySensor.setup();
@@ -41,10 +57,26 @@ void WeatherStation::setup() {
 
   this->weatherDisplay.setup();
 
-  this->ntpClient.setup(WSConfig::kNtpServerName);
+  this->ntpClient.setup(WSConfig::kNtpServerNames, sizeof(WSConfig::kNtpServerNames) / sizeof(WSConfig::kNtpServerNames[0]));
+  this->ntpClient.setResolver(&this->resolver);
+  this->ntpClient.setTimeZone(WSConfig::kDaylightSavingTime, WSConfig::kStandardTime);
+
+  this->weatherProvider->setResolver(&this->resolver);
+  // Observation and forecast come from the same server, one after the other.
+  this->weatherProvider->setConnectionPool(&this->connectionPool);
+  this->weatherProvider->setTtl(Weather::eObservation, WSConfig::kWeatherObservationTtl);
+  this->weatherProvider->setTtl(Weather::eForecast, WSConfig::kWeatherForecastTtl);
 
   this->store.loadConfig();
 
+  // Show the last good conditions until the first update, the display marks
+  // them with their age once the time is known.
+  if(this->weatherCache.load(this->conditions, this->conditionsTime)) {
+    this->weatherProvider->setConditions(this->conditions);
+    this->weatherDisplay.setConditionsTime(this->conditionsTime);
+    this->weatherDisplay.addFrame(Frames::eWeatherReport);
+  }
+
   Sensors::AirQuality::Measurement aqBaselineMeasurement = { 0, 0 };
   this->store.get(kTVOCKey, aqBaselineMeasurement.tVoc);
   this->store.get(kECO2Key, aqBaselineMeasurement.eCo2);
@@ -108,19 +140,66 @@ void WeatherStation::loop() {
 
     ESP_LOGI(LogTag, "free heap: %d bytes.", ESP.getFreeHeap());
 
+    if(AllocationCounter::IsEnabled()) {
+      ESP_LOGI(LogTag, "display: %u allocations in last frame, %u max.",
+        this->weatherDisplay.getFrameAllocations(), this->weatherDisplay.getMaxFrameAllocations());
+    }
+
     this->tasks |= WeatherStationTasks::ePushTemperature;
+
+    // The provider only fetches the feeds that are stale or due for a retry.
+    this->tasks |= WeatherStationTasks::eUpdateWeatherReport;
+
+    // The NTP client stretches its poll interval once the clock is stable.
+    if(this->ntpClient.isUpdateDue()) {
+      this->tasks |= WeatherStationTasks::eUpdateDateAndTime;
+    }
   }
 
   if (xSemaphoreTake(WeatherStation::MediumIntervalTimerSemaphore, 0) == pdTRUE) {
     // ESP_LOGI(LogTag, "timer fired, running on core %d,", xPortGetCoreID());
 
-    this->tasks |= WeatherStationTasks::eUpdateWeatherReport;
+    const Weather::FeedStatistics& observation = this->weatherProvider->getStatistics(Weather::eObservation);
+    const Weather::FeedStatistics& forecast = this->weatherProvider->getStatistics(Weather::eForecast);
+
+    ESP_LOGI(LogTag, "observation: %u fetches, %u not modified, %u failures, %u bytes (%u decoded).",
+      observation.fetches, observation.notModified, observation.failures, observation.bytes, observation.decodedBytes);
+    ESP_LOGI(LogTag, "observation: fetch %u/%u ms (last/max), parse %u us, min free heap %u bytes.",
+      observation.lastFetchTime, observation.maxFetchTime, observation.parseTime, observation.minFreeHeap);
+    ESP_LOGI(LogTag, "forecast: %u fetches, %u not modified, %u failures, %u bytes (%u decoded).",
+      forecast.fetches, forecast.notModified, forecast.failures, forecast.bytes, forecast.decodedBytes);
+    ESP_LOGI(LogTag, "forecast: fetch %u/%u ms (last/max), parse %u us, min free heap %u bytes.",
+      forecast.lastFetchTime, forecast.maxFetchTime, forecast.parseTime, forecast.minFreeHeap);
+
+    const Http::ConnectionPool::Statistics& pool = this->connectionPool.getStatistics();
+
+    ESP_LOGI(LogTag, "http: %u connections reused, %u opened, %u evicted.",
+      pool.hits, pool.misses, pool.evictions);
+
+    const Dns::Resolver::Statistics& dns = this->resolver.getStatistics();
+
+    if(dns.lookups > 0) {
+      ESP_LOGI(LogTag, "dns: %u hits, %u misses, %u negative hits, %u failures, %u prefetches, %u/%u ms (last/average).",
+        dns.hits, dns.misses, dns.negativeHits, dns.failures, dns.prefetches, dns.lastLookupTime, dns.totalLookupTime / dns.lookups);
+    }
+
+    const Http::TlsSessionCache::Statistics& tls = this->weatherProvider->getTlsStatistics();
+
+    if(tls.handshakes > 0) {
+      ESP_LOGI(LogTag, "tls: %u handshakes, %u%% resumed, %u/%u ms (last/average).",
+        tls.handshakes, 100 * tls.resumptions / tls.handshakes, tls.lastHandshakeTime, tls.totalHandshakeTime / tls.handshakes);
+    }
   }
 
   if (xSemaphoreTake(WeatherStation::LongIntervalTimerSemaphore, 0) == pdTRUE) {
     ESP_LOGI(LogTag, "slow timer fired, running on core %d.", xPortGetCoreID());
 
-    this->tasks |= WeatherStationTasks::eUpdateDateAndTime;
+    const Ntp::Client::Statistics& ntp = this->ntpClient.getStatistics();
+
+    ESP_LOGI(LogTag, "ntp: offset %lld us, delay %lld us, jitter %u us, %.2f ppm, poll %u s, %u/%u servers.",
+      ntp.offset, ntp.delay, ntp.jitter, ntp.frequency, ntp.pollInterval, ntp.survivors, ntp.candidates);
+    ESP_LOGI(LogTag, "ntp: %u requests, %u replies, %u rejected, %u timeouts.",
+      ntp.requests, ntp.replies, ntp.rejected, ntp.timeouts);
   }
 
   if(this->tasks & WeatherStationTasks::eUpdateEnvironmentSensor) {
@@ -177,15 +256,13 @@ void WeatherStation::loop() {
 
     this->ntpClient.update([this](bool success) {
       if(success) {
-        String currentTime;
-        this->ntpClient.getFormattedTime(currentTime);
         Serial.print(F("info: station: current time: "));
-        Serial.println(currentTime);
+        Serial.println(this->ntpClient.getFormattedTime());
 
         this->weatherDisplay.addFrame(Frames::eTimeAndDate);
       } else {
+        // Retried once the client says it's due again.
         ESP_LOGE(LogTag, "could not update time and date.");
-        this->tasks |= WeatherStationTasks::eUpdateDateAndTime;
       }
     });
   }
@@ -195,20 +272,41 @@ void WeatherStation::loop() {
 
     ESP_LOGI(LogTag, "updating weather report...");
 
-    this->wunderground.update([this](bool success, wunderground::Conditions& conditions) {
+    this->weatherProvider->update([this](bool success, Weather::FetchedFeeds fetched, Weather::Conditions& conditions) {
       ESP_LOGI(LogTag, "updating weather report callback (%d).", success);
 
-      // Retry
-      if(success) {
+      // Failed feeds are retried by the provider with a backoff, keep
+      // showing what's still good.
+      if(conditions.isValid()) {
         this->conditions = conditions;
         this->weatherDisplay.addFrame(Frames::eWeatherReport);
-      } else {
-        ESP_LOGE(LogTag, "failed updating weather report, retry.");
-        this->tasks |= WeatherStationTasks::eUpdateWeatherReport;
+      }
+
+      // Only a fetched observation is new, in between (or during a backoff)
+      // the conditions keep aging.
+      unsigned long unixTime = 0;
+      if((fetched & (1 << Weather::eObservation)) && this->ntpClient.getUnixTime(unixTime)) {
+        this->conditionsTime = unixTime;
+        this->weatherDisplay.setConditionsTime(unixTime);
+      }
+
+      // Writing flash blocks, leave it to the loop.
+      if(fetched != 0 && this->conditionsTime > 0) {
+        this->tasks |= WeatherStationTasks::eSaveWeatherReport;
+      }
+
+      if(!success) {
+        ESP_LOGE(LogTag, "failed updating weather report.");
       }
     });
   }
 
+  if(this->tasks & WeatherStationTasks::eSaveWeatherReport) {
+    this->tasks &= ~WeatherStationTasks::eSaveWeatherReport;
+
+    this->weatherCache.save(this->conditions, this->conditionsTime);
+  }
+
   if(this->tasks & WeatherStationTasks::ePushTemperature
     && (this->environmentSensor.enabled() || this->airQualitySensor.enabled())) {
     this->tasks &= ~WeatherStationTasks::ePushTemperature;
@@ -281,6 +379,8 @@ void WeatherStation::StaticDisplayTask(void* parameter) {
     WeatherStation *self = reinterpret_cast<WeatherStation *>(parameter);
 
     if(self != NULL) {
+      AllocationCounter::SetTask(xTaskGetCurrentTaskHandle());
+
       for(;;) {
         micros();
         if(!self->displayTaskLoop()) {
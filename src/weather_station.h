@@ -7,14 +7,17 @@
 #include <SPI.h>
 #include <WiFiClientSecure.h>
 #include "ui/weather_display.h"
-#include "wunderground/client.h"
-#include "wunderground/conditions.h"
+#include "weather/provider.h"
+#include "weather/conditions.h"
 #include "ntp/ntp_client.h"
 #include "wireless/wifi_manager.h"
 #include "sensors/environment.h"
 #include "sensors/air_quality.h"
 #include "storage/persistent.h"
+#include "storage/weather_cache.h"
 #include "publisher/publisher.h"
+#include "dns/resolver.h"
+#include "http/connection_pool.h"
 
 namespace WeatherStationTasks {
   enum {
@@ -23,7 +26,8 @@ namespace WeatherStationTasks {
     eUpdateWeatherReport = 1 << 1,
     eUpdateEnvironmentSensor = 1 << 2,
     eUpdateAirQualitySensor = 1 << 3,
-    ePushTemperature = 1 << 4
+    ePushTemperature = 1 << 4,
+    eSaveWeatherReport = 1 << 5
   };
 
   typedef uint16_t Tasks;
@@ -37,6 +41,9 @@ class WeatherStation {
     WeatherStationTasks::Tasks tasks;
 
     Storage::Persistent store;
+    Storage::WeatherCache weatherCache;
+    Dns::Resolver resolver;
+    Http::ConnectionPool connectionPool;
 
     TwoWire w0;
     SPIClass spi;
@@ -44,12 +51,13 @@ class WeatherStation {
     WiFiManager& wifiManager;
     SSD1306Spi display;
     WeatherDisplay weatherDisplay;
-    wunderground::Client wunderground;
+    Weather::Provider* weatherProvider;
     Sensors::Environment environmentSensor;
     Sensors::AirQuality airQualitySensor;
 
     WiFiClientSecure wifiClient;
-    wunderground::Conditions conditions;
+    Weather::Conditions conditions;
+    unsigned long conditionsTime = 0;
     Ntp::Client ntpClient;
     Sensors::Environment::Measurement environmentMeasurement;
     Sensors::AirQuality::Measurement airQualityMeasurement;
@@ -1,58 +1,94 @@
 #include "client.h"
-#include <ArduinoJson.h>
-#include <WiFiClientSecure.h>
-#include <esp_log.h>
-
-static const char LogTag[] PROGMEM = "WeatherUnderground";
+#include <string.h>
+#include <stdlib.h>
 
 namespace wunderground {
+  const Json::Projection::Field Client::kFields[] = {
+    { "current_observation.display_location.city", eCity },
+    { "current_observation.temp_c", eTemperature },
+    { "current_observation.weather", eTitle },
+    { "current_observation.icon", eIcon },
+    { "current_observation.icon_url", eIconUrl },
+    { "forecast.simpleforecast.forecastday[*].date.weekday", eForecastTitle },
+    { "forecast.simpleforecast.forecastday[*].high.celsius", eForecastHighTemperature },
+    { "forecast.simpleforecast.forecastday[*].low.celsius", eForecastLowTemperature },
+    { "forecast.simpleforecast.forecastday[*].icon", eForecastIcon }
+  };
+
+  const size_t Client::kNumberOfFields = sizeof(Client::kFields) / sizeof(Client::kFields[0]);
+
   // Client::Client() {}
   Client::Client(const String& apiKey,
                  const String& language,
                  const String& country,
-                 const String& city) : apiKey(apiKey), language(language) {
+                 const String& city) : StreamingProvider(kFields, kNumberOfFields), apiKey(apiKey), language(language) {
     query = "/q/" + country + "/" + city;
   }
 
   Client::Client(const String& apiKey,
                  const String& language,
-                 const String& latLon) : apiKey(apiKey), language(language) {
+                 const String& latLon) : StreamingProvider(kFields, kNumberOfFields), apiKey(apiKey), language(language) {
     query = "/q/" + latLon;
   }
 
   Client::~Client() {}
 
-  void Client::update(const std::function<void(bool, Conditions&)> callback) {
-    String uri = String(kApiUri) + "/api/" + apiKey + "/conditions/forecast/lang:" + language + query + ".json";
-
-    http.get(uri, [this, callback](bool success, Http::Response response) {
-      ESP_LOGI(LogTag, "get callback.");
-
-      // auto it = response.headers.begin();
-      // while(it != response.headers.end()) {
-      //   Serial.print(it->first);
-      //   Serial.print("=");
-      //   Serial.println(it->second);
-      //   it++;
-      // }
+  //
+  // - protected
+  //
+  String Client::getUri(const Weather::Feed feed) const {
+    const char* feature = feed == Weather::eObservation ? "/conditions" : "/forecast";
 
-      DynamicJsonBuffer jsonBuffer(kDefaultJsonBufferSize);
-      JsonVariant variant = jsonBuffer.parse(response.body.c_str());
-
-      if (variant.is<JsonObject>()) {
-        ESP_LOGI(LogTag, "response is JSON object.");
+    return String(kApiUri) + "/api/" + apiKey + feature + "/lang:" + language + query + ".json";
+  }
 
-        JsonObject& root = variant;
+  void Client::beginParse(const Weather::Feed) {
+    this->hasIconFromUrl = false;
+  }
 
-        ESP_LOGI(LogTag, "response version: %s.", root["response"]["version"].as<String>().c_str());
+  void Client::onValue(const uint8_t field, const size_t index, const char* value) {
+    Weather::Conditions& conditions = this->pendingConditions;
 
-        this->conditions.parse(root);
-      } else {
-        ESP_LOGE(LogTag, "invalid JSON response.");
-        success = false;
+    switch(field) {
+      case eCity:
+        conditions.setCity(value);
+        break;
+      case eTemperature:
+        conditions.setTemperature(atof(value));
+        break;
+      case eTitle:
+        conditions.setTitle(value);
+        break;
+      case eIcon:
+        if(!this->hasIconFromUrl) {
+          conditions.setIcon(Weather::IconFromName(value, strlen(value)));
+        }
+        break;
+      case eIconUrl: {
+        // Only the url contains the prefix to either show the night (nt_),
+        // or regular day icon.
+        const char* name = strrchr(value, '/');
+        const char* extension = name != NULL ? strchr(name, '.') : NULL;
+        if(extension != NULL && extension - name > 1) {
+          conditions.setIcon(Weather::IconFromName(name + 1, extension - name - 1));
+          this->hasIconFromUrl = true;
+        }
+        break;
       }
-
-      callback(success, this->conditions);
-    });
+      case eForecastTitle:
+        conditions.setForecastTitle(index, value);
+        break;
+      case eForecastHighTemperature:
+        conditions.setForecastHighTemperature(index, atof(value));
+        break;
+      case eForecastLowTemperature:
+        conditions.setForecastLowTemperature(index, atof(value));
+        break;
+      case eForecastIcon:
+        conditions.setForecastIcon(index, Weather::IconFromName(value, strlen(value)));
+        break;
+      default:
+        break;
+    }
   }
 }
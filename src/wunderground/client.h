@@ -1,9 +1,5 @@
 #include <Arduino.h>
-#include <AsyncTCP.h>
-#include <JsonListener.h>
-#include <JsonStreamingParser.h>
-#include "http/http_client.h"
-#include "conditions.h"
+#include "weather/streaming_provider.h"
 
 #ifndef WUNDERGROUND_CLIENT_H_
 #define WUNDERGROUND_CLIENT_H_
@@ -11,23 +7,39 @@
 namespace wunderground {
   static const char kApiUri[] PROGMEM = "http://api.wunderground.com";
 
-  class Client {
+  class Client : public Weather::StreamingProvider {
     public:
       Client(const String& apiKey, const String& language, const String& latLon);
       Client(const String& apiKey, const String& language, const String& country, const String& city);
       ~Client();
 
-      void update(const std::function<void(bool,Conditions&)> callback);
+    protected:
+      String getUri(const Weather::Feed feed) const override;
+      void beginParse(const Weather::Feed feed) override;
+      void onValue(const uint8_t field, const size_t index, const char* value) override;
+
     private:
-      static const int kHTTPTimeout = 5000;
-      static const size_t kDefaultJsonBufferSize = 32768;//16384; //8192;
+      enum Field {
+        eCity,
+        eTemperature,
+        eTitle,
+        eIcon,
+        eIconUrl,
+        eForecastTitle,
+        eForecastHighTemperature,
+        eForecastLowTemperature,
+        eForecastIcon
+      };
+
+      // Paths of the fields picked from the conditions and forecast responses.
+      static const Json::Projection::Field kFields[];
+      static const size_t kNumberOfFields;
 
-      Http::Client http;
       String apiKey;
       String language;
 
       String query;
-      Conditions conditions;
+      bool hasIconFromUrl = false;
     };
 }
 
@@ -0,0 +1,167 @@
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+// Just enough of Arduino.h to build lib/Time, the parsers and the HTTP client
+// on the host, the tests provide millis().
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#define PROGMEM
+
+typedef bool boolean;
+
+unsigned long millis();
+
+// Only used to measure, runs on the host's clock.
+inline unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Stand-in for the Arduino String, which keeps its characters on the heap
+// the same way. An empty string doesn't allocate.
+class String {
+  public:
+    String(const char* value = "") : buffer(NULL), len(0) {
+      this->assign(value, strlen(value));
+    }
+
+    String(const String& other) : buffer(NULL), len(0) {
+      this->assign(other.c_str(), other.len);
+    }
+
+    ~String() {
+      delete[] this->buffer;
+    }
+
+    String& operator=(const String& other) {
+      if(this != &other) {
+        this->assign(other.c_str(), other.len);
+      }
+      return *this;
+    }
+
+    const char* c_str() const {
+      return this->buffer != NULL ? this->buffer : "";
+    }
+
+    unsigned int length() const {
+      return this->len;
+    }
+
+    char operator[](const unsigned int index) const {
+      return index < this->len ? this->buffer[index] : '\0';
+    }
+
+    // Capacity isn't kept apart from the length here.
+    bool reserve(const unsigned int) {
+      return true;
+    }
+
+    bool concat(const char* value) {
+      const unsigned int length = strlen(value);
+      char* buffer = new char[this->len + length + 1];
+
+      memcpy(buffer, this->c_str(), this->len);
+      memcpy(buffer + this->len, value, length + 1);
+
+      delete[] this->buffer;
+      this->buffer = buffer;
+      this->len += length;
+      return true;
+    }
+
+    String& operator+=(const String& other) {
+      this->concat(other.c_str());
+      return *this;
+    }
+
+    bool operator==(const char* other) const {
+      return strcmp(this->c_str(), other) == 0;
+    }
+
+    friend String operator+(const String& lhs, const String& rhs) {
+      String sum(lhs);
+      sum.concat(rhs.c_str());
+      return sum;
+    }
+
+    friend String operator+(const String& lhs, const char* rhs) {
+      String sum(lhs);
+      sum.concat(rhs);
+      return sum;
+    }
+
+  private:
+    char* buffer;
+    unsigned int len;
+
+    void assign(const char* value, const unsigned int length) {
+      delete[] this->buffer;
+      this->buffer = NULL;
+      this->len = length;
+
+      if(length > 0) {
+        this->buffer = new char[length + 1];
+        memcpy(this->buffer, value, length + 1);
+      }
+    }
+};
+
+// Stand-in for the IPAddress of the ESP32 core, an IPv4 address in network
+// byte order.
+class IPAddress {
+  public:
+    IPAddress(const uint32_t address = 0) : address(address) {}
+
+    IPAddress(const uint8_t a, const uint8_t b, const uint8_t c, const uint8_t d)
+      : address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+
+    operator uint32_t() const {
+      return this->address;
+    }
+
+    uint8_t operator[](const int index) const {
+      return (this->address >> (8 * index)) & 0xff;
+    }
+
+    bool fromString(const char* address) {
+      unsigned int a, b, c, d;
+      char end;
+
+      if(sscanf(address, "%u.%u.%u.%u%c", &a, &b, &c, &d, &end) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+        return false;
+      }
+
+      *this = IPAddress(a, b, c, d);
+      return true;
+    }
+
+    String toString() const {
+      char text[16];
+      snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+      return String(text);
+    }
+
+  private:
+    uint32_t address;
+};
+
+// The host has no heap limit, it reports what an idle station has free.
+class EspClass {
+  public:
+    uint32_t getFreeHeap() const {
+      return 160 * 1024;
+    }
+};
+
+static const EspClass ESP = EspClass();
+
+#endif // ARDUINO_H_
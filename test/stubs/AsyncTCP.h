@@ -0,0 +1,291 @@
+#ifndef ASYNCTCP_H_
+#define ASYNCTCP_H_
+
+// Stand-in for the AsyncClient of AsyncTCP, connected to an in-process peer
+// instead of lwIP. Events are queued like on the AsyncTCP task and run when
+// the test calls AsyncTcp::Run(), close() fires the disconnect handler right
+// away as the real client does. Handlers are called on a copy, they may
+// replace themselves.
+#include <Arduino.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <string>
+
+class AsyncClient;
+
+typedef std::function<void(void*, AsyncClient*)> AcConnectHandler;
+typedef std::function<void(void*, AsyncClient*, size_t len, uint32_t time)> AcAckHandler;
+typedef std::function<void(void*, AsyncClient*, int8_t error)> AcErrorHandler;
+typedef std::function<void(void*, AsyncClient*, void* data, size_t len)> AcDataHandler;
+typedef std::function<void(void*, AsyncClient*, uint32_t time)> AcTimeoutHandler;
+
+// The remote end of every connection.
+class AsyncTcpPeer {
+  public:
+    virtual ~AsyncTcpPeer() {}
+
+    // Return false to refuse the connection.
+    virtual bool accept(AsyncClient* client, const char* host, const uint16_t port) = 0;
+    virtual void receive(AsyncClient* client, const char* data, size_t len) = 0;
+    virtual void disconnected(AsyncClient*) {}
+};
+
+namespace AsyncTcp {
+  struct Statistics {
+    uint32_t connects;
+    uint32_t closes;
+  };
+
+  inline std::deque<std::function<void()> >& Events() {
+    static std::deque<std::function<void()> > events;
+    return events;
+  }
+
+  inline AsyncTcpPeer*& Peer() {
+    static AsyncTcpPeer* peer = NULL;
+    return peer;
+  }
+
+  // Size of the send window, what's sent is acknowledged on the next Run().
+  inline size_t& Window() {
+    static size_t window = 5744;
+    return window;
+  }
+
+  inline Statistics& GetStatistics() {
+    static Statistics statistics = { 0, 0 };
+    return statistics;
+  }
+
+  inline void Post(const std::function<void()>& event) {
+    Events().push_back(event);
+  }
+
+  // Runs the queued events, including the ones they queue.
+  inline size_t Run() {
+    size_t count = 0;
+
+    while(!Events().empty()) {
+      std::function<void()> event = Events().front();
+      Events().pop_front();
+      event();
+      count++;
+    }
+
+    return count;
+  }
+
+  inline void Reset() {
+    Events().clear();
+    Peer() = NULL;
+    Window() = 5744;
+    GetStatistics() = Statistics { 0, 0 };
+  }
+}
+
+class AsyncClient {
+  public:
+    AsyncClient() {}
+
+    ~AsyncClient() {
+      this->state = eClosed;
+    }
+
+    void onConnect(AcConnectHandler handler, void* arg = NULL) { this->connectHandler = handler; this->connectArg = arg; }
+    void onDisconnect(AcConnectHandler handler, void* arg = NULL) { this->disconnectHandler = handler; this->disconnectArg = arg; }
+    void onAck(AcAckHandler handler, void* arg = NULL) { this->ackHandler = handler; this->ackArg = arg; }
+    void onError(AcErrorHandler handler, void* arg = NULL) { this->errorHandler = handler; this->errorArg = arg; }
+    void onData(AcDataHandler handler, void* arg = NULL) { this->dataHandler = handler; this->dataArg = arg; }
+    void onTimeout(AcTimeoutHandler handler, void* arg = NULL) { this->timeoutHandler = handler; this->timeoutArg = arg; }
+    void onPoll(AcConnectHandler handler, void* arg = NULL) { this->pollHandler = handler; this->pollArg = arg; }
+
+    bool connect(const IPAddress& ip, const uint16_t port) {
+      return this->connect(ip.toString().c_str(), port);
+    }
+
+    bool connect(const char* host, const uint16_t port) {
+      if(this->state != eClosed || AsyncTcp::Peer() == NULL) {
+        return false;
+      }
+
+      this->state = eConnecting;
+      this->host = host;
+      this->port = port;
+      this->unacknowledged = 0;
+      this->generation++;
+
+      AsyncTcp::GetStatistics().connects++;
+
+      const unsigned int generation = this->generation;
+      AsyncTcp::Post([this, generation]() {
+        if(generation != this->generation || this->state != eConnecting) {
+          return;
+        }
+
+        if(!AsyncTcp::Peer()->accept(this, this->host.c_str(), this->port)) {
+          this->state = eClosed;
+          if(this->errorHandler) {
+            AcErrorHandler(this->errorHandler)(this->errorArg, this, -14 /* ERR_ABRT */);
+          }
+          if(this->disconnectHandler) {
+            AcConnectHandler(this->disconnectHandler)(this->disconnectArg, this);
+          }
+          return;
+        }
+
+        this->state = eConnected;
+        if(this->connectHandler) {
+          AcConnectHandler(this->connectHandler)(this->connectArg, this);
+        }
+      });
+
+      return true;
+    }
+
+    void close(const bool = false) {
+      if(this->state == eClosed) {
+        return;
+      }
+
+      this->state = eClosed;
+      this->generation++;
+
+      AsyncTcp::GetStatistics().closes++;
+
+      if(AsyncTcp::Peer() != NULL) {
+        AsyncTcp::Peer()->disconnected(this);
+      }
+
+      if(this->disconnectHandler) {
+        AcConnectHandler(this->disconnectHandler)(this->disconnectArg, this);
+      }
+    }
+
+    bool connected() const { return this->state == eConnected; }
+    bool connecting() const { return this->state == eConnecting; }
+    bool canSend() const { return this->state == eConnected && this->space() > 0; }
+
+    size_t space() const {
+      if(this->state != eConnected) {
+        return 0;
+      }
+
+      const size_t used = this->unacknowledged + this->pending.size();
+      return used < AsyncTcp::Window() ? AsyncTcp::Window() - used : 0;
+    }
+
+    size_t add(const char* data, size_t size, uint8_t = 0) {
+      size = std::min(size, this->space());
+      this->pending.append(data, size);
+      return size;
+    }
+
+    bool send() {
+      if(this->state != eConnected || this->pending.empty()) {
+        return false;
+      }
+
+      const std::string data = this->pending;
+      this->pending.clear();
+      this->unacknowledged += data.size();
+
+      const unsigned int generation = this->generation;
+      AsyncTcp::Post([this, generation, data]() {
+        if(generation != this->generation) {
+          return;
+        }
+
+        AsyncTcp::Peer()->receive(this, data.data(), data.size());
+
+        this->unacknowledged -= data.size();
+        if(this->ackHandler) {
+          AcAckHandler(this->ackHandler)(this->ackArg, this, data.size(), 1);
+        }
+      });
+
+      return true;
+    }
+
+    void setRxTimeout(const uint32_t) {}
+
+    IPAddress remoteIP() const { return IPAddress(127, 0, 0, 1); }
+    uint16_t remotePort() const { return this->port; }
+
+    //
+    // - peer side
+    //
+
+    // Queues data from the peer.
+    void deliver(const char* data, size_t len) {
+      const std::string copy(data, len);
+      const unsigned int generation = this->generation;
+
+      AsyncTcp::Post([this, generation, copy]() {
+        if(generation != this->generation || this->state != eConnected) {
+          return;
+        }
+
+        if(this->dataHandler) {
+          std::string segment = copy;
+          AcDataHandler(this->dataHandler)(this->dataArg, this, &segment[0], segment.size());
+        }
+      });
+    }
+
+    // Queues a close by the peer.
+    void hangUp() {
+      const unsigned int generation = this->generation;
+
+      AsyncTcp::Post([this, generation]() {
+        if(generation != this->generation || this->state == eClosed) {
+          return;
+        }
+
+        this->state = eClosed;
+        this->generation++;
+
+        if(this->disconnectHandler) {
+          AcConnectHandler(this->disconnectHandler)(this->disconnectArg, this);
+        }
+      });
+    }
+
+    // Fires the poll handler, AsyncTCP does every 500 ms while connected.
+    void poll() {
+      if(this->state == eConnected && this->pollHandler) {
+        AcConnectHandler(this->pollHandler)(this->pollArg, this);
+      }
+    }
+
+  private:
+    enum State {
+      eClosed,
+      eConnecting,
+      eConnected
+    };
+
+    State state = eClosed;
+    unsigned int generation = 0;
+    std::string host;
+    uint16_t port = 0;
+    std::string pending;
+    size_t unacknowledged = 0;
+
+    AcConnectHandler connectHandler;
+    AcConnectHandler disconnectHandler;
+    AcAckHandler ackHandler;
+    AcErrorHandler errorHandler;
+    AcDataHandler dataHandler;
+    AcTimeoutHandler timeoutHandler;
+    AcConnectHandler pollHandler;
+    void* connectArg = NULL;
+    void* disconnectArg = NULL;
+    void* ackArg = NULL;
+    void* errorArg = NULL;
+    void* dataArg = NULL;
+    void* timeoutArg = NULL;
+    void* pollArg = NULL;
+};
+
+#endif // ASYNCTCP_H_
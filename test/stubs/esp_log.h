@@ -0,0 +1,11 @@
+#ifndef ESP_LOG_H_
+#define ESP_LOG_H_
+
+// Logging is compiled out on the host.
+#define ESP_LOGE(tag, format, ...) do {} while(0)
+#define ESP_LOGW(tag, format, ...) do {} while(0)
+#define ESP_LOGI(tag, format, ...) do {} while(0)
+#define ESP_LOGD(tag, format, ...) do {} while(0)
+#define ESP_LOGV(tag, format, ...) do {} while(0)
+
+#endif // ESP_LOG_H_
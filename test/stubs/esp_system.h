@@ -0,0 +1,11 @@
+#ifndef ESP_SYSTEM_H_
+#define ESP_SYSTEM_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+inline uint32_t esp_random() {
+  return (uint32_t)rand();
+}
+
+#endif // ESP_SYSTEM_H_
@@ -0,0 +1,18 @@
+#ifndef FREERTOS_H_
+#define FREERTOS_H_
+
+// The FreeRTOS types the sources use. The host tests run on one thread, so
+// the primitives in semphr.h only count.
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif // FREERTOS_H_
@@ -0,0 +1,48 @@
+#ifndef FREERTOS_QUEUE_H_
+#define FREERTOS_QUEUE_H_
+
+#include "FreeRTOS.h"
+#include <string.h>
+#include <deque>
+#include <string>
+
+#define pdPASS pdTRUE
+
+// Items are copied in and out as on the device, nothing ever blocks.
+struct QueueStandIn {
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  std::deque<std::string> items;
+};
+
+typedef QueueStandIn* QueueHandle_t;
+typedef QueueHandle_t xQueueHandle;
+
+inline QueueHandle_t xQueueCreate(const UBaseType_t length, const UBaseType_t itemSize) {
+  return new QueueStandIn { length, itemSize, std::deque<std::string>() };
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t) {
+  if(queue == NULL || queue->items.size() >= queue->length) {
+    return pdFALSE;
+  }
+
+  queue->items.push_back(std::string((const char*)item, queue->itemSize));
+  return pdPASS;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t) {
+  if(queue == NULL || queue->items.empty()) {
+    return pdFALSE;
+  }
+
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  return pdTRUE;
+}
+
+inline void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
+
+#endif // FREERTOS_QUEUE_H_
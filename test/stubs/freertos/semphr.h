@@ -0,0 +1,36 @@
+#ifndef FREERTOS_SEMPHR_H_
+#define FREERTOS_SEMPHR_H_
+
+#include "FreeRTOS.h"
+
+// A recursive mutex that only keeps its depth, tests can check that every
+// take was matched by a give.
+struct SemaphoreStandIn {
+  int depth;
+};
+
+typedef SemaphoreStandIn* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return new SemaphoreStandIn { 0 };
+}
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t) {
+  semaphore->depth++;
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+  if(semaphore->depth == 0) {
+    return pdFALSE;
+  }
+
+  semaphore->depth--;
+  return pdTRUE;
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+#endif // FREERTOS_SEMPHR_H_
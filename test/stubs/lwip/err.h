@@ -0,0 +1,12 @@
+#ifndef LWIP_ERR_H_
+#define LWIP_ERR_H_
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+
+#define ERR_OK 0
+#define ERR_INPROGRESS -5
+#define ERR_ARG -16
+
+#endif // LWIP_ERR_H_
@@ -0,0 +1,31 @@
+#ifndef LWIP_IP_ADDR_H_
+#define LWIP_IP_ADDR_H_
+
+// The dual stack ip_addr_t of the ESP32's lwIP.
+#include <stdint.h>
+#include <stddef.h>
+
+#define IPADDR_TYPE_V4 0U
+#define IPADDR_TYPE_V6 6U
+
+typedef struct {
+  uint32_t addr;
+} ip4_addr_t;
+
+typedef struct {
+  uint32_t addr[4];
+} ip6_addr_t;
+
+typedef struct {
+  union {
+    ip6_addr_t ip6;
+    ip4_addr_t ip4;
+  } u_addr;
+  uint8_t type;
+} ip_addr_t;
+
+#define IP_IS_V4_VAL(ipaddr) ((ipaddr).type == IPADDR_TYPE_V4)
+#define IP_IS_V4(ipaddr) (((ipaddr) == NULL) || IP_IS_V4_VAL(*(ipaddr)))
+#define ip_2_ip4(ipaddr) (&((ipaddr)->u_addr.ip4))
+
+#endif // LWIP_IP_ADDR_H_
@@ -0,0 +1,10 @@
+#ifndef MBEDTLS_ERROR_H_
+#define MBEDTLS_ERROR_H_
+
+#include <stdio.h>
+
+inline void mbedtls_strerror(int error, char* buffer, size_t len) {
+  snprintf(buffer, len, "TLS stand-in error -0x%04X", -error);
+}
+
+#endif // MBEDTLS_ERROR_H_
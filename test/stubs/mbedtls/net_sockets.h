@@ -0,0 +1,6 @@
+#ifndef MBEDTLS_NET_SOCKETS_H_
+#define MBEDTLS_NET_SOCKETS_H_
+
+#define MBEDTLS_ERR_NET_CONN_RESET -0x0050
+
+#endif // MBEDTLS_NET_SOCKETS_H_
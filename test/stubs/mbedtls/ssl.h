@@ -0,0 +1,234 @@
+#ifndef MBEDTLS_SSL_H_
+#define MBEDTLS_SSL_H_
+
+// Stand-in for the mbedTLS client API the HTTP client uses. It does no
+// cryptography: the handshake is a made up exchange of fixed size messages
+// and application data goes through as is, but it steps, blocks and
+// resumes sessions the way mbedTLS does, so SecureTransport runs against an
+// in-process server.
+//
+// The client sends a ClientHello ('H', the offered session ID as 32 bit
+// little endian, zero padded to kClientHelloLength), the server answers a
+// ServerHello ('S' and the session ID it picked, the session is resumed
+// if it's the offered one) and the client finishes with kFinishedLength
+// bytes of 'F'.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MBEDTLS_ERR_SSL_BAD_INPUT_DATA -0x7100
+#define MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY -0x7880
+#define MBEDTLS_ERR_SSL_BAD_HS_SERVER_HELLO -0x7980
+#define MBEDTLS_ERR_SSL_WANT_READ -0x6900
+#define MBEDTLS_ERR_SSL_WANT_WRITE -0x6880
+
+#define MBEDTLS_SSL_IS_CLIENT 0
+#define MBEDTLS_SSL_TRANSPORT_STREAM 0
+#define MBEDTLS_SSL_PRESET_DEFAULT 0
+#define MBEDTLS_SSL_VERIFY_NONE 0
+#define MBEDTLS_SSL_VERIFY_REQUIRED 2
+#define MBEDTLS_SSL_SESSION_TICKETS_ENABLED 1
+
+namespace TlsStandIn {
+  static const size_t kClientHelloLength = 517;
+  static const size_t kServerHelloLength = 5;
+  static const size_t kFinishedLength = 64;
+}
+
+typedef enum {
+  MBEDTLS_SSL_HELLO_REQUEST,
+  MBEDTLS_SSL_CLIENT_HELLO,
+  MBEDTLS_SSL_SERVER_HELLO,
+  MBEDTLS_SSL_CLIENT_FINISHED = 11,
+  MBEDTLS_SSL_HANDSHAKE_WRAPUP = 15,
+  MBEDTLS_SSL_HANDSHAKE_OVER = 16
+} mbedtls_ssl_states;
+
+typedef int mbedtls_ssl_send_t(void* ctx, const unsigned char* buf, size_t len);
+typedef int mbedtls_ssl_recv_t(void* ctx, unsigned char* buf, size_t len);
+typedef int mbedtls_ssl_recv_timeout_t(void* ctx, unsigned char* buf, size_t len, uint32_t timeout);
+
+typedef struct mbedtls_x509_crt mbedtls_x509_crt;
+
+typedef struct {
+  int authmode;
+} mbedtls_ssl_config;
+
+typedef struct {
+  uint32_t id;
+} mbedtls_ssl_session;
+
+typedef struct {
+  int resume;
+} mbedtls_ssl_handshake_params;
+
+typedef struct {
+  int state;
+  mbedtls_ssl_handshake_params* handshake;
+  const mbedtls_ssl_config* conf;
+  void* p_bio;
+  mbedtls_ssl_send_t* f_send;
+  mbedtls_ssl_recv_t* f_recv;
+  uint32_t offeredSession;
+  uint32_t session;
+  unsigned char out[TlsStandIn::kClientHelloLength];
+  size_t outLength;
+  size_t outOffset;
+  unsigned char in[TlsStandIn::kServerHelloLength];
+  size_t inLength;
+} mbedtls_ssl_context;
+
+inline void mbedtls_ssl_init(mbedtls_ssl_context* ssl) {
+  memset(ssl, 0, sizeof(*ssl));
+}
+
+inline void mbedtls_ssl_free(mbedtls_ssl_context* ssl) {
+  delete ssl->handshake;
+  memset(ssl, 0, sizeof(*ssl));
+}
+
+inline void mbedtls_ssl_config_init(mbedtls_ssl_config* conf) {
+  conf->authmode = MBEDTLS_SSL_VERIFY_NONE;
+}
+
+inline void mbedtls_ssl_config_free(mbedtls_ssl_config*) {}
+
+inline int mbedtls_ssl_config_defaults(mbedtls_ssl_config*, int, int, int) {
+  return 0;
+}
+
+inline void mbedtls_ssl_conf_authmode(mbedtls_ssl_config* conf, int authmode) {
+  conf->authmode = authmode;
+}
+
+inline void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config*, mbedtls_x509_crt*, void*) {}
+
+inline void mbedtls_ssl_conf_rng(mbedtls_ssl_config*, int (*)(void*, unsigned char*, size_t), void*) {}
+
+inline void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config*, int) {}
+
+inline int mbedtls_ssl_setup(mbedtls_ssl_context* ssl, const mbedtls_ssl_config* conf) {
+  ssl->conf = conf;
+  ssl->handshake = new mbedtls_ssl_handshake_params { 0 };
+  ssl->state = MBEDTLS_SSL_HELLO_REQUEST;
+  return 0;
+}
+
+inline int mbedtls_ssl_set_hostname(mbedtls_ssl_context*, const char*) {
+  return 0;
+}
+
+inline void mbedtls_ssl_set_bio(mbedtls_ssl_context* ssl, void* p_bio, mbedtls_ssl_send_t* f_send,
+                                mbedtls_ssl_recv_t* f_recv, mbedtls_ssl_recv_timeout_t*) {
+  ssl->p_bio = p_bio;
+  ssl->f_send = f_send;
+  ssl->f_recv = f_recv;
+}
+
+inline void mbedtls_ssl_session_init(mbedtls_ssl_session* session) {
+  session->id = 0;
+}
+
+inline void mbedtls_ssl_session_free(mbedtls_ssl_session* session) {
+  session->id = 0;
+}
+
+inline int mbedtls_ssl_set_session(mbedtls_ssl_context* ssl, const mbedtls_ssl_session* session) {
+  ssl->offeredSession = session->id;
+  return 0;
+}
+
+inline int mbedtls_ssl_get_session(const mbedtls_ssl_context* ssl, mbedtls_ssl_session* session) {
+  if(ssl->session == 0) {
+    return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+  }
+
+  session->id = ssl->session;
+  return 0;
+}
+
+// Sends what's left of the last handshake message.
+inline int mbedtls_ssl_flush_output(mbedtls_ssl_context* ssl) {
+  while(ssl->outOffset < ssl->outLength) {
+    const int sent = ssl->f_send(ssl->p_bio, ssl->out + ssl->outOffset, ssl->outLength - ssl->outOffset);
+    if(sent < 0) {
+      return sent;
+    }
+
+    ssl->outOffset += sent;
+  }
+
+  ssl->outLength = 0;
+  ssl->outOffset = 0;
+  return 0;
+}
+
+inline int mbedtls_ssl_handshake_step(mbedtls_ssl_context* ssl) {
+  int error = mbedtls_ssl_flush_output(ssl);
+  if(error != 0) {
+    return error;
+  }
+
+  switch(ssl->state) {
+    case MBEDTLS_SSL_HELLO_REQUEST:
+      ssl->state = MBEDTLS_SSL_CLIENT_HELLO;
+      return 0;
+    case MBEDTLS_SSL_CLIENT_HELLO:
+      memset(ssl->out, 0, TlsStandIn::kClientHelloLength);
+      ssl->out[0] = 'H';
+      memcpy(ssl->out + 1, &ssl->offeredSession, sizeof(ssl->offeredSession));
+      ssl->outLength = TlsStandIn::kClientHelloLength;
+      ssl->state = MBEDTLS_SSL_SERVER_HELLO;
+      return mbedtls_ssl_flush_output(ssl);
+    case MBEDTLS_SSL_SERVER_HELLO:
+      while(ssl->inLength < TlsStandIn::kServerHelloLength) {
+        const int received = ssl->f_recv(ssl->p_bio, ssl->in + ssl->inLength, TlsStandIn::kServerHelloLength - ssl->inLength);
+        if(received < 0) {
+          return received;
+        }
+
+        ssl->inLength += received;
+      }
+
+      if(ssl->in[0] != 'S') {
+        return MBEDTLS_ERR_SSL_BAD_HS_SERVER_HELLO;
+      }
+
+      memcpy(&ssl->session, ssl->in + 1, sizeof(ssl->session));
+      ssl->handshake->resume = ssl->offeredSession != 0 && ssl->session == ssl->offeredSession;
+      ssl->state = MBEDTLS_SSL_CLIENT_FINISHED;
+      return 0;
+    case MBEDTLS_SSL_CLIENT_FINISHED:
+      memset(ssl->out, 'F', TlsStandIn::kFinishedLength);
+      ssl->outLength = TlsStandIn::kFinishedLength;
+      ssl->state = MBEDTLS_SSL_HANDSHAKE_WRAPUP;
+      return mbedtls_ssl_flush_output(ssl);
+    case MBEDTLS_SSL_HANDSHAKE_WRAPUP:
+      // Like mbedTLS, the handshake parameters are gone once it's over.
+      delete ssl->handshake;
+      ssl->handshake = NULL;
+      ssl->state = MBEDTLS_SSL_HANDSHAKE_OVER;
+      return 0;
+    default:
+      return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+  }
+}
+
+inline int mbedtls_ssl_read(mbedtls_ssl_context* ssl, unsigned char* buf, size_t len) {
+  if(ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+    return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+  }
+
+  return ssl->f_recv(ssl->p_bio, buf, len);
+}
+
+inline int mbedtls_ssl_write(mbedtls_ssl_context* ssl, const unsigned char* buf, size_t len) {
+  if(ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+    return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+  }
+
+  return ssl->f_send(ssl->p_bio, buf, len);
+}
+
+#endif // MBEDTLS_SSL_H_
@@ -0,0 +1,7 @@
+#ifndef MBEDTLS_SSL_INTERNAL_H_
+#define MBEDTLS_SSL_INTERNAL_H_
+
+// mbedtls_ssl_handshake_params lives in ssl.h of the stand-in.
+#include "ssl.h"
+
+#endif // MBEDTLS_SSL_INTERNAL_H_
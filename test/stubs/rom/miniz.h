@@ -0,0 +1,101 @@
+#ifndef ROM_MINIZ_H_
+#define ROM_MINIZ_H_
+
+// The tinfl API of the inflater in the ESP32 ROM, on top of the host's
+// zlib (link with -lz). zlib allocates its state and window from an arena
+// in the decompressor, so freeing the decompressor frees everything as
+// with tinfl. The arena makes it ~45 KB against ~11 KB on the ESP32.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+  TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+  TINFL_FLAG_HAS_MORE_INPUT = 2,
+  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+  TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef enum {
+  TINFL_STATUS_BAD_PARAM = -3,
+  TINFL_STATUS_ADLER32_MISMATCH = -2,
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+typedef struct {
+  uint32_t m_state;
+  z_stream stream;
+  size_t arenaUsed;
+  alignas(16) unsigned char arena[12 * 1024 + TINFL_LZ_DICT_SIZE];
+} tinfl_decompressor;
+
+#define tinfl_init(r) do { (r)->m_state = 0; } while(0)
+
+inline voidpf tinfl_arena_alloc(voidpf opaque, uInt items, uInt size) {
+  tinfl_decompressor* r = (tinfl_decompressor*)opaque;
+  const size_t length = ((size_t)items * size + 15) & ~(size_t)15;
+
+  if(r->arenaUsed + length > sizeof(r->arena)) {
+    return Z_NULL;
+  }
+
+  voidpf memory = r->arena + r->arenaUsed;
+  r->arenaUsed += length;
+  return memory;
+}
+
+inline void tinfl_arena_free(voidpf, voidpf) {}
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor* r,
+                                     const uint8_t* pIn_buf_next,
+                                     size_t* pIn_buf_size,
+                                     uint8_t* pOut_buf_start,
+                                     uint8_t* pOut_buf_next,
+                                     size_t* pOut_buf_size,
+                                     const uint32_t decomp_flags) {
+  if(pOut_buf_next < pOut_buf_start) {
+    return TINFL_STATUS_BAD_PARAM;
+  }
+
+  if(r->m_state == 0) {
+    memset(&r->stream, 0, sizeof(r->stream));
+    r->stream.zalloc = tinfl_arena_alloc;
+    r->stream.zfree = tinfl_arena_free;
+    r->stream.opaque = r;
+    r->arenaUsed = 0;
+
+    if(inflateInit2(&r->stream, (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER) ? MAX_WBITS : -MAX_WBITS) != Z_OK) {
+      return TINFL_STATUS_FAILED;
+    }
+
+    r->m_state = 1;
+  }
+
+  r->stream.next_in = (Bytef*)pIn_buf_next;
+  r->stream.avail_in = *pIn_buf_size;
+  r->stream.next_out = pOut_buf_next;
+  r->stream.avail_out = *pOut_buf_size;
+
+  const int result = inflate(&r->stream, Z_NO_FLUSH);
+
+  *pIn_buf_size -= r->stream.avail_in;
+  *pOut_buf_size -= r->stream.avail_out;
+
+  if(result == Z_STREAM_END) {
+    return TINFL_STATUS_DONE;
+  } else if(result != Z_OK && result != Z_BUF_ERROR) {
+    return TINFL_STATUS_FAILED;
+  } else if(r->stream.avail_out == 0) {
+    return TINFL_STATUS_HAS_MORE_OUTPUT;
+  }
+
+  return (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) ? TINFL_STATUS_NEEDS_MORE_INPUT : TINFL_STATUS_FAILED;
+}
+
+#endif // ROM_MINIZ_H_
@@ -0,0 +1,131 @@
+#include <unity.h>
+#include "dns/resolver.h"
+
+extern "C" {
+  #include "lwip/dns.h"
+}
+
+// Resolves through the lwIP stand-in, which answers right away as if lwIP
+// had the name cached.
+
+static unsigned long Now = 0;
+
+unsigned long millis() {
+  return Now;
+}
+
+static ip_addr_t V4Answer() {
+  ip_addr_t answer = {};
+  answer.type = IPADDR_TYPE_V4;
+  answer.u_addr.ip4.addr = IPAddress(93, 184, 216, 34);
+  return answer;
+}
+
+static ip_addr_t V6Answer() {
+  ip_addr_t answer = {};
+  answer.type = IPADDR_TYPE_V6;
+  answer.u_addr.ip6.addr[0] = 0x00b80d20;
+  answer.u_addr.ip6.addr[3] = 0x01000000;
+  return answer;
+}
+
+struct Answer {
+  int calls;
+  bool success;
+  IPAddress address;
+};
+
+static Dns::Resolver::Callback Into(Answer& answer) {
+  return [&answer](bool success, const IPAddress& address) {
+    answer.calls++;
+    answer.success = success;
+    answer.address = address;
+  };
+}
+
+void setUp() {
+  Now = 1000;
+  DnsStandIn::IsPending() = false;
+}
+
+void tearDown() {
+}
+
+void test_v4_answer() {
+  Dns::Resolver resolver;
+  Answer answer = { 0, false, IPAddress() };
+
+  DnsStandIn::Answer() = V4Answer();
+  TEST_ASSERT_TRUE(resolver.resolve("api.open-meteo.com", Into(answer)));
+
+  TEST_ASSERT_EQUAL(1, answer.calls);
+  TEST_ASSERT_TRUE(answer.success);
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)IPAddress(93, 184, 216, 34), (uint32_t)answer.address);
+
+  // Cached from now on.
+  TEST_ASSERT_TRUE(resolver.resolve("API.open-meteo.com", Into(answer)));
+  TEST_ASSERT_EQUAL(2, answer.calls);
+  TEST_ASSERT_EQUAL_UINT32(1, resolver.getStatistics().hits);
+  TEST_ASSERT_EQUAL_UINT32(1, resolver.getStatistics().lookups);
+}
+
+void test_v6_answer_is_a_failure() {
+  Dns::Resolver resolver;
+  Answer answer = { 0, true, IPAddress() };
+
+  DnsStandIn::Answer() = V6Answer();
+  resolver.resolve("api.open-meteo.com", Into(answer));
+
+  TEST_ASSERT_EQUAL(1, answer.calls);
+  TEST_ASSERT_FALSE(answer.success);
+  TEST_ASSERT_EQUAL_UINT32(1, resolver.getStatistics().failures);
+
+  IPAddress address;
+  TEST_ASSERT_FALSE(resolver.get("api.open-meteo.com", address));
+
+  // Cached as a failure until the negative TTL passed.
+  DnsStandIn::Answer() = V4Answer();
+  TEST_ASSERT_FALSE(resolver.resolve("api.open-meteo.com", Into(answer)));
+  TEST_ASSERT_EQUAL_UINT32(1, resolver.getStatistics().negativeHits);
+}
+
+void test_v6_answer_keeps_prefetched_address() {
+  Dns::Resolver resolver(4000, 1000);
+  Answer answer = { 0, false, IPAddress() };
+
+  DnsStandIn::Answer() = V4Answer();
+  resolver.resolve("api.open-meteo.com", Into(answer));
+
+  // Past three quarters of the TTL the cached address is handed out and
+  // looked up again, an IPv6 answer doesn't replace it.
+  Now += 3500;
+  DnsStandIn::Answer() = V6Answer();
+  TEST_ASSERT_TRUE(resolver.resolve("api.open-meteo.com", Into(answer)));
+
+  TEST_ASSERT_TRUE(answer.success);
+  TEST_ASSERT_EQUAL_UINT32(1, resolver.getStatistics().prefetches);
+  TEST_ASSERT_EQUAL_UINT32(1, resolver.getStatistics().failures);
+
+  IPAddress address;
+  TEST_ASSERT_TRUE(resolver.get("api.open-meteo.com", address));
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)IPAddress(93, 184, 216, 34), (uint32_t)address);
+}
+
+void test_address_literal() {
+  Dns::Resolver resolver;
+  Answer answer = { 0, false, IPAddress() };
+
+  TEST_ASSERT_TRUE(resolver.resolve("192.168.1.20", Into(answer)));
+  TEST_ASSERT_TRUE(answer.success);
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)IPAddress(192, 168, 1, 20), (uint32_t)answer.address);
+  TEST_ASSERT_EQUAL_UINT32(0, resolver.getStatistics().lookups);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_v4_answer);
+  RUN_TEST(test_v6_answer_is_a_failure);
+  RUN_TEST(test_v6_answer_keeps_prefetched_address);
+  RUN_TEST(test_address_literal);
+  return UNITY_END();
+}
@@ -0,0 +1,255 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "http/inflate_stream.h"
+
+// Compares receiving the station's bodies plain against gzip compressed
+// through Http::InflateStream: bytes on the wire, time spent per body and
+// the heap held while a body is received. The report shows up in the test
+// output (pio test -e native -v).
+//
+// The host inflater is zlib and its state is bigger than the one in the
+// ESP32 ROM, the device figure is computed from the ROM's tinfl layout.
+
+unsigned long millis() {
+  return 0;
+}
+
+//
+// - heap
+//
+// tinfl_decompressor of the ROM's miniz: three Huffman tables of 3488 bytes
+// and the code lengths, plus the 32 KB window InflateStream allocates.
+static const size_t kRomDecompressorSize = 10992;
+
+static size_t HeapInUse() {
+#ifdef __GLIBC__
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+//
+// - recorded bodies
+//
+// Open-Meteo, as requested by openmeteo::Client.
+static const char kOpenMeteoCurrent[] =
+  "{\"latitude\":52.52,\"longitude\":13.419998,\"generationtime_ms\":0.06103515625,\"utc_offset_seconds\":0,"
+  "\"timezone\":\"GMT\",\"timezone_abbreviation\":\"GMT\",\"elevation\":38.0,\"current_weather\":"
+  "{\"temperature\":12.3,\"windspeed\":14.8,\"winddirection\":221,\"weathercode\":3,\"is_day\":1,"
+  "\"time\":\"2024-04-14T08:45\"}}";
+
+static const char kOpenMeteoDaily[] =
+  "{\"latitude\":52.52,\"longitude\":13.419998,\"generationtime_ms\":0.0629425048828125,\"utc_offset_seconds\":7200,"
+  "\"timezone\":\"Europe/Berlin\",\"timezone_abbreviation\":\"CEST\",\"elevation\":38.0,\"daily_units\":"
+  "{\"time\":\"iso8601\",\"weathercode\":\"wmo code\",\"temperature_2m_max\":\"°C\",\"temperature_2m_min\":\"°C\"},"
+  "\"daily\":{\"time\":[\"2024-04-14\",\"2024-04-15\",\"2024-04-16\",\"2024-04-17\"],\"weathercode\":[3,61,80,2],"
+  "\"temperature_2m_max\":[14.1,11.8,9.6,12.4],\"temperature_2m_min\":[5.2,6.9,4.1,3.3]}}";
+
+static const char* const kWeekdays[] = { "Saturday", "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday" };
+static const char* const kIcons[] = { "chancerain", "partlycloudy", "rain", "clear", "cloudy", "mostlysunny", "tstorms" };
+
+// Weather Underground conditions, the bulk is station and location details.
+static std::string RecordedConditions() {
+  std::string body =
+    "{\n  \"response\": {\n  \"version\":\"0.1\",\n  \"termsofService\":\"http://www.wunderground.com/weather/api/d/terms.html\",\n"
+    "  \"features\": {\n  \"conditions\": 1\n  }\n  }\n  ,\t\"current_observation\": {\n";
+
+  static const char* const kFields[][2] = {
+    { "full", "\"Amsterdam, Netherlands\"" }, { "city", "\"Amsterdam\"" }, { "country", "\"NL\"" },
+    { "latitude", "\"52.310000\"" }, { "longitude", "\"4.770000\"" }, { "station_id", "\"EHAM\"" },
+    { "observation_time", "\"Last Updated on April 14, 10:25 AM CEST\"" },
+    { "observation_time_rfc822", "\"Sat, 14 Apr 2018 10:25:00 +0200\"" }, { "observation_epoch", "\"1523694300\"" },
+    { "local_time_rfc822", "\"Sat, 14 Apr 2018 10:41:12 +0200\"" }, { "local_tz_long", "\"Europe/Amsterdam\"" },
+    { "weather", "\"Mostly Cloudy\"" }, { "temperature_string", "\"54 F (12 C)\"" }, { "temp_f", "54" },
+    { "temp_c", "12.3" }, { "relative_humidity", "\"82%\"" }, { "wind_string", "\"From the SW at 9 MPH\"" },
+    { "wind_dir", "\"SW\"" }, { "wind_degrees", "220" }, { "pressure_mb", "\"1012\"" },
+    { "dewpoint_string", "\"48 F (9 C)\"" }, { "feelslike_string", "\"54 F (12 C)\"" },
+    { "precip_1hr_string", "\"-9999.00 in (-9999.00 mm)\"" }, { "icon", "\"mostlycloudy\"" },
+    { "icon_url", "\"http://icons.wxug.com/i/c/k/mostlycloudy.gif\"" },
+    { "forecast_url", "\"http://www.wunderground.com/global/stations/06240.html\"" },
+    { "history_url", "\"http://www.wunderground.com/history/airport/EHAM/2018/4/14/DailyHistory.html\"" },
+    { "ob_url", "\"http://www.wunderground.com/cgi-bin/findweather/getForecast?query=52.31,4.79\"" }
+  };
+
+  for(size_t i = 0; i < sizeof(kFields) / sizeof(kFields[0]); i++) {
+    body += std::string("    \"") + kFields[i][0] + "\":" + kFields[i][1] + (i + 1 < sizeof(kFields) / sizeof(kFields[0]) ? ",\n" : "\n");
+  }
+
+  return body + "  }\n}\n";
+}
+
+// Weather Underground forecast with the text forecast the projection skips.
+static std::string RecordedForecast(const int days) {
+  std::string body = "{\n  \"response\": {\n  \"version\":\"0.1\",\n  \"features\": {\n  \"forecast\": 1\n  }\n  }\n"
+                     "  ,\n  \"forecast\":{\n    \"txt_forecast\": {\n    \"date\":\"10:00 AM CEST\",\n    \"forecastday\": [\n";
+
+  char buffer[1024];
+
+  for(int i = 0; i < 2 * days; i++) {
+    snprintf(buffer, sizeof(buffer),
+      "    %s{\n    \"period\":%d,\n    \"icon\":\"%s\",\n    \"icon_url\":\"http://icons.wxug.com/i/c/k/%s%s.gif\",\n"
+      "    \"title\":\"%s%s\",\n    \"fcttext\":\"Cloudy with periods of rain. High around 14C. Winds SW at 15 to 25 km/h.\",\n"
+      "    \"fcttext_metric\":\"Periods of rain. High 14C. Winds SW at 15 to 30 km/h. Chance of rain 70%%.\",\n"
+      "    \"pop\":\"%d\"\n    }\n",
+      i > 0 ? "," : "", i, kIcons[i % 7], i % 2 ? "nt_" : "", kIcons[i % 7],
+      kWeekdays[(i / 2) % 7], i % 2 ? " Night" : "", (i * 10) % 100);
+    body += buffer;
+  }
+
+  body += "    ]\n    },\n    \"simpleforecast\": {\n    \"forecastday\": [\n";
+
+  for(int i = 0; i < days; i++) {
+    snprintf(buffer, sizeof(buffer),
+      "    %s{\"date\":{\n  \"epoch\":\"%d\",\n  \"pretty\":\"7:00 PM CEST on April %d, 2018\",\n  \"day\":%d,\n  \"month\":4,\n"
+      "  \"year\":2018,\n  \"weekday\":\"%s\",\n  \"tz_long\":\"Europe/Amsterdam\"\n},\n"
+      "    \"period\":%d,\n    \"high\": {\n    \"fahrenheit\":\"%d\",\n    \"celsius\":\"%d\"\n    },\n"
+      "    \"low\": {\n    \"fahrenheit\":\"%d\",\n    \"celsius\":\"%d\"\n    },\n"
+      "    \"conditions\":\"Chance of Rain\",\n    \"icon\":\"%s\",\n"
+      "    \"icon_url\":\"http://icons.wxug.com/i/c/k/%s.gif\",\n    \"pop\":%d,\n"
+      "    \"avehumidity\": 78,\n    \"maxhumidity\": 0,\n    \"minhumidity\": 0\n    }\n",
+      i > 0 ? "," : "", 1523725200 + i * 86400, 14 + i, 14 + i, kWeekdays[i % 7], i + 1,
+      (14 + i) * 9 / 5 + 32, 14 + i, (5 + i) * 9 / 5 + 32, 5 + i,
+      kIcons[i % 7], kIcons[i % 7], (i * 10) % 100);
+    body += buffer;
+  }
+
+  return body + "    ]\n    }\n  }\n}\n";
+}
+
+// At the level servers use by default.
+static std::string Gzip(const std::string& body) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  TEST_ASSERT_EQUAL_INT(Z_OK, deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY));
+
+  std::string compressed(deflateBound(&stream, body.size()), '\0');
+  stream.next_in = (Bytef*)body.data();
+  stream.avail_in = body.size();
+  stream.next_out = (Bytef*)&compressed[0];
+  stream.avail_out = compressed.size();
+
+  TEST_ASSERT_EQUAL_INT(Z_STREAM_END, deflate(&stream, Z_FINISH));
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+
+  return compressed;
+}
+
+//
+// - replay
+//
+// Largest TCP segment seen from the APIs, the MSS of an Ethernet path.
+static const size_t kSegment = 1460;
+static const int kReplays = 2000;
+
+static std::string Received;
+
+static void Receive(const std::string& wire, const bool isCompressed, Http::InflateStream& inflate, const Http::BodyCallback& onBody) {
+  if(isCompressed) {
+    TEST_ASSERT_TRUE(inflate.begin(Http::InflateStream::eGzip));
+  }
+
+  for(size_t offset = 0; offset < wire.size(); offset += kSegment) {
+    const size_t len = std::min(kSegment, wire.size() - offset);
+
+    if(isCompressed) {
+      TEST_ASSERT_TRUE(inflate.write(wire.data() + offset, len, onBody));
+    } else {
+      onBody(wire.data() + offset, len);
+    }
+  }
+
+  if(isCompressed) {
+    TEST_ASSERT_TRUE(inflate.isDone());
+    inflate.end();
+  }
+}
+
+static double Time(const std::string& wire, const bool isCompressed, Http::InflateStream& inflate, const Http::BodyCallback& onBody) {
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  for(int i = 0; i < kReplays; i++) {
+    Received.clear();
+    Receive(wire, isCompressed, inflate, onBody);
+  }
+
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kReplays;
+}
+
+static void Compare(const char* name, const std::string& body) {
+  const std::string compressed = Gzip(body);
+  const Http::BodyCallback onBody = [](const char* data, size_t len) {
+    Received.append(data, len);
+  };
+
+  Http::InflateStream inflate;
+  Received.reserve(body.size());
+
+  // Same body either way. A plain body goes straight through, inflating
+  // holds the decompressor and the window until the end of the body.
+  const size_t heapInUse = HeapInUse();
+
+  Received.clear();
+  Receive(body, false, inflate, onBody);
+  TEST_ASSERT_TRUE(Received == body);
+  TEST_ASSERT_EQUAL_UINT(heapInUse, HeapInUse());
+
+  TEST_ASSERT_TRUE(inflate.begin(Http::InflateStream::eGzip));
+  const size_t compressedHeap = HeapInUse() - heapInUse;
+  inflate.end();
+
+  Received.clear();
+  Receive(compressed, true, inflate, onBody);
+  TEST_ASSERT_TRUE(Received == body);
+  TEST_ASSERT_EQUAL_UINT(heapInUse, HeapInUse());
+
+  const double plainTime = Time(body, false, inflate, onBody);
+  const double compressedTime = Time(compressed, true, inflate, onBody);
+
+  char buffer[192];
+  snprintf(buffer, sizeof(buffer), "%-20s %6u -> %5u bytes (%4.1f%%)  plain %6.2f us  gzip %6.2f us  heap %u bytes (host), %u bytes (ESP32)",
+    name, (unsigned)body.size(), (unsigned)compressed.size(), 100.0 * compressed.size() / body.size(),
+    plainTime, compressedTime, (unsigned)compressedHeap, (unsigned)(kRomDecompressorSize + TINFL_LZ_DICT_SIZE));
+  TEST_MESSAGE(buffer);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_open_meteo_current() {
+  Compare("open-meteo current", kOpenMeteoCurrent);
+}
+
+void test_open_meteo_daily() {
+  Compare("open-meteo daily", kOpenMeteoDaily);
+}
+
+void test_wunderground_conditions() {
+  Compare("wunderground cond.", RecordedConditions());
+}
+
+void test_wunderground_forecast() {
+  Compare("wunderground forecast", RecordedForecast(4));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_open_meteo_current);
+  RUN_TEST(test_open_meteo_daily);
+  RUN_TEST(test_wunderground_conditions);
+  RUN_TEST(test_wunderground_forecast);
+  return UNITY_END();
+}
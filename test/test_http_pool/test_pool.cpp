@@ -0,0 +1,198 @@
+#include <unity.h>
+#include <string>
+#include "http/connection_pool.h"
+
+static unsigned long Now = 0;
+
+unsigned long millis() {
+  return Now;
+}
+
+// Accepts every connection and keeps what was sent to it.
+class Server : public AsyncTcpPeer {
+  public:
+    uint32_t accepted = 0;
+    std::string received;
+
+    bool accept(AsyncClient*, const char*, const uint16_t) override {
+      this->accepted++;
+      return true;
+    }
+
+    void receive(AsyncClient*, const char* data, size_t len) override {
+      this->received.append(data, len);
+    }
+};
+
+static const uint32_t kIdleTimeout = 1000;
+static const char kHost[] = "api.open-meteo.com";
+
+static Server* server = NULL;
+static Http::ConnectionPool* pool = NULL;
+
+static AsyncClient* Connect(const char* host) {
+  bool isConnected = true;
+  AsyncClient* client = pool->acquire(host, 80, isConnected);
+
+  TEST_ASSERT_NOT_NULL(client);
+  TEST_ASSERT_FALSE(isConnected);
+  TEST_ASSERT_TRUE(client->connect(host, 80));
+
+  AsyncTcp::Run();
+  TEST_ASSERT_TRUE(client->connected());
+
+  return client;
+}
+
+void setUp() {
+  Now = 0;
+  AsyncTcp::Reset();
+
+  server = new Server();
+  AsyncTcp::Peer() = server;
+
+  pool = new Http::ConnectionPool(kIdleTimeout);
+}
+
+void tearDown() {
+  delete pool;
+  delete server;
+}
+
+void test_reuses_connection() {
+  AsyncClient* client = Connect(kHost);
+  pool->release(client, true);
+
+  Now += kIdleTimeout / 2;
+
+  bool isConnected = false;
+  TEST_ASSERT_EQUAL_PTR(client, pool->acquire(kHost, 80, isConnected));
+  TEST_ASSERT_TRUE(isConnected);
+
+  // Still the same TCP connection to the server.
+  TEST_ASSERT_EQUAL_UINT32(1, server->accepted);
+  TEST_ASSERT_EQUAL_UINT32(1, AsyncTcp::GetStatistics().connects);
+
+  const Http::ConnectionPool::Statistics& statistics = pool->getStatistics();
+  TEST_ASSERT_EQUAL_UINT32(1, statistics.hits);
+  TEST_ASSERT_EQUAL_UINT32(1, statistics.misses);
+  TEST_ASSERT_EQUAL_UINT32(0, statistics.evictions);
+}
+
+void test_other_port_is_not_reused() {
+  AsyncClient* client = Connect(kHost);
+  pool->release(client, true);
+
+  bool isConnected = true;
+  AsyncClient* other = pool->acquire(kHost, 8080, isConnected);
+  TEST_ASSERT_NOT_NULL(other);
+  TEST_ASSERT_TRUE(other != client);
+  TEST_ASSERT_FALSE(isConnected);
+}
+
+void test_closed_without_keep_alive() {
+  AsyncClient* client = Connect(kHost);
+  pool->release(client, false);
+
+  TEST_ASSERT_FALSE(client->connected());
+  TEST_ASSERT_EQUAL_UINT32(1, AsyncTcp::GetStatistics().closes);
+}
+
+void test_evicts_idle_connection_on_poll() {
+  AsyncClient* client = Connect(kHost);
+  pool->release(client, true);
+
+  Now += kIdleTimeout;
+  client->poll();
+  TEST_ASSERT_TRUE(client->connected());
+
+  Now += 1;
+  client->poll();
+  TEST_ASSERT_FALSE(client->connected());
+  TEST_ASSERT_EQUAL_UINT32(1, pool->getStatistics().evictions);
+
+  // The next request opens a new connection.
+  bool isConnected = true;
+  TEST_ASSERT_NOT_NULL(pool->acquire(kHost, 80, isConnected));
+  TEST_ASSERT_FALSE(isConnected);
+  TEST_ASSERT_EQUAL_UINT32(2, pool->getStatistics().misses);
+}
+
+void test_evicts_idle_connection_on_acquire() {
+  AsyncClient* client = Connect(kHost);
+  pool->release(client, true);
+
+  Now += kIdleTimeout + 1;
+
+  bool isConnected = true;
+  TEST_ASSERT_NOT_NULL(pool->acquire(kHost, 80, isConnected));
+  TEST_ASSERT_FALSE(isConnected);
+  TEST_ASSERT_FALSE(client->connected());
+  TEST_ASSERT_EQUAL_UINT32(1, pool->getStatistics().evictions);
+}
+
+void test_drops_connection_closed_by_server() {
+  AsyncClient* client = Connect(kHost);
+  pool->release(client, true);
+
+  client->hangUp();
+  AsyncTcp::Run();
+
+  bool isConnected = true;
+  TEST_ASSERT_NOT_NULL(pool->acquire(kHost, 80, isConnected));
+  TEST_ASSERT_FALSE(isConnected);
+  TEST_ASSERT_EQUAL_UINT32(0, pool->getStatistics().hits);
+}
+
+void test_drops_connection_on_unexpected_data() {
+  AsyncClient* client = Connect(kHost);
+  pool->release(client, true);
+
+  client->deliver("HTTP/1.1 408 Request Timeout\r\n\r\n", 32);
+  AsyncTcp::Run();
+
+  TEST_ASSERT_FALSE(client->connected());
+}
+
+void test_takes_over_least_recently_used() {
+  AsyncClient* first = Connect("a.example.com");
+  Now += 10;
+  AsyncClient* second = Connect("b.example.com");
+  Now += 10;
+  AsyncClient* third = Connect("c.example.com");
+
+  pool->release(second, true);
+  Now += 10;
+  pool->release(first, true);
+  pool->release(third, true);
+
+  bool isConnected = true;
+  TEST_ASSERT_EQUAL_PTR(second, pool->acquire("d.example.com", 80, isConnected));
+  TEST_ASSERT_FALSE(isConnected);
+  TEST_ASSERT_TRUE(first->connected());
+  TEST_ASSERT_TRUE(third->connected());
+  TEST_ASSERT_EQUAL_UINT32(1, pool->getStatistics().evictions);
+}
+
+void test_all_busy() {
+  Connect("a.example.com");
+  Connect("b.example.com");
+  Connect("c.example.com");
+
+  bool isConnected = true;
+  TEST_ASSERT_NULL(pool->acquire("d.example.com", 80, isConnected));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_reuses_connection);
+  RUN_TEST(test_other_port_is_not_reused);
+  RUN_TEST(test_closed_without_keep_alive);
+  RUN_TEST(test_evicts_idle_connection_on_poll);
+  RUN_TEST(test_evicts_idle_connection_on_acquire);
+  RUN_TEST(test_drops_connection_closed_by_server);
+  RUN_TEST(test_drops_connection_on_unexpected_data);
+  RUN_TEST(test_takes_over_least_recently_used);
+  RUN_TEST(test_all_busy);
+  return UNITY_END();
+}
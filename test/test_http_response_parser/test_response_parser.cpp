@@ -0,0 +1,156 @@
+#include <unity.h>
+#include <string>
+#include "http/response_parser.h"
+
+unsigned long millis() {
+  return 0;
+}
+
+static Http::Headers Headers;
+static Http::ResponseParser Parser(Headers);
+static std::string Body;
+
+static void Feed(const std::string& response) {
+  const size_t consumed = Parser.parse(response.data(), response.size());
+
+  Parser.parseBody(response.data() + consumed, response.size() - consumed, [](const char* data, size_t len) {
+    Body.append(data, len);
+  });
+}
+
+static std::string WithETag(const std::string& eTag) {
+  return "HTTP/1.1 200 OK\r\nETag: " + eTag + "\r\nContent-Length: 2\r\n\r\n{}";
+}
+
+void setUp() {
+  Parser.reset();
+  Body.clear();
+}
+
+void tearDown() {
+}
+
+void test_plain_response() {
+  Feed(WithETag("\"abc\""));
+
+  TEST_ASSERT_TRUE(Parser.isComplete());
+  TEST_ASSERT_EQUAL_UINT16(200, Parser.getStatusCode());
+  TEST_ASSERT_EQUAL_STRING("\"abc\"", Headers.get(Http::kETag));
+  TEST_ASSERT_FALSE(Headers.isTruncated(Http::kETag));
+  TEST_ASSERT_TRUE(Body == "{}");
+}
+
+void test_longest_value_fits() {
+  const std::string eTag(Http::Headers::kMaxValueLength - 1, 'a');
+  Feed(WithETag(eTag));
+
+  TEST_ASSERT_EQUAL_STRING(eTag.c_str(), Headers.get(Http::kETag));
+  TEST_ASSERT_FALSE(Headers.isTruncated(Http::kETag));
+}
+
+void test_long_value_is_truncated() {
+  Feed(WithETag("\"" + std::string(Http::Headers::kMaxValueLength, 'a') + "\""));
+
+  TEST_ASSERT_TRUE(Parser.isComplete());
+  TEST_ASSERT_TRUE(Headers.isTruncated(Http::kETag));
+  TEST_ASSERT_FALSE(Headers.isTruncated(Http::kContentLength));
+}
+
+void test_trailing_whitespace_is_not_truncation() {
+  const std::string eTag(Http::Headers::kMaxValueLength - 1, 'a');
+  Feed(WithETag(eTag + "   \t"));
+
+  TEST_ASSERT_EQUAL_STRING(eTag.c_str(), Headers.get(Http::kETag));
+  TEST_ASSERT_FALSE(Headers.isTruncated(Http::kETag));
+}
+
+void test_reset_clears_truncation() {
+  Feed(WithETag(std::string(2 * Http::Headers::kMaxValueLength, 'a')));
+  TEST_ASSERT_TRUE(Headers.isTruncated(Http::kETag));
+
+  Parser.reset();
+  Feed(WithETag("\"abc\""));
+  TEST_ASSERT_FALSE(Headers.isTruncated(Http::kETag));
+}
+
+void test_skips_interim_responses() {
+  Feed("HTTP/1.1 100 Continue\r\n\r\n"
+       "HTTP/1.1 103 Early Hints\r\nETag: \"early\"\r\n\r\n" + WithETag("\"abc\""));
+
+  TEST_ASSERT_TRUE(Parser.isComplete());
+  TEST_ASSERT_EQUAL_UINT16(200, Parser.getStatusCode());
+  TEST_ASSERT_EQUAL_STRING("OK", Parser.getReasonMessage());
+  TEST_ASSERT_EQUAL_STRING("\"abc\"", Headers.get(Http::kETag));
+  TEST_ASSERT_TRUE(Body == "{}");
+}
+
+void test_skips_interim_response_split() {
+  const std::string response = "HTTP/1.1 100 Continue\r\n\r\n" + WithETag("\"abc\"");
+
+  // A byte at a time, as the header can arrive in any number of segments.
+  size_t i = 0;
+  while(i < response.size() && !Parser.isHeaderComplete()) {
+    i += Parser.parse(&response[i], 1);
+  }
+
+  TEST_ASSERT_TRUE(Parser.isHeaderComplete());
+  TEST_ASSERT_EQUAL_UINT16(200, Parser.getStatusCode());
+  TEST_ASSERT_EQUAL_UINT(response.size() - 2, i);
+}
+
+void test_switching_protocols_is_final() {
+  Feed("HTTP/1.1 101 Switching Protocols\r\nConnection: upgrade\r\n\r\n");
+
+  TEST_ASSERT_TRUE(Parser.isComplete());
+  TEST_ASSERT_EQUAL_UINT16(101, Parser.getStatusCode());
+}
+
+static void FeedWithContentLength(const std::string& contentLength) {
+  Parser.reset();
+  Body.clear();
+  Feed("HTTP/1.1 200 OK\r\nContent-Length: " + contentLength + "\r\n\r\n{}");
+}
+
+void test_content_length_is_digits_only() {
+  FeedWithContentLength("2");
+  TEST_ASSERT_TRUE(Parser.isComplete());
+  TEST_ASSERT_EQUAL_UINT(2, Parser.getContentLength());
+
+  FeedWithContentLength("0");
+  TEST_ASSERT_TRUE(Parser.isComplete());
+  TEST_ASSERT_TRUE(Body.empty());
+
+  const char* const invalid[] = { "-1", "+2", "2abc", "0x2", "2 2", "", "18446744073709551616", "99999999999999999999999" };
+  for(const char* contentLength : invalid) {
+    FeedWithContentLength(contentLength);
+    TEST_ASSERT_TRUE_MESSAGE(Parser.hasError(), contentLength);
+    TEST_ASSERT_TRUE(Body.empty());
+  }
+}
+
+void test_cut_off_content_length_is_an_error() {
+  FeedWithContentLength(std::string(Http::Headers::kMaxValueLength, '0') + "2");
+
+  TEST_ASSERT_TRUE(Headers.isTruncated(Http::kContentLength));
+  TEST_ASSERT_TRUE(Parser.hasError());
+}
+
+int main(int argc, char** argv) {
+  Headers.watch(Http::kContentLength);
+  Headers.watch(Http::kTransferEncoding);
+  Headers.watch(Http::kConnection);
+  Headers.watch(Http::kETag);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_plain_response);
+  RUN_TEST(test_longest_value_fits);
+  RUN_TEST(test_long_value_is_truncated);
+  RUN_TEST(test_trailing_whitespace_is_not_truncation);
+  RUN_TEST(test_reset_clears_truncation);
+  RUN_TEST(test_skips_interim_responses);
+  RUN_TEST(test_skips_interim_response_split);
+  RUN_TEST(test_switching_protocols_is_final);
+  RUN_TEST(test_content_length_is_digits_only);
+  RUN_TEST(test_cut_off_content_length_is_an_error);
+  return UNITY_END();
+}
@@ -0,0 +1,259 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <chrono>
+#include <string>
+#include "http/response_parser.h"
+
+// Replays recorded responses through the response parser split into two
+// segments at every byte offset, and once a byte at a time. Whatever the
+// split, the status, headers and body have to come out the same as when the
+// response arrives in one piece. Throughput and heap use show up in the test
+// output (pio test -e native -v).
+
+unsigned long millis() {
+  return 0;
+}
+
+//
+// - heap accounting
+//
+static size_t Allocations = 0;
+
+void* operator new(size_t size) {
+  void* p = malloc(size);
+  if(p == NULL) {
+    throw std::bad_alloc();
+  }
+
+  Allocations++;
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+
+//
+// - recorded responses
+//
+static const char kForecast[] =
+  "{\"latitude\":52.52,\"longitude\":13.419998,\"generationtime_ms\":0.0629425048828125,"
+  "\"utc_offset_seconds\":7200,\"timezone\":\"Europe/Berlin\",\"timezone_abbreviation\":\"CEST\","
+  "\"elevation\":38.0,\"current_units\":{\"time\":\"iso8601\",\"interval\":\"seconds\","
+  "\"temperature_2m\":\"°C\",\"weather_code\":\"wmo code\"},\"current\":{\"time\":\"2024-04-14T10:45\","
+  "\"interval\":900,\"temperature_2m\":12.3,\"weather_code\":3},\"daily_units\":{\"time\":\"iso8601\","
+  "\"weather_code\":\"wmo code\",\"temperature_2m_max\":\"°C\",\"temperature_2m_min\":\"°C\"},"
+  "\"daily\":{\"time\":[\"2024-04-14\",\"2024-04-15\",\"2024-04-16\",\"2024-04-17\"],"
+  "\"weather_code\":[3,61,80,2],\"temperature_2m_max\":[14.1,11.8,9.6,12.4],"
+  "\"temperature_2m_min\":[5.2,6.9,4.1,3.3]}}";
+
+// nginx, Content-Length and a keep-alive connection.
+static const std::string kPlain = std::string(
+  "HTTP/1.1 200 OK\r\n"
+  "Server: nginx\r\n"
+  "Date: Sun, 14 Apr 2024 08:47:03 GMT\r\n"
+  "Content-Type: application/json; charset=utf-8\r\n"
+  "Content-Length: ") + std::to_string(sizeof(kForecast) - 1) + "\r\n"
+  "Connection: keep-alive\r\n"
+  "ETag: W/\"2f4-18ed7c3a5e8\"\r\n"
+  "Last-Modified: Sun, 14 Apr 2024 08:45:00 GMT\r\n"
+  "\r\n" + kForecast;
+
+// Chunked, with an interim response in front, a chunk extension, hex digits
+// in both cases and a trailer.
+static std::string RecordedChunked() {
+  const std::string body = kForecast;
+
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%X\r\n", (unsigned)body.size() - 0x1a - 0xff);
+
+  return
+    "HTTP/1.1 100 Continue\r\n"
+    "\r\n"
+    "HTTP/1.1 200 OK\r\n"
+    "Date: Sun, 14 Apr 2024 08:47:03 GMT\r\n"
+    "Content-Type: application/json\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "ETag: \"8f37f4ec3f3b2a5d\"\r\n"
+    "\r\n"
+    "1a\r\n" + body.substr(0, 0x1a) + "\r\n"
+    "00fF;name=value\r\n" + body.substr(0x1a, 0xff) + "\r\n" +
+    buffer + body.substr(0x1a + 0xff) + "\r\n"
+    "0\r\n"
+    "X-Checksum: 5d41402abc4b2a76\r\n"
+    "\r\n";
+}
+
+// HTTP/1.0 without a length, the body ends when the server closes.
+static const std::string kClose = std::string(
+  "HTTP/1.0 200 OK\r\n"
+  "Server: BaseHTTP/0.6 Python/3.11.2\r\n"
+  "Content-Type: application/json\r\n"
+  "Connection: close\r\n"
+  "\r\n") + kForecast;
+
+// An empty body that ends with the header.
+static const std::string kNotModified =
+  "HTTP/1.1 304 Not Modified\r\n"
+  "Date: Sun, 14 Apr 2024 08:52:03 GMT\r\n"
+  "ETag: W/\"2f4-18ed7c3a5e8\"\r\n"
+  "Content-Length: 0\r\n"
+  "\r\n";
+
+//
+// - replay
+//
+static const char* const kWatched[] = { Http::kContentLength, Http::kTransferEncoding, Http::kConnection, Http::kETag, Http::kLastModified };
+
+static Http::Headers Headers;
+static Http::ResponseParser Parser(Headers);
+static std::string Body;
+
+// What the caller gets to see of a response.
+static std::string Describe() {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%u %s|%d|%d|%d|%u|", Parser.getStatusCode(), Parser.getReasonMessage(),
+    (int)Parser.getBodyFraming(), Parser.isComplete(), Parser.isPersistent(), (unsigned)Parser.getBodyLength());
+
+  std::string description = buffer;
+  for(const char* name : kWatched) {
+    description += name;
+    description += Headers.has(name) ? "=" : " absent";
+    description += Headers.has(name) ? Headers.get(name) : "";
+    description += Headers.isTruncated(name) ? " (truncated)|" : "|";
+  }
+
+  return description + Body;
+}
+
+// Hands a segment over like Request::onData does, the header first and the
+// rest of the segment to the body.
+static void Receive(const char* data, size_t len, const Http::BodyCallback& onBody) {
+  if(!Parser.isHeaderComplete()) {
+    const size_t consumed = Parser.parse(data, len);
+    data += consumed;
+    len -= consumed;
+
+    if(!Parser.isHeaderComplete()) {
+      return;
+    }
+  }
+
+  Parser.parseBody(data, len, onBody);
+}
+
+static void Run(const std::string& response, const size_t split, const Http::BodyCallback& onBody) {
+  Parser.reset();
+  Body.clear();
+
+  Receive(response.data(), split, onBody);
+  Receive(response.data() + split, response.size() - split, onBody);
+
+  if(Parser.getBodyFraming() == Http::ResponseParser::eUntilClose) {
+    Parser.finish();
+  }
+}
+
+static void Replay(const char* name, const std::string& response, const std::string& body) {
+  const Http::BodyCallback onBody = [](const char* data, size_t len) {
+    Body.append(data, len);
+  };
+
+  Body.reserve(response.size());
+
+  Run(response, response.size(), onBody);
+  const std::string expected = Describe();
+
+  TEST_ASSERT_TRUE(Parser.isComplete());
+  TEST_ASSERT_TRUE(Body == body);
+
+  size_t bytes = 0;
+  size_t allocations = 0;
+  std::chrono::duration<double> elapsed(0);
+
+  for(size_t split = 0; split <= response.size(); split++) {
+    const size_t before = Allocations;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Run(response, split, onBody);
+
+    elapsed += std::chrono::steady_clock::now() - start;
+    allocations += Allocations - before;
+    bytes += response.size();
+
+    if(Describe() != expected) {
+      char message[64];
+      snprintf(message, sizeof(message), "%s differs when split at %u", name, (unsigned)split);
+      TEST_FAIL_MESSAGE(message);
+    }
+  }
+
+  // A byte at a time, the worst AsyncTCP can do.
+  Parser.reset();
+  Body.clear();
+
+  for(size_t i = 0; i < response.size(); i++) {
+    Receive(&response[i], 1, onBody);
+  }
+  if(Parser.getBodyFraming() == Http::ResponseParser::eUntilClose) {
+    Parser.finish();
+  }
+
+  TEST_ASSERT_TRUE(Describe() == expected);
+
+  // The parser works in its own buffers, the body goes into one reserved
+  // up front.
+  TEST_ASSERT_EQUAL_UINT(0, allocations);
+
+  char buffer[128];
+  snprintf(buffer, sizeof(buffer), "%-14s %5u bytes  %5u splits  %7.1f MB/s  %u allocs",
+    name, (unsigned)response.size(), (unsigned)response.size() + 1, bytes / elapsed.count() / 1e6, (unsigned)allocations);
+  TEST_MESSAGE(buffer);
+}
+
+void setUp() {
+  Parser.reset();
+  Body.clear();
+}
+
+void tearDown() {
+}
+
+void test_content_length() {
+  Replay("content-length", kPlain, kForecast);
+}
+
+void test_chunked() {
+  Replay("chunked", RecordedChunked(), kForecast);
+}
+
+void test_close_delimited() {
+  Replay("close", kClose, kForecast);
+}
+
+void test_not_modified() {
+  Replay("not-modified", kNotModified, "");
+}
+
+int main(int argc, char** argv) {
+  for(const char* name : kWatched) {
+    Headers.watch(name);
+  }
+
+  UNITY_BEGIN();
+  RUN_TEST(test_content_length);
+  RUN_TEST(test_chunked);
+  RUN_TEST(test_close_delimited);
+  RUN_TEST(test_not_modified);
+  return UNITY_END();
+}
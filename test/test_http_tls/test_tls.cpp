@@ -0,0 +1,177 @@
+#include <unity.h>
+#include <string>
+#include "http/http_client.h"
+
+unsigned long millis() {
+  return 0;
+}
+
+// Speaks the handshake of the mbedTLS stand-in, then answers the request
+// and closes the connection.
+class Server : public AsyncTcpPeer {
+  public:
+    uint32_t handshakes = 0;
+    uint32_t resumptions = 0;
+    bool refuseHandshake = false;
+
+    bool accept(AsyncClient*, const char*, const uint16_t) override {
+      this->state = eHello;
+      this->received.clear();
+      return true;
+    }
+
+    void receive(AsyncClient* client, const char* data, size_t len) override {
+      this->received.append(data, len);
+
+      if(this->state == eHello && this->received.size() >= TlsStandIn::kClientHelloLength) {
+        uint32_t offered = 0;
+        memcpy(&offered, this->received.data() + 1, sizeof(offered));
+        this->received.erase(0, TlsStandIn::kClientHelloLength);
+
+        if(this->refuseHandshake) {
+          client->deliver("XXXXX", TlsStandIn::kServerHelloLength);
+          this->state = eDone;
+          return;
+        }
+
+        this->handshakes++;
+
+        uint32_t session = ++this->lastSession;
+        if(offered != 0 && offered == this->knownSession) {
+          this->resumptions++;
+          session = offered;
+        }
+        this->knownSession = session;
+
+        char serverHello[TlsStandIn::kServerHelloLength] = { 'S' };
+        memcpy(serverHello + 1, &session, sizeof(session));
+        client->deliver(serverHello, sizeof(serverHello));
+
+        this->state = eFinished;
+      }
+
+      if(this->state == eFinished && this->received.size() >= TlsStandIn::kFinishedLength) {
+        this->received.erase(0, TlsStandIn::kFinishedLength);
+        this->state = eRequest;
+      }
+
+      if(this->state == eRequest && this->received.find("\r\n\r\n") != std::string::npos) {
+        static const char kResponse[] = "HTTP/1.1 200 OK\r\nContent-Length: 13\r\nConnection: close\r\n\r\n{\"temp\":12.3}";
+
+        client->deliver(kResponse, sizeof(kResponse) - 1);
+        client->hangUp();
+
+        this->state = eDone;
+      }
+    }
+
+  private:
+    enum State {
+      eHello,
+      eFinished,
+      eRequest,
+      eDone
+    };
+
+    State state = eHello;
+    std::string received;
+    uint32_t lastSession = 0;
+    uint32_t knownSession = 0;
+};
+
+static const char kUri[] = "https://api.example.com/v1/forecast";
+
+static Server* server = NULL;
+static Http::Client* client = NULL;
+
+static int Completed = 0;
+static bool Succeeded = false;
+static std::string Body;
+
+static void Get() {
+  Completed = 0;
+  Succeeded = false;
+  Body.clear();
+
+  client->get(kUri, [](bool success, const Http::Response& response) {
+    Completed++;
+    Succeeded = success && response.statusCode == 200;
+    Body = response.body.c_str();
+  });
+
+  AsyncTcp::Run();
+}
+
+void setUp() {
+  AsyncTcp::Reset();
+
+  server = new Server();
+  AsyncTcp::Peer() = server;
+
+  client = new Http::Client();
+}
+
+void tearDown() {
+  delete client;
+  delete server;
+}
+
+void test_request_after_handshake() {
+  Get();
+
+  TEST_ASSERT_EQUAL_INT(1, Completed);
+  TEST_ASSERT_TRUE(Succeeded);
+  TEST_ASSERT_EQUAL_STRING("{\"temp\":12.3}", Body.c_str());
+  TEST_ASSERT_EQUAL_UINT32(1, client->getTlsStatistics().handshakes);
+}
+
+void test_handshake_larger_than_send_window() {
+  // The ClientHello goes out in three parts, the rest follows on the acks.
+  AsyncTcp::Window() = 200;
+  TEST_ASSERT_TRUE(TlsStandIn::kClientHelloLength > 2 * AsyncTcp::Window());
+
+  Get();
+
+  TEST_ASSERT_EQUAL_INT(1, Completed);
+  TEST_ASSERT_TRUE(Succeeded);
+  TEST_ASSERT_EQUAL_STRING("{\"temp\":12.3}", Body.c_str());
+}
+
+void test_resumes_session() {
+  Get();
+  Get();
+
+  TEST_ASSERT_TRUE(Succeeded);
+  TEST_ASSERT_EQUAL_UINT32(2, server->handshakes);
+  TEST_ASSERT_EQUAL_UINT32(1, server->resumptions);
+
+  const Http::TlsSessionCache::Statistics& statistics = client->getTlsStatistics();
+  TEST_ASSERT_EQUAL_UINT32(2, statistics.handshakes);
+  TEST_ASSERT_EQUAL_UINT32(1, statistics.resumptions);
+}
+
+void test_failed_handshake() {
+  Get();
+
+  server->refuseHandshake = true;
+  Get();
+
+  TEST_ASSERT_EQUAL_INT(1, Completed);
+  TEST_ASSERT_FALSE(Succeeded);
+
+  // The session the server choked on isn't offered again.
+  server->refuseHandshake = false;
+  Get();
+
+  TEST_ASSERT_TRUE(Succeeded);
+  TEST_ASSERT_EQUAL_UINT32(0, server->resumptions);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_request_after_handshake);
+  RUN_TEST(test_handshake_larger_than_send_window);
+  RUN_TEST(test_resumes_session);
+  RUN_TEST(test_failed_handshake);
+  return UNITY_END();
+}
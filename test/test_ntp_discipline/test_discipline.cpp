@@ -0,0 +1,180 @@
+#include <unity.h>
+#include <stdlib.h>
+#include "ntp/discipline.h"
+
+using namespace Ntp;
+
+unsigned long millis() {
+  return 0;
+}
+
+// 2023-11-14 22:13:20 UTC, in microseconds.
+static const int64_t kEpoch = 1700000000LL * 1000000LL;
+static const int64_t kSecond = 1000000LL;
+
+// A clock set at 5 s after boot, at kEpoch.
+static void SetClock(Discipline& discipline) {
+  discipline.update(5 * kSecond, kEpoch - 5 * kSecond);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_unset_clock() {
+  Discipline discipline;
+
+  TEST_ASSERT_FALSE(discipline.isSet());
+  TEST_ASSERT_EQUAL_INT64(1234, discipline.toTime(1234));
+}
+
+void test_first_update_steps() {
+  Discipline discipline;
+
+  TEST_ASSERT_TRUE(discipline.update(5 * kSecond, kEpoch - 5 * kSecond));
+  TEST_ASSERT_TRUE(discipline.isSet());
+  TEST_ASSERT_EQUAL_INT64(kEpoch, discipline.toTime(5 * kSecond));
+  TEST_ASSERT_EQUAL_INT64(kEpoch + kSecond, discipline.toTime(6 * kSecond));
+  TEST_ASSERT_EQUAL_UINT32(1UL << Discipline::kMinPoll, discipline.getPollInterval());
+}
+
+void test_large_offset_steps() {
+  Discipline discipline;
+  SetClock(discipline);
+
+  const int64_t local = 69 * kSecond;
+  const int64_t before = discipline.toTime(local);
+
+  TEST_ASSERT_TRUE(discipline.update(local, Discipline::kStepThreshold + 1000));
+  TEST_ASSERT_EQUAL_INT64(before + Discipline::kStepThreshold + 1000, discipline.toTime(local));
+}
+
+void test_small_offset_slews() {
+  Discipline discipline;
+  SetClock(discipline);
+
+  const int64_t local = 69 * kSecond;
+  const int64_t before = discipline.toTime(local);
+
+  // 10 ms behind: not stepped, the clock doesn't jump.
+  TEST_ASSERT_FALSE(discipline.update(local, 10000));
+  TEST_ASSERT_EQUAL_INT64(before, discipline.toTime(local));
+
+  // Worked off at 500 ppm at most, so 5 ms after 10 s and all of it after
+  // 20 s. The frequency picked up a little of the offset as well.
+  const int64_t frequencyError = 200;
+  TEST_ASSERT_INT64_WITHIN(frequencyError, before + 10 * kSecond + 5000, discipline.toTime(local + 10 * kSecond));
+  TEST_ASSERT_INT64_WITHIN(frequencyError, before + 40 * kSecond + 10000, discipline.toTime(local + 40 * kSecond));
+}
+
+void test_negative_slew_is_monotonic() {
+  Discipline discipline;
+  SetClock(discipline);
+
+  const int64_t local = 69 * kSecond;
+  TEST_ASSERT_FALSE(discipline.update(local, -100000));
+
+  // Slowing down by 100 ms still never runs the clock backwards.
+  int64_t previous = discipline.toTime(local);
+  for(int64_t t = local + 1000; t < local + 300 * kSecond; t += 1000) {
+    const int64_t time = discipline.toTime(t);
+
+    TEST_ASSERT_TRUE(time > previous);
+    previous = time;
+  }
+
+  // All of it worked off, on top of the frequency it picked up.
+  const int64_t elapsed = 300 * kSecond - 1000;
+  const int64_t expected = discipline.toTime(local) + elapsed + (int64_t)(elapsed * discipline.getFrequency() * 1e-6) - 100000;
+  TEST_ASSERT_INT64_WITHIN(10, expected, previous);
+}
+
+void test_poll_interval_adapts() {
+  Discipline discipline;
+  SetClock(discipline);
+
+  int64_t local = 5 * kSecond;
+
+  // Small offsets lengthen the interval up to the maximum.
+  for(int i = 0; i < 64; i++) {
+    local += discipline.getPollInterval() * kSecond;
+    discipline.update(local, 100);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(1UL << Discipline::kMaxPoll, discipline.getPollInterval());
+
+  // A larger one shortens it again, a step starts over.
+  local += discipline.getPollInterval() * kSecond;
+  discipline.update(local, Discipline::kStableOffset * 2);
+  TEST_ASSERT_EQUAL_UINT32(1UL << (Discipline::kMaxPoll - 1), discipline.getPollInterval());
+
+  local += discipline.getPollInterval() * kSecond;
+  discipline.update(local, Discipline::kStepThreshold * 2);
+  TEST_ASSERT_EQUAL_UINT32(1UL << Discipline::kMinPoll, discipline.getPollInterval());
+}
+
+// Five simulated days with a crystal that runs 40 ppm fast and 1 ms of
+// noise on every measured offset, polled whenever the discipline asks. The
+// frequency error has to be found and, once it was, the clock has to stay
+// within a few milliseconds without ever stepping again or running
+// backwards.
+void test_drifting_oscillator() {
+  static const double kDrift = 40e-6;
+  static const int64_t kDay = 86400LL * kSecond;
+
+  Discipline discipline;
+  srand(1);
+
+  int64_t nextUpdate = 5 * kSecond;
+  int64_t previous = 0;
+  int64_t maxError = 0;
+  int steps = 0;
+
+  for(int64_t local = 5 * kSecond; local < 5 * kDay; local += kSecond) {
+    const int64_t trueTime = kEpoch + (int64_t)(local / (1.0 + kDrift));
+    const int64_t time = discipline.toTime(local);
+
+    if(discipline.isSet()) {
+      TEST_ASSERT_TRUE(time > previous);
+    }
+    previous = time;
+
+    if(local >= nextUpdate) {
+      const int64_t noise = (rand() % 2001) - 1000;
+
+      if(discipline.update(local, trueTime - time + noise)) {
+        steps++;
+      }
+
+      nextUpdate = local + discipline.getPollInterval() * kSecond;
+    }
+
+    if(local > kDay) {
+      const int64_t error = llabs(discipline.toTime(local) - trueTime);
+      if(error > maxError) {
+        maxError = error;
+      }
+    }
+  }
+
+  TEST_ASSERT_EQUAL_INT(1, steps);
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, -40.0f, discipline.getFrequency());
+  TEST_ASSERT_EQUAL_UINT32(1UL << Discipline::kMaxPoll, discipline.getPollInterval());
+  TEST_ASSERT_LESS_OR_EQUAL(5000, maxError);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_unset_clock);
+  RUN_TEST(test_first_update_steps);
+  RUN_TEST(test_large_offset_steps);
+  RUN_TEST(test_small_offset_slews);
+  RUN_TEST(test_negative_slew_is_monotonic);
+  RUN_TEST(test_poll_interval_adapts);
+  RUN_TEST(test_drifting_oscillator);
+
+  return UNITY_END();
+}
@@ -0,0 +1,224 @@
+#include <unity.h>
+#include <string.h>
+#include "ntp/packet.h"
+
+using namespace Ntp;
+
+unsigned long millis() {
+  return 0;
+}
+
+// 2023-11-14 22:13:20 UTC, in microseconds.
+static const int64_t kNow = 1700000000LL * 1000000LL;
+
+static Timestamp Originate;
+static uint8_t Data[Packet::kSize];
+
+// A valid stratum 2 reply to a request sent at t1, received by the server
+// at t2 and answered at t3.
+static void BuildReply(const int64_t t1, const int64_t t2, const int64_t t3) {
+  Originate = Packet::FromUnixMicroseconds(t1);
+  Packet::BuildRequest(Data, Originate);
+
+  // The request's transmit time comes back as originate.
+  memcpy(Data + 24, Data + 40, 8);
+
+  const Timestamp receive = Packet::FromUnixMicroseconds(t2);
+  const Timestamp transmit = Packet::FromUnixMicroseconds(t3);
+  const uint32_t words[] = { receive.seconds, receive.fraction, transmit.seconds, transmit.fraction };
+  for(size_t i = 0; i < 4; i++) {
+    uint8_t* p = Data + 32 + i * 4;
+    p[0] = words[i] >> 24;
+    p[1] = words[i] >> 16;
+    p[2] = words[i] >> 8;
+    p[3] = words[i];
+  }
+
+  Data[0] = (0 << 6) | (4 << 3) | 4;
+  Data[1] = 2;
+  // Root delay 0.5 s and dispersion 0.25 s, 16.16 fixed point.
+  Data[6] = 0x80;
+  Data[10] = 0x40;
+  memcpy(Data + 12, "GPS\0", 4);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_request_header() {
+  Packet::BuildRequest(Data, Packet::FromUnixMicroseconds(kNow));
+
+  TEST_ASSERT_EQUAL_UINT(0x23, Data[0]); // leap 0, version 4, client
+  TEST_ASSERT_EQUAL_UINT(0, Data[1]);
+}
+
+void test_timestamp_round_trip() {
+  const int64_t times[] = { kNow, kNow + 1, kNow + 999999, 0, 2085978495999999LL /* 2036-02-07 06:28:15 */, 2085978496000000LL };
+
+  for(size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+    TEST_ASSERT_EQUAL_INT64(times[i], Packet::ToUnixMicroseconds(Packet::FromUnixMicroseconds(times[i])));
+  }
+}
+
+void test_era_rollover() {
+  // The first second of era 1 (2036-02-07 06:28:16 UTC).
+  const Timestamp timestamp = { 0, 0 };
+
+  TEST_ASSERT_EQUAL_INT64(2085978496LL * 1000000LL, Packet::ToUnixMicroseconds(timestamp));
+}
+
+void test_fraction_resolution() {
+  // Half a second and one microsecond.
+  const Timestamp half = { 0xE0000000, 0x80000000 };
+  const Timestamp micro = { 0xE0000000, 4295 };
+
+  TEST_ASSERT_EQUAL_INT64(500000, Packet::ToUnixMicroseconds(half) % 1000000);
+  TEST_ASSERT_EQUAL_INT64(1, Packet::ToUnixMicroseconds(micro) % 1000000);
+}
+
+void test_sample_symmetric() {
+  // Server 2.5 s ahead, 20 ms each way, 1 ms spent in the server.
+  const int64_t t1 = kNow;
+  const int64_t t2 = t1 + 2500000 + 20000;
+  const int64_t t3 = t2 + 1000;
+  const int64_t t4 = t1 + 41000;
+
+  const Sample sample = Packet::ComputeSample(t1, t2, t3, t4);
+
+  TEST_ASSERT_EQUAL_INT64(2500000, sample.offset);
+  TEST_ASSERT_EQUAL_INT64(40000, sample.delay);
+}
+
+void test_sample_behind() {
+  // Server 300 ms behind, 5 ms out and 15 ms back: the asymmetry shows up
+  // as half its difference in the offset.
+  const int64_t t1 = kNow;
+  const int64_t t2 = t1 - 300000 + 5000;
+  const int64_t t3 = t2;
+  const int64_t t4 = t1 + 20000;
+
+  const Sample sample = Packet::ComputeSample(t1, t2, t3, t4);
+
+  TEST_ASSERT_EQUAL_INT64(-305000, sample.offset);
+  TEST_ASSERT_EQUAL_INT64(20000, sample.delay);
+}
+
+void test_sample_negative_delay() {
+  // A coarse server clock can make the round trip look negative.
+  const Sample sample = Packet::ComputeSample(kNow, kNow + 500, kNow + 1500, kNow + 800);
+
+  TEST_ASSERT_EQUAL_INT64(0, sample.delay);
+}
+
+void test_parse_valid() {
+  BuildReply(kNow, kNow + 2520000, kNow + 2521000);
+
+  Reply reply;
+  TEST_ASSERT_EQUAL(Packet::eValid, Packet::Parse(Data, sizeof(Data), Originate, reply));
+  TEST_ASSERT_EQUAL_UINT(2, reply.stratum);
+  TEST_ASSERT_EQUAL_UINT32(500000, reply.rootDelay);
+  TEST_ASSERT_EQUAL_UINT32(250000, reply.rootDispersion);
+  TEST_ASSERT_EQUAL_STRING("GPS", reply.referenceId);
+
+  const Sample sample = Packet::ComputeSample(kNow,
+                                              Packet::ToUnixMicroseconds(reply.receive),
+                                              Packet::ToUnixMicroseconds(reply.transmit),
+                                              kNow + 41000);
+
+  TEST_ASSERT_EQUAL_INT64(2500000, sample.offset);
+  TEST_ASSERT_EQUAL_INT64(40000, sample.delay);
+}
+
+void test_parse_too_short() {
+  BuildReply(kNow, kNow, kNow);
+
+  Reply reply;
+  TEST_ASSERT_EQUAL(Packet::eTooShort, Packet::Parse(Data, Packet::kSize - 1, Originate, reply));
+  TEST_ASSERT_EQUAL(Packet::eTooShort, Packet::Parse(NULL, Packet::kSize, Originate, reply));
+}
+
+void test_parse_not_server() {
+  BuildReply(kNow, kNow, kNow);
+  Data[0] = (4 << 3) | 3;
+
+  Reply reply;
+  TEST_ASSERT_EQUAL(Packet::eNotServer, Packet::Parse(Data, sizeof(Data), Originate, reply));
+}
+
+void test_parse_bad_version() {
+  BuildReply(kNow, kNow, kNow);
+  Data[0] = (5 << 3) | 4;
+
+  Reply reply;
+  TEST_ASSERT_EQUAL(Packet::eBadVersion, Packet::Parse(Data, sizeof(Data), Originate, reply));
+}
+
+void test_parse_kiss_of_death() {
+  BuildReply(kNow, kNow, kNow);
+  Data[1] = 0;
+  memcpy(Data + 12, "RATE", 4);
+
+  Reply reply;
+  TEST_ASSERT_EQUAL(Packet::eKissOfDeath, Packet::Parse(Data, sizeof(Data), Originate, reply));
+  TEST_ASSERT_EQUAL_STRING("RATE", reply.referenceId);
+}
+
+void test_parse_unsynchronized() {
+  BuildReply(kNow, kNow, kNow);
+  Data[0] |= 3 << 6;
+
+  Reply reply;
+  TEST_ASSERT_EQUAL(Packet::eUnsynchronized, Packet::Parse(Data, sizeof(Data), Originate, reply));
+}
+
+void test_parse_bad_stratum() {
+  BuildReply(kNow, kNow, kNow);
+  Data[1] = 16;
+
+  Reply reply;
+  TEST_ASSERT_EQUAL(Packet::eBadStratum, Packet::Parse(Data, sizeof(Data), Originate, reply));
+}
+
+void test_parse_bogus() {
+  BuildReply(kNow, kNow, kNow);
+
+  // An answer to an earlier request.
+  const Timestamp other = Packet::FromUnixMicroseconds(kNow - 1);
+
+  Reply reply;
+  TEST_ASSERT_EQUAL(Packet::eBogus, Packet::Parse(Data, sizeof(Data), other, reply));
+}
+
+void test_parse_no_transmit_time() {
+  BuildReply(kNow, kNow, kNow);
+  memset(Data + 40, 0, 8);
+
+  Reply reply;
+  TEST_ASSERT_EQUAL(Packet::eNoTransmitTime, Packet::Parse(Data, sizeof(Data), Originate, reply));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_request_header);
+  RUN_TEST(test_timestamp_round_trip);
+  RUN_TEST(test_era_rollover);
+  RUN_TEST(test_fraction_resolution);
+  RUN_TEST(test_sample_symmetric);
+  RUN_TEST(test_sample_behind);
+  RUN_TEST(test_sample_negative_delay);
+  RUN_TEST(test_parse_valid);
+  RUN_TEST(test_parse_too_short);
+  RUN_TEST(test_parse_not_server);
+  RUN_TEST(test_parse_bad_version);
+  RUN_TEST(test_parse_kiss_of_death);
+  RUN_TEST(test_parse_unsynchronized);
+  RUN_TEST(test_parse_bad_stratum);
+  RUN_TEST(test_parse_bogus);
+  RUN_TEST(test_parse_no_transmit_time);
+
+  return UNITY_END();
+}
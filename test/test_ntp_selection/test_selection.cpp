@@ -0,0 +1,180 @@
+#include <unity.h>
+#include "ntp/selection.h"
+
+using namespace Ntp;
+
+unsigned long millis() {
+  return 0;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_no_candidates() {
+  int64_t offset = 42;
+
+  TEST_ASSERT_EQUAL_UINT(0, Selection::Select(NULL, 0, NULL, offset));
+}
+
+void test_single_candidate() {
+  const Candidate candidates[] = { { 1700000000000000LL, 20000 } };
+  bool survivors[1];
+  int64_t offset = 0;
+
+  TEST_ASSERT_EQUAL_UINT(1, Selection::Select(candidates, 1, survivors, offset));
+  TEST_ASSERT_TRUE(survivors[0]);
+  TEST_ASSERT_EQUAL_INT64(1700000000000000LL, offset);
+}
+
+void test_one_falseticker() {
+  const Candidate candidates[] = { { 1000, 500 }, { 1200, 400 }, { 900, 300 }, { 50000, 200 } };
+  bool survivors[4];
+  int64_t offset = 0;
+
+  TEST_ASSERT_EQUAL_UINT(3, Selection::Select(candidates, 4, survivors, offset));
+  TEST_ASSERT_TRUE(survivors[0]);
+  TEST_ASSERT_TRUE(survivors[1]);
+  TEST_ASSERT_TRUE(survivors[2]);
+  TEST_ASSERT_FALSE(survivors[3]);
+  TEST_ASSERT_INT64_WITHIN(300, 1000, offset);
+}
+
+void test_falseticker_at_first_sync() {
+  // Offsets of the whole time since 1970 keep their precision.
+  const Candidate candidates[] = { { 1700000000000000LL, 20000 }, { 1700000000005000LL, 10000 }, { 1700000000300000LL, 10000 } };
+  bool survivors[3];
+  int64_t offset = 0;
+
+  TEST_ASSERT_EQUAL_UINT(2, Selection::Select(candidates, 3, survivors, offset));
+  TEST_ASSERT_FALSE(survivors[2]);
+  TEST_ASSERT_INT64_WITHIN(1, 1700000000003333LL, offset);
+}
+
+void test_no_majority() {
+  const Candidate candidates[] = { { 1000, 100 }, { 5000, 100 } };
+  bool survivors[2];
+  int64_t offset = 0;
+
+  TEST_ASSERT_EQUAL_UINT(0, Selection::Select(candidates, 2, survivors, offset));
+  TEST_ASSERT_FALSE(survivors[0]);
+  TEST_ASSERT_FALSE(survivors[1]);
+}
+
+void test_two_falsetickers_of_four() {
+  // Two that agree aren't a majority of four.
+  const Candidate candidates[] = { { 0, 100 }, { 50, 100 }, { 100000, 100 }, { -100000, 100 } };
+  int64_t offset = 0;
+
+  TEST_ASSERT_EQUAL_UINT(0, Selection::Select(candidates, 4, NULL, offset));
+}
+
+void test_touching_intervals() {
+  const Candidate candidates[] = { { 0, 100 }, { 200, 100 } };
+  int64_t offset = 0;
+
+  TEST_ASSERT_EQUAL_UINT(2, Selection::Select(candidates, 2, NULL, offset));
+  TEST_ASSERT_EQUAL_INT64(100, offset);
+}
+
+void test_weighted_by_distance() {
+  // The closer server counts four times as much.
+  const Candidate candidates[] = { { 0, 1000 }, { 500, 4000 } };
+  int64_t offset = 0;
+
+  TEST_ASSERT_EQUAL_UINT(2, Selection::Select(candidates, 2, NULL, offset));
+  TEST_ASSERT_INT64_WITHIN(1, 100, offset);
+}
+
+// Simulated rounds against four servers: replies get lost, one server
+// sometimes runs half a second off, and the measured offsets are skewed by
+// asymmetric paths (at most half the round trip, which the distance
+// covers). Whenever the truechimers are a majority the result has to be
+// within their distance of the true offset and the falseticker left out.
+static uint32_t Random() {
+  static uint32_t state = 12345;
+  state = state * 1664525 + 1013904223;
+  return state >> 8;
+}
+
+void test_simulated_servers() {
+  static const size_t kServers = 4;
+  static const int kRounds = 1000;
+
+  int selected = 0;
+
+  for(int round = 0; round < kRounds; round++) {
+    const int64_t trueOffset = (int64_t)(Random() % 2000000) - 1000000;
+    const bool hasFalseticker = Random() % 4 == 0;
+
+    Candidate candidates[kServers];
+    bool isFalseticker[kServers];
+    size_t n = 0;
+    size_t truechimers = 0;
+
+    for(size_t i = 0; i < kServers; i++) {
+      // One in ten replies is lost.
+      if(Random() % 10 == 0) {
+        continue;
+      }
+
+      const int64_t delay = 5000 + Random() % 75000;
+      const int64_t asymmetry = (int64_t)(Random() % (delay + 1)) - delay / 2;
+
+      candidates[n].offset = trueOffset + asymmetry;
+      candidates[n].distance = delay / 2 + 1000;
+      isFalseticker[n] = hasFalseticker && i == 0;
+
+      if(isFalseticker[n]) {
+        candidates[n].offset += 500000;
+      } else {
+        truechimers++;
+      }
+
+      n++;
+    }
+
+    bool survivors[kServers];
+    int64_t offset = 0;
+    const size_t numberOfSurvivors = Selection::Select(candidates, n, survivors, offset);
+
+    if(n == 0 || 2 * truechimers <= n) {
+      continue;
+    }
+
+    TEST_ASSERT_TRUE(numberOfSurvivors >= truechimers);
+
+    int64_t maxDistance = 0;
+    for(size_t i = 0; i < n; i++) {
+      TEST_ASSERT_TRUE(survivors[i] != isFalseticker[i]);
+
+      if(survivors[i] && candidates[i].distance > maxDistance) {
+        maxDistance = candidates[i].distance;
+      }
+    }
+
+    TEST_ASSERT_INT64_WITHIN(maxDistance, trueOffset, offset);
+    selected++;
+  }
+
+  // Most rounds have a majority.
+  TEST_ASSERT_GREATER_OR_EQUAL(kRounds * 3 / 4, selected);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_no_candidates);
+  RUN_TEST(test_single_candidate);
+  RUN_TEST(test_one_falseticker);
+  RUN_TEST(test_falseticker_at_first_sync);
+  RUN_TEST(test_no_majority);
+  RUN_TEST(test_two_falsetickers_of_four);
+  RUN_TEST(test_touching_intervals);
+  RUN_TEST(test_weighted_by_distance);
+  RUN_TEST(test_simulated_servers);
+
+  return UNITY_END();
+}
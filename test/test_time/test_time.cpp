@@ -0,0 +1,149 @@
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include <TimeLib.h>
+
+// 2023-11-14 22:13:20 UTC.
+static const time_t kEpoch = 1700000000;
+
+static unsigned long Millis = 0;
+
+unsigned long millis() {
+  return Millis;
+}
+
+static time_t SyncTime = 0;
+static int Syncs = 0;
+
+static time_t SyncProvider() {
+  Syncs++;
+  return SyncTime;
+}
+
+void setUp() {
+  setSyncProvider(NULL);
+  Millis = 1000;
+  setTime(kEpoch);
+}
+
+void tearDown() {
+}
+
+void test_counts_seconds() {
+  Millis += 999;
+  TEST_ASSERT_EQUAL_INT64(kEpoch, now());
+
+  Millis += 1;
+  TEST_ASSERT_EQUAL_INT64(kEpoch + 1, now());
+}
+
+void test_catches_up_at_once() {
+  // Ten days and a bit without a call.
+  Millis += 10UL * SECS_PER_DAY * 1000 + 1500;
+  TEST_ASSERT_EQUAL_INT64(kEpoch + 10 * SECS_PER_DAY + 1, now());
+
+  // The half second left over isn't lost.
+  Millis += 500;
+  TEST_ASSERT_EQUAL_INT64(kEpoch + 10 * SECS_PER_DAY + 2, now());
+}
+
+void test_millis_wrap() {
+  Millis = 0xFFFFFF00UL;
+  setTime(kEpoch);
+
+  Millis += 5000;
+  TEST_ASSERT_EQUAL_INT64(kEpoch + 5, now());
+}
+
+void test_cached_elements() {
+  Millis += 3723UL * 1000;
+
+  // 2023-11-14 23:15:23, a Tuesday.
+  TEST_ASSERT_EQUAL_INT(23, hour());
+  TEST_ASSERT_EQUAL_INT(15, minute());
+  TEST_ASSERT_EQUAL_INT(23, second());
+  TEST_ASSERT_EQUAL_INT(14, day());
+  TEST_ASSERT_EQUAL_INT(3, weekday());
+  TEST_ASSERT_EQUAL_INT(11, month());
+  TEST_ASSERT_EQUAL_INT(2023, year());
+
+  // Another time refreshes the cache.
+  TEST_ASSERT_EQUAL_INT(0, hour(kEpoch + 2 * SECS_PER_HOUR));
+  TEST_ASSERT_EQUAL_INT(15, day(kEpoch + 2 * SECS_PER_HOUR));
+}
+
+void test_set_time_elements() {
+  // Doesn't disturb the cache of the accessors.
+  TEST_ASSERT_EQUAL_INT(22, hour(kEpoch));
+
+  setTime(12, 30, 15, 1, 6, 2024);
+
+  TEST_ASSERT_EQUAL_INT64(1717245015, now());
+  TEST_ASSERT_EQUAL_INT(22, hour(kEpoch));
+  TEST_ASSERT_EQUAL_INT(12, hour());
+}
+
+void test_sync_provider() {
+  SyncTime = kEpoch + 100;
+  Syncs = 0;
+
+  setSyncInterval(60);
+  setSyncProvider(SyncProvider);
+
+  TEST_ASSERT_EQUAL_INT(1, Syncs);
+  TEST_ASSERT_EQUAL_INT64(kEpoch + 100, now());
+
+  // Counts on its own until the interval passed.
+  Millis += 59UL * 1000;
+  TEST_ASSERT_EQUAL_INT64(kEpoch + 159, now());
+  TEST_ASSERT_EQUAL_INT(1, Syncs);
+
+  SyncTime = kEpoch + 200;
+  Millis += 1000;
+  TEST_ASSERT_EQUAL_INT64(kEpoch + 200, now());
+  TEST_ASSERT_EQUAL_INT(2, Syncs);
+
+  // A failed sync keeps counting and tries again an interval later.
+  SyncTime = 0;
+  Millis += 60UL * 1000;
+  TEST_ASSERT_EQUAL_INT64(kEpoch + 260, now());
+  TEST_ASSERT_EQUAL_INT(3, Syncs);
+  TEST_ASSERT_EQUAL_INT(timeNeedsSync, timeStatus());
+}
+
+// What the display does every frame, the time advancing a millisecond per
+// call. Reports the rate, it's no pass/fail criterion.
+void test_display_path_rate() {
+  static const int kCalls = 1000000;
+
+  int checksum = 0;
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  for(int i = 0; i < kCalls; i++) {
+    Millis++;
+    checksum += hour() + minute() + second();
+  }
+
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  char message[64];
+  snprintf(message, sizeof(message), "%.0f display updates per second", kCalls / seconds);
+  TEST_MESSAGE(message);
+
+  TEST_ASSERT_EQUAL_INT64(kEpoch + kCalls / 1000, now());
+  TEST_ASSERT_TRUE(checksum > 0);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_counts_seconds);
+  RUN_TEST(test_catches_up_at_once);
+  RUN_TEST(test_millis_wrap);
+  RUN_TEST(test_cached_elements);
+  RUN_TEST(test_set_time_elements);
+  RUN_TEST(test_sync_provider);
+  RUN_TEST(test_display_path_rate);
+
+  return UNITY_END();
+}
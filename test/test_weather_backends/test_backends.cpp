@@ -0,0 +1,373 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <map>
+#include <string>
+#include <vector>
+#include "openmeteo/client.h"
+#include "wunderground/client.h"
+
+// Runs the weather backends against a local stand-in of their APIs that
+// serves recorded responses over the AsyncTCP stand-in. Checks what each
+// projection picks out of its API's documents and reports bytes downloaded,
+// parse time and peak heap per backend (pio test -e native -v).
+
+static unsigned long Now = 0;
+
+unsigned long millis() {
+  return Now;
+}
+
+//
+// - heap accounting
+//
+static size_t HeapInUse = 0;
+static size_t PeakHeap = 0;
+
+// The size is kept in front of the block, two words keep the alignment.
+void* operator new(size_t size) {
+  size_t* block = static_cast<size_t*>(malloc(size + 2 * sizeof(size_t)));
+  if(block == NULL) {
+    throw std::bad_alloc();
+  }
+
+  block[0] = size;
+
+  HeapInUse += size;
+  if(HeapInUse > PeakHeap) {
+    PeakHeap = HeapInUse;
+  }
+
+  return block + 2;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  if(p == NULL) {
+    return;
+  }
+
+  size_t* block = static_cast<size_t*>(p) - 2;
+  HeapInUse -= block[0];
+  free(block);
+}
+
+void operator delete[](void* p) noexcept {
+  operator delete(p);
+}
+
+//
+// - recorded responses
+//
+static const char kOpenMeteoCurrent[] =
+  "{\"latitude\":52.52,\"longitude\":13.419998,\"generationtime_ms\":0.06103515625,\"utc_offset_seconds\":0,"
+  "\"timezone\":\"GMT\",\"timezone_abbreviation\":\"GMT\",\"elevation\":38.0,\"current_weather_units\":"
+  "{\"time\":\"iso8601\",\"interval\":\"seconds\",\"temperature\":\"°C\",\"windspeed\":\"km/h\","
+  "\"winddirection\":\"°\",\"is_day\":\"\",\"weathercode\":\"wmo code\"},\"current_weather\":"
+  "{\"time\":\"2024-04-14T20:45\",\"interval\":900,\"temperature\":12.3,\"windspeed\":14.8,"
+  "\"winddirection\":221,\"is_day\":0,\"weathercode\":61}}";
+
+static const char kOpenMeteoDaily[] =
+  "{\"latitude\":52.52,\"longitude\":13.419998,\"generationtime_ms\":0.0629425048828125,\"utc_offset_seconds\":7200,"
+  "\"timezone\":\"Europe/Berlin\",\"timezone_abbreviation\":\"CEST\",\"elevation\":38.0,\"daily_units\":"
+  "{\"time\":\"iso8601\",\"weathercode\":\"wmo code\",\"temperature_2m_max\":\"°C\",\"temperature_2m_min\":\"°C\"},"
+  "\"daily\":{\"time\":[\"2024-04-14\",\"2024-04-15\",\"2024-04-16\",\"2024-04-17\"],\"weathercode\":[3,61,95,0],"
+  "\"temperature_2m_max\":[14.1,11.8,9.6,12.4],\"temperature_2m_min\":[5.2,6.9,4.1,-3.3]}}";
+
+static const char kWundergroundConditions[] =
+  "{\n  \"response\": {\n  \"version\":\"0.1\",\n"
+  "  \"termsofService\":\"http://www.wunderground.com/weather/api/d/terms.html\",\n"
+  "  \"features\": {\n  \"conditions\": 1\n  }\n  }\n"
+  "  ,\t\"current_observation\": {\n"
+  "    \"image\": {\n    \"url\":\"http://icons.wxug.com/graphics/wu2/logo_130x80.png\",\n"
+  "    \"title\":\"Weather Underground\",\n    \"link\":\"http://www.wunderground.com\"\n    },\n"
+  "    \"display_location\": {\n    \"full\":\"Amsterdam, Netherlands\",\n    \"city\":\"Amsterdam\",\n"
+  "    \"country\":\"NL\",\n    \"latitude\":\"52.310000\",\n    \"longitude\":\"4.770000\"\n    },\n"
+  "    \"station_id\":\"EHAM\",\n"
+  "    \"observation_time\":\"Last Updated on April 14, 10:25 PM CEST\",\n"
+  "    \"weather\":\"Mostly Cloudy\",\n"
+  "    \"temperature_string\":\"54 F (12 C)\",\n"
+  "    \"temp_f\":54,\n"
+  "    \"temp_c\":12.3,\n"
+  "    \"relative_humidity\":\"82%\",\n"
+  "    \"wind_string\":\"From the SW at 9 MPH\",\n"
+  "    \"icon\":\"mostlycloudy\",\n"
+  "    \"icon_url\":\"http://icons.wxug.com/i/c/k/nt_mostlycloudy.gif\",\n"
+  "    \"forecast_url\":\"http://www.wunderground.com/global/stations/06240.html\"\n"
+  "  }\n}\n";
+
+static std::string RecordedWundergroundForecast() {
+  static const char* const kWeekdays[] = { "Saturday", "Sunday", "Monday", "Tuesday" };
+  static const char* const kIcons[] = { "chancerain", "partlycloudy", "rain", "clear" };
+
+  std::string body = "{\n  \"response\": {\n  \"version\":\"0.1\",\n  \"features\": {\n  \"forecast\": 1\n  }\n  }\n"
+                     "  ,\n  \"forecast\":{\n    \"txt_forecast\": {\n    \"date\":\"10:00 AM CEST\",\n    \"forecastday\": [\n";
+
+  char buffer[768];
+
+  for(int i = 0; i < 8; i++) {
+    snprintf(buffer, sizeof(buffer),
+      "    %s{\n    \"period\":%d,\n    \"icon\":\"%s\",\n    \"title\":\"%s%s\",\n"
+      "    \"fcttext_metric\":\"Periods of rain. High 14C. Winds SW at 15 to 30 km/h. Chance of rain 70%%.\"\n    }\n",
+      i > 0 ? "," : "", i, kIcons[i / 2], kWeekdays[i / 2], i % 2 ? " Night" : "");
+    body += buffer;
+  }
+
+  body += "    ]\n    },\n    \"simpleforecast\": {\n    \"forecastday\": [\n";
+
+  for(int i = 0; i < 4; i++) {
+    snprintf(buffer, sizeof(buffer),
+      "    %s{\"date\":{\n  \"epoch\":\"%d\",\n  \"weekday\":\"%s\",\n  \"tz_long\":\"Europe/Amsterdam\"\n},\n"
+      "    \"period\":%d,\n    \"high\": {\n    \"fahrenheit\":\"%d\",\n    \"celsius\":\"%d\"\n    },\n"
+      "    \"low\": {\n    \"fahrenheit\":\"%d\",\n    \"celsius\":\"%d\"\n    },\n"
+      "    \"conditions\":\"Chance of Rain\",\n    \"icon\":\"%s\",\n    \"pop\":%d\n    }\n",
+      i > 0 ? "," : "", 1523725200 + i * 86400, kWeekdays[i], i + 1,
+      (14 + i) * 9 / 5 + 32, 14 + i, (5 + i) * 9 / 5 + 32, 5 + i, kIcons[i], i * 10);
+    body += buffer;
+  }
+
+  return body + "    ]\n    }\n  }\n}\n";
+}
+
+//
+// - API stand-in
+//
+// Serves a recorded body per path prefix with an ETag, and 304 Not Modified
+// when the request carries that ETag. Responses go out in full TCP segments
+// and the connection is closed after each, as the APIs do.
+class RecordedApi : public AsyncTcpPeer {
+  public:
+    struct Route {
+      std::string host;
+      std::string path;
+      std::string body;
+      std::string eTag;
+    };
+
+    std::vector<Route> routes;
+    std::vector<std::string> requests;
+    uint32_t notModified = 0;
+
+    bool accept(AsyncClient* client, const char*, const uint16_t) override {
+      this->received[client].clear();
+      return true;
+    }
+
+    void receive(AsyncClient* client, const char* data, size_t len) override {
+      std::string& request = this->received[client];
+      request.append(data, len);
+
+      if(request.find("\r\n\r\n") == std::string::npos) {
+        return;
+      }
+
+      // GET <path> HTTP/1.1
+      const size_t pathEnd = request.find(' ', 4);
+      const std::string path = request.substr(4, pathEnd - 4);
+      const std::string host = Header(request, "Host");
+      const std::string ifNoneMatch = Header(request, "If-None-Match");
+      this->requests.push_back(host + path);
+      request.clear();
+
+      const Route* route = NULL;
+      for(size_t i = 0; i < this->routes.size(); i++) {
+        if(this->routes[i].host == host && path.compare(0, this->routes[i].path.size(), this->routes[i].path) == 0) {
+          route = &this->routes[i];
+        }
+      }
+
+      std::string response;
+      if(route == NULL) {
+        response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+      } else if(ifNoneMatch == route->eTag) {
+        this->notModified++;
+        response = "HTTP/1.1 304 Not Modified\r\nETag: " + route->eTag + "\r\nConnection: close\r\n\r\n";
+      } else {
+        response = "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nETag: " + route->eTag +
+                   "\r\nContent-Length: " + std::to_string(route->body.size()) + "\r\nConnection: close\r\n\r\n" + route->body;
+      }
+
+      for(size_t offset = 0; offset < response.size(); offset += kSegment) {
+        client->deliver(response.data() + offset, std::min(kSegment, response.size() - offset));
+      }
+      client->hangUp();
+    }
+
+  private:
+    // Largest TCP segment seen from the APIs, the MSS of an Ethernet path.
+    static const size_t kSegment = 1460;
+
+    std::map<AsyncClient*, std::string> received;
+
+    static std::string Header(const std::string& request, const std::string& name) {
+      const size_t start = request.find("\r\n" + name + ": ");
+      if(start == std::string::npos) {
+        return "";
+      }
+
+      const size_t valueStart = start + name.size() + 4;
+      return request.substr(valueStart, request.find("\r\n", valueStart) - valueStart);
+    }
+};
+
+static RecordedApi* Api = NULL;
+
+struct Update {
+  bool success;
+  Weather::FetchedFeeds fetched;
+  Weather::Conditions conditions;
+  size_t peakHeap;
+};
+
+static Update Run(Weather::Provider& provider) {
+  Update update = { false, 0, Weather::Conditions(), 0 };
+  bool isDone = false;
+
+  const size_t heapInUse = HeapInUse;
+  PeakHeap = HeapInUse;
+
+  provider.update([&update, &isDone](bool success, Weather::FetchedFeeds fetched, Weather::Conditions& conditions) {
+    update.success = success;
+    update.fetched = fetched;
+    update.conditions = conditions;
+    isDone = true;
+  });
+
+  AsyncTcp::Run();
+
+  update.peakHeap = PeakHeap - heapInUse;
+
+  TEST_ASSERT_TRUE(isDone);
+  return update;
+}
+
+static void Report(const char* name, const Weather::Provider& provider, const Update& update) {
+  char buffer[160];
+
+  for(int feed = Weather::eObservation; feed < Weather::eNumberOfFeeds; feed++) {
+    const Weather::FeedStatistics& statistics = provider.getStatistics(static_cast<Weather::Feed>(feed));
+
+    snprintf(buffer, sizeof(buffer), "%-12s %-11s %5u bytes  parse %6u us  %3u fetches  %u not modified",
+      name, feed == Weather::eObservation ? "observation" : "forecast",
+      (unsigned)statistics.bytes, (unsigned)statistics.parseTime, (unsigned)statistics.fetches, (unsigned)statistics.notModified);
+    TEST_MESSAGE(buffer);
+  }
+
+  snprintf(buffer, sizeof(buffer), "%-12s peak heap %u bytes (first update)", name, (unsigned)update.peakHeap);
+  TEST_MESSAGE(buffer);
+}
+
+void setUp() {
+  Now = 0;
+  AsyncTcp::Reset();
+
+  Api = new RecordedApi();
+  Api->routes.push_back({ "api.open-meteo.com", "/v1/forecast?latitude=52.52&longitude=13.41&current_weather=true", kOpenMeteoCurrent, "\"om-current-1\"" });
+  Api->routes.push_back({ "api.open-meteo.com", "/v1/forecast?latitude=52.52&longitude=13.41&daily=", kOpenMeteoDaily, "\"om-daily-1\"" });
+  Api->routes.push_back({ "api.wunderground.com", "/api/0123456789abcdef/conditions/", kWundergroundConditions, "\"wu-conditions-1\"" });
+  Api->routes.push_back({ "api.wunderground.com", "/api/0123456789abcdef/forecast/", RecordedWundergroundForecast(), "\"wu-forecast-1\"" });
+  AsyncTcp::Peer() = Api;
+}
+
+void tearDown() {
+  delete Api;
+}
+
+void test_open_meteo() {
+  openmeteo::Client client("52.52", "13.41", "Berlin");
+  const Update update = Run(client);
+
+  TEST_ASSERT_TRUE(update.success);
+  TEST_ASSERT_EQUAL(3, update.fetched);
+  TEST_ASSERT_EQUAL_UINT(2, Api->requests.size());
+
+  // The name stands in for the city, is_day 0 picks the night icon.
+  const Weather::Conditions::Observation& observation = update.conditions.getCurrentObservation();
+  TEST_ASSERT_EQUAL_STRING("Berlin", observation.city);
+  TEST_ASSERT_EQUAL_STRING("Light rain", observation.title);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 12.3, observation.temperature);
+  TEST_ASSERT_EQUAL(Weather::eNightRain, observation.icon);
+
+  static const char* const kTitles[] = { "Sunday", "Monday", "Tuesday", "Wednesday" };
+  static const Weather::Icon kIcons[] = { Weather::eCloudy, Weather::eRain, Weather::eTstorms, Weather::eClear };
+  static const float kHighs[] = { 14.1f, 11.8f, 9.6f, 12.4f };
+  static const float kLows[] = { 5.2f, 6.9f, 4.1f, -3.3f };
+
+  TEST_ASSERT_TRUE(update.conditions.hasForecasts());
+  for(size_t i = 0; i < Weather::Conditions::kMaxForecasts; i++) {
+    const Weather::Conditions::Forecast& forecast = update.conditions.getForecastForPeriod(i);
+
+    TEST_ASSERT_EQUAL_STRING(kTitles[i], forecast.title);
+    TEST_ASSERT_EQUAL(kIcons[i], forecast.icon);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, kHighs[i], forecast.highTemperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, kLows[i], forecast.lowTemperature);
+  }
+
+  Report("open-meteo", client, update);
+}
+
+void test_wunderground() {
+  wunderground::Client client("0123456789abcdef", "NL", "NL", "Amsterdam");
+  const Update update = Run(client);
+
+  TEST_ASSERT_TRUE(update.success);
+  TEST_ASSERT_EQUAL(3, update.fetched);
+  TEST_ASSERT_EQUAL_STRING("api.wunderground.com/api/0123456789abcdef/conditions/lang:NL/q/NL/Amsterdam.json", Api->requests[0].c_str());
+
+  // The icon URL has the night prefix the icon name lacks.
+  const Weather::Conditions::Observation& observation = update.conditions.getCurrentObservation();
+  TEST_ASSERT_EQUAL_STRING("Amsterdam", observation.city);
+  TEST_ASSERT_EQUAL_STRING("Mostly Cloudy", observation.title);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 12.3, observation.temperature);
+  TEST_ASSERT_EQUAL(Weather::eNightMostlyCloudy, observation.icon);
+
+  TEST_ASSERT_EQUAL_STRING("Saturday", update.conditions.getForecastForPeriod(0).title);
+  TEST_ASSERT_EQUAL(Weather::eChanceRain, update.conditions.getForecastForPeriod(0).icon);
+  TEST_ASSERT_EQUAL_STRING("Tuesday", update.conditions.getForecastForPeriod(3).title);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 17, update.conditions.getForecastForPeriod(3).highTemperature);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 8, update.conditions.getForecastForPeriod(3).lowTemperature);
+
+  Report("wunderground", client, update);
+}
+
+void test_not_modified_keeps_conditions() {
+  openmeteo::Client client("52.52", "13.41", "Berlin");
+  Run(client);
+
+  // Both feeds stale, the API has nothing new.
+  Now += Weather::StreamingProvider::kDefaultForecastTtl;
+  const Update update = Run(client);
+
+  TEST_ASSERT_TRUE(update.success);
+  TEST_ASSERT_EQUAL(3, update.fetched);
+  TEST_ASSERT_EQUAL_UINT32(2, Api->notModified);
+  TEST_ASSERT_EQUAL_UINT32(1, client.getStatistics(Weather::eObservation).notModified);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 12.3, update.conditions.getCurrentObservation().temperature);
+  TEST_ASSERT_EQUAL_STRING("Sunday", update.conditions.getForecastForPeriod(0).title);
+}
+
+void test_missing_feed_fails() {
+  Api->routes.pop_back();
+
+  wunderground::Client client("0123456789abcdef", "NL", "NL", "Amsterdam");
+  const Update update = Run(client);
+
+  // The observation made it, the forecast will be retried.
+  TEST_ASSERT_FALSE(update.success);
+  TEST_ASSERT_EQUAL(1 << Weather::eObservation, update.fetched);
+  TEST_ASSERT_EQUAL_UINT32(1, client.getStatistics(Weather::eForecast).failures);
+  TEST_ASSERT_EQUAL_STRING("Amsterdam", update.conditions.getCurrentObservation().city);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_open_meteo);
+  RUN_TEST(test_wunderground);
+  RUN_TEST(test_not_modified_keeps_conditions);
+  RUN_TEST(test_missing_feed_fails);
+  return UNITY_END();
+}
@@ -0,0 +1,167 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <chrono>
+#include "weather/icon.h"
+
+// Checks the perfect hash lookup of Weather::IconFromName against every
+// icon name and measures it against comparing the name with each known
+// icon, as it was done before. The report shows up in the test output
+// (pio test -e native -v).
+
+unsigned long millis() {
+  return 0;
+}
+
+//
+// - heap accounting
+//
+static size_t Allocations = 0;
+
+void* operator new(size_t size) {
+  void* p = malloc(size);
+  if(p == NULL) {
+    throw std::bad_alloc();
+  }
+
+  Allocations++;
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+
+//
+// - icon names
+//
+// Day icons in the order of Weather::Icon, night icons are the same with
+// the nt_ prefix.
+static const char* const kDayNames[] = {
+  "chanceflurries", "chancerain", "chancesleet", "chancesnow", "chancetstorms", "clear", "cloudy", "flurries",
+  "fog", "hazy", "mostlycloudy", "mostlysunny", "partlycloudy", "partlysunny", "sleet", "rain", "snow", "sunny",
+  "tstorms"
+};
+static const size_t kNumberOfDayNames = sizeof(kDayNames) / sizeof(kDayNames[0]);
+
+static char Names[Weather::eNumberOfIcons][24];
+
+// The lookup before the hash: strip the night prefix and compare with every
+// day name.
+static Weather::Icon LinearIconFromName(const char* name, const size_t len) {
+  static const char kNightPrefix[] = "nt_";
+
+  const size_t prefixLength = strlen(kNightPrefix);
+  const bool isNight = len > prefixLength && strncmp(name, kNightPrefix, prefixLength) == 0;
+  const char* dayName = isNight ? name + prefixLength : name;
+  const size_t dayLength = isNight ? len - prefixLength : len;
+
+  for(size_t i = 0; i < kNumberOfDayNames; i++) {
+    if(strlen(kDayNames[i]) == dayLength && strncmp(kDayNames[i], dayName, dayLength) == 0) {
+      return static_cast<Weather::Icon>((isNight ? Weather::eNightChanceFlurries : Weather::eChanceFlurries) + i);
+    }
+  }
+
+  return Weather::eUnknownIcon;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_every_name() {
+  TEST_ASSERT_EQUAL_UINT(Weather::eNumberOfIcons - 1, 2 * kNumberOfDayNames);
+
+  for(size_t icon = 1; icon < Weather::eNumberOfIcons; icon++) {
+    TEST_ASSERT_EQUAL_MESSAGE(icon, Weather::IconFromName(Names[icon], strlen(Names[icon])), Names[icon]);
+    TEST_ASSERT_EQUAL_MESSAGE(icon, LinearIconFromName(Names[icon], strlen(Names[icon])), Names[icon]);
+  }
+}
+
+void test_unknown_names() {
+  static const char* const kUnknown[] = { "", "nt_", "nt_nt_clear", "Clear", "clear ", "clea", "clearer", "unknown", "day_clear" };
+
+  for(const char* name : kUnknown) {
+    TEST_ASSERT_EQUAL_MESSAGE(Weather::eUnknownIcon, Weather::IconFromName(name, strlen(name)), name);
+  }
+}
+
+void test_not_nul_terminated() {
+  // As the projection hands out values, only len bytes count.
+  static const char kName[] = "rainy";
+
+  TEST_ASSERT_EQUAL(Weather::eRain, Weather::IconFromName(kName, 4));
+  TEST_ASSERT_EQUAL(Weather::eUnknownIcon, Weather::IconFromName(kName, 5));
+  TEST_ASSERT_EQUAL(Weather::eUnknownIcon, Weather::IconFromName(kName, 3));
+}
+
+typedef Weather::Icon (*Lookup)(const char* name, const size_t len);
+
+static double Measure(const Lookup lookup, size_t& allocations) {
+  static const int kRounds = 100000;
+
+  size_t lengths[Weather::eNumberOfIcons];
+  for(size_t icon = 0; icon < Weather::eNumberOfIcons; icon++) {
+    lengths[icon] = strlen(Names[icon]);
+  }
+
+  const size_t before = Allocations;
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  uint32_t sum = 0;
+  for(int round = 0; round < kRounds; round++) {
+    for(size_t icon = 1; icon < Weather::eNumberOfIcons; icon++) {
+      sum += lookup(Names[icon], lengths[icon]);
+    }
+  }
+
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  allocations = Allocations - before;
+
+  TEST_ASSERT_EQUAL_UINT32(kRounds * (Weather::eNumberOfIcons - 1) * Weather::eNumberOfIcons / 2, sum);
+
+  return elapsed.count() / (kRounds * (Weather::eNumberOfIcons - 1));
+}
+
+void test_benchmark() {
+  size_t hashAllocations = 0;
+  size_t linearAllocations = 0;
+
+  const double hash = Measure(&Weather::IconFromName, hashAllocations);
+  const double linear = Measure(&LinearIconFromName, linearAllocations);
+
+  TEST_ASSERT_EQUAL_UINT(0, hashAllocations);
+
+  char buffer[128];
+  snprintf(buffer, sizeof(buffer), "perfect hash %6.1f ns/lookup  %u allocs", hash, (unsigned)hashAllocations);
+  TEST_MESSAGE(buffer);
+  snprintf(buffer, sizeof(buffer), "linear scan  %6.1f ns/lookup  %u allocs", linear, (unsigned)linearAllocations);
+  TEST_MESSAGE(buffer);
+}
+
+int main(int argc, char** argv) {
+  Names[Weather::eUnknownIcon][0] = '\0';
+  for(size_t i = 0; i < kNumberOfDayNames; i++) {
+    snprintf(Names[Weather::eChanceFlurries + i], sizeof(Names[0]), "%s", kDayNames[i]);
+    snprintf(Names[Weather::eNightChanceFlurries + i], sizeof(Names[0]), "nt_%s", kDayNames[i]);
+  }
+
+  UNITY_BEGIN();
+  RUN_TEST(test_every_name);
+  RUN_TEST(test_unknown_names);
+  RUN_TEST(test_not_nul_terminated);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
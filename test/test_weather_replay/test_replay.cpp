@@ -0,0 +1,640 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <JsonStreamingParser.h>
+// ArduinoJson 5 as on the device, on std types instead of the Arduino ones.
+#define ARDUINOJSON_ENABLE_ARDUINO_STRING 0
+#define ARDUINOJSON_ENABLE_ARDUINO_STREAM 0
+#define ARDUINOJSON_ENABLE_PROGMEM 0
+#include <ArduinoJson.h>
+#include "http/response_parser.h"
+#include "json/projection.h"
+#include "weather/conditions.h"
+
+// Replays recorded Weather Underground responses the way the station gets
+// them from AsyncTCP: framed as plain, chunked or close-delimited bodies and
+// split at random segment boundaries. Each stage is timed and its heap use
+// counted, the report shows up in the test output (pio test -e native -v).
+// The "dom" stage is the client before the projection, for comparison.
+
+unsigned long millis() {
+  return 0;
+}
+
+//
+// - heap accounting
+//
+static size_t Allocations = 0;
+static size_t HeapInUse = 0;
+static size_t PeakHeap = 0;
+
+// The size is kept in front of the block, two words keep the alignment.
+void* operator new(size_t size) {
+  size_t* block = static_cast<size_t*>(malloc(size + 2 * sizeof(size_t)));
+  if(block == NULL) {
+    throw std::bad_alloc();
+  }
+
+  block[0] = size;
+
+  Allocations++;
+  HeapInUse += size;
+  if(HeapInUse > PeakHeap) {
+    PeakHeap = HeapInUse;
+  }
+
+  return block + 2;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  if(p == NULL) {
+    return;
+  }
+
+  size_t* block = static_cast<size_t*>(p) - 2;
+  HeapInUse -= block[0];
+  free(block);
+}
+
+void operator delete[](void* p) noexcept {
+  operator delete(p);
+}
+
+//
+// - recorded responses
+//
+static const char kConditions[] =
+  "{\n"
+  "  \"response\": {\n"
+  "  \"version\":\"0.1\",\n"
+  "  \"termsofService\":\"http://www.wunderground.com/weather/api/d/terms.html\",\n"
+  "  \"features\": {\n"
+  "  \"conditions\": 1\n"
+  "  }\n"
+  "  }\n"
+  "  ,\t\"current_observation\": {\n"
+  "    \"image\": {\n"
+  "    \"url\":\"http://icons.wxug.com/graphics/wu2/logo_130x80.png\",\n"
+  "    \"title\":\"Weather Underground\",\n"
+  "    \"link\":\"http://www.wunderground.com\"\n"
+  "    },\n"
+  "    \"display_location\": {\n"
+  "    \"full\":\"Amsterdam, Netherlands\",\n"
+  "    \"city\":\"Amsterdam\",\n"
+  "    \"state\":\"NH\",\n"
+  "    \"state_name\":\"Netherlands\",\n"
+  "    \"country\":\"NL\",\n"
+  "    \"country_iso3166\":\"NL\",\n"
+  "    \"zip\":\"00000\",\n"
+  "    \"magic\":\"1\",\n"
+  "    \"wmo\":\"06240\",\n"
+  "    \"latitude\":\"52.310000\",\n"
+  "    \"longitude\":\"4.770000\",\n"
+  "    \"elevation\":\"-3.0\"\n"
+  "    },\n"
+  "    \"observation_location\": {\n"
+  "    \"full\":\"Amsterdam, \",\n"
+  "    \"city\":\"Amsterdam\",\n"
+  "    \"state\":\"\",\n"
+  "    \"country\":\"NL\",\n"
+  "    \"country_iso3166\":\"NL\",\n"
+  "    \"latitude\":\"52.31\",\n"
+  "    \"longitude\":\"4.79\",\n"
+  "    \"elevation\":\"-11 ft\"\n"
+  "    },\n"
+  "    \"estimated\": {\n"
+  "    },\n"
+  "    \"station_id\":\"EHAM\",\n"
+  "    \"observation_time\":\"Last Updated on April 14, 10:25 AM CEST\",\n"
+  "    \"observation_time_rfc822\":\"Sat, 14 Apr 2018 10:25:00 +0200\",\n"
+  "    \"observation_epoch\":\"1523694300\",\n"
+  "    \"local_time_rfc822\":\"Sat, 14 Apr 2018 10:41:12 +0200\",\n"
+  "    \"local_epoch\":\"1523695272\",\n"
+  "    \"local_tz_short\":\"CEST\",\n"
+  "    \"local_tz_long\":\"Europe/Amsterdam\",\n"
+  "    \"local_tz_offset\":\"+0200\",\n"
+  "    \"weather\":\"Mostly Cloudy\",\n"
+  "    \"temperature_string\":\"54 F (12 C)\",\n"
+  "    \"temp_f\":54,\n"
+  "    \"temp_c\":12.3,\n"
+  "    \"relative_humidity\":\"82%\",\n"
+  "    \"wind_string\":\"From the SW at 9 MPH\",\n"
+  "    \"wind_dir\":\"SW\",\n"
+  "    \"wind_degrees\":220,\n"
+  "    \"wind_mph\":9,\n"
+  "    \"wind_gust_mph\":0,\n"
+  "    \"wind_kph\":15,\n"
+  "    \"wind_gust_kph\":0,\n"
+  "    \"pressure_mb\":\"1012\",\n"
+  "    \"pressure_in\":\"29.89\",\n"
+  "    \"pressure_trend\":\"0\",\n"
+  "    \"dewpoint_string\":\"48 F (9 C)\",\n"
+  "    \"dewpoint_f\":48,\n"
+  "    \"dewpoint_c\":9,\n"
+  "    \"heat_index_string\":\"NA\",\n"
+  "    \"windchill_string\":\"NA\",\n"
+  "    \"feelslike_string\":\"54 F (12 C)\",\n"
+  "    \"visibility_km\":\"10.0\",\n"
+  "    \"solarradiation\":\"--\",\n"
+  "    \"UV\":\"2\",\"precip_1hr_string\":\"-9999.00 in (-9999.00 mm)\",\n"
+  "    \"precip_today_string\":\"0.00 in (0 mm)\",\n"
+  "    \"icon\":\"mostlycloudy\",\n"
+  "    \"icon_url\":\"http://icons.wxug.com/i/c/k/mostlycloudy.gif\",\n"
+  "    \"forecast_url\":\"http://www.wunderground.com/global/stations/06240.html\",\n"
+  "    \"ob_url\":\"http://www.wunderground.com/cgi-bin/findweather/getForecast?query=52.31,4.79\"\n"
+  "  }\n"
+  "}\n";
+
+static const char* const kWeekdays[] = { "Saturday", "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday" };
+static const char* const kIcons[] = { "chancerain", "partlycloudy", "rain", "clear", "cloudy", "mostlysunny", "tstorms" };
+
+// A forecast (4 days) or forecast10day response, with the text forecast
+// that comes along and is skipped by the projection.
+static std::string RecordedForecast(const int days) {
+  std::string body = "{\n  \"response\": {\n  \"version\":\"0.1\",\n  \"features\": {\n  \"forecast";
+  body += days > 4 ? "10day" : "";
+  body += "\": 1\n  }\n  }\n  ,\n  \"forecast\":{\n    \"txt_forecast\": {\n    \"date\":\"10:00 AM CEST\",\n    \"forecastday\": [\n";
+
+  char buffer[1024];
+
+  for(int i = 0; i < 2 * days; i++) {
+    snprintf(buffer, sizeof(buffer),
+      "    %s{\n    \"period\":%d,\n    \"icon\":\"%s\",\n    \"icon_url\":\"http://icons.wxug.com/i/c/k/%s%s.gif\",\n"
+      "    \"title\":\"%s%s\",\n    \"fcttext\":\"Cloudy with periods of rain. High around 14C. Winds SW at 15 to 25 km/h.\",\n"
+      "    \"fcttext_metric\":\"Periods of rain. High 14C. Winds SW at 15 to 30 km/h. Chance of rain 70%%.\",\n"
+      "    \"pop\":\"%d\"\n    }\n",
+      i > 0 ? "," : "", i, kIcons[i % 7], i % 2 ? "nt_" : "", kIcons[i % 7],
+      kWeekdays[(i / 2) % 7], i % 2 ? " Night" : "", (i * 10) % 100);
+    body += buffer;
+  }
+
+  body += "    ]\n    },\n    \"simpleforecast\": {\n    \"forecastday\": [\n";
+
+  for(int i = 0; i < days; i++) {
+    snprintf(buffer, sizeof(buffer),
+      "    %s{\"date\":{\n  \"epoch\":\"%d\",\n  \"pretty\":\"7:00 PM CEST on April %d, 2018\",\n  \"day\":%d,\n  \"month\":4,\n"
+      "  \"year\":2018,\n  \"yday\":%d,\n  \"hour\":19,\n  \"min\":\"00\",\n  \"sec\":0,\n  \"isdst\":\"1\",\n"
+      "  \"monthname\":\"April\",\n  \"weekday_short\":\"%.3s\",\n  \"weekday\":\"%s\",\n  \"ampm\":\"PM\",\n"
+      "  \"tz_short\":\"CEST\",\n  \"tz_long\":\"Europe/Amsterdam\"\n},\n"
+      "    \"period\":%d,\n    \"high\": {\n    \"fahrenheit\":\"%d\",\n    \"celsius\":\"%d\"\n    },\n"
+      "    \"low\": {\n    \"fahrenheit\":\"%d\",\n    \"celsius\":\"%d\"\n    },\n"
+      "    \"conditions\":\"Chance of Rain\",\n    \"icon\":\"%s\",\n"
+      "    \"icon_url\":\"http://icons.wxug.com/i/c/k/%s.gif\",\n    \"skyicon\":\"\",\n    \"pop\":%d,\n"
+      "    \"qpf_allday\": {\n    \"in\": 0.12,\n    \"mm\": 3\n    },\n"
+      "    \"avehumidity\": 78,\n    \"maxhumidity\": 0,\n    \"minhumidity\": 0\n    }\n",
+      i > 0 ? "," : "", 1523725200 + i * 86400, 14 + i, 14 + i, 103 + i,
+      kWeekdays[i % 7], kWeekdays[i % 7], i + 1,
+      (14 + i) * 9 / 5 + 32, 14 + i, (5 + i) * 9 / 5 + 32, 5 + i,
+      kIcons[i % 7], kIcons[i % 7], (i * 10) % 100);
+    body += buffer;
+  }
+
+  body += "    ]\n    }\n  }\n}\n";
+
+  return body;
+}
+
+//
+// - framing and segments
+//
+enum Framing {
+  ePlain,
+  eChunked,
+  eClose
+};
+
+static const char* const kFramingNames[] = { "plain", "chunked", "close" };
+
+// Largest TCP segment seen from the API, the MSS of an Ethernet path.
+static const size_t kMaxSegment = 1460;
+static const int kReplays = 200;
+
+static uint32_t Seed = 1;
+
+static uint32_t Random() {
+  Seed = Seed * 1103515245 + 12345;
+  return (Seed >> 8) & 0xFFFFFF;
+}
+
+static std::string Frame(const std::string& body, const Framing framing) {
+  std::string response =
+    "HTTP/1.1 200 OK\r\n"
+    "Server: Apache/2.2.15 (CentOS)\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "Access-Control-Allow-Credentials: true\r\n"
+    "X-CreationTime: 0.047\r\n"
+    "ETag: \"8f37f4ec3f3b2a5d3b0a6f3f1b7c2e11\"\r\n"
+    "Last-Modified: Sat, 14 Apr 2018 08:41:12 GMT\r\n"
+    "Content-Type: application/json; charset=UTF-8\r\n"
+    "Expires: Sat, 14 Apr 2018 08:42:12 GMT\r\n"
+    "Cache-Control: max-age=0, no-cache\r\n"
+    "Date: Sat, 14 Apr 2018 08:41:12 GMT\r\n";
+
+  char buffer[32];
+
+  switch(framing) {
+    case ePlain:
+      snprintf(buffer, sizeof(buffer), "Content-Length: %u\r\n", (unsigned)body.size());
+      response += buffer;
+      response += "Connection: keep-alive\r\n\r\n";
+      response += body;
+      break;
+    case eChunked:
+      response += "Transfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n";
+      for(size_t offset = 0; offset < body.size();) {
+        const size_t size = std::min<size_t>(1 + Random() % 2048, body.size() - offset);
+        snprintf(buffer, sizeof(buffer), "%x\r\n", (unsigned)size);
+        response += buffer;
+        response.append(body, offset, size);
+        response += "\r\n";
+        offset += size;
+      }
+      response += "0\r\n\r\n";
+      break;
+    case eClose:
+      response += "Connection: close\r\n\r\n";
+      response += body;
+      break;
+  }
+
+  return response;
+}
+
+// Segment sizes as they'd come out of AsyncTCP, from a single byte up to a
+// full segment.
+static void Split(const size_t length, std::vector<size_t>& segments) {
+  segments.clear();
+
+  for(size_t offset = 0; offset < length;) {
+    const size_t size = std::min<size_t>(1 + Random() % kMaxSegment, length - offset);
+    segments.push_back(size);
+    offset += size;
+  }
+}
+
+//
+// - stages
+//
+struct Stage {
+  const char* name;
+  std::vector<double> times;
+  size_t allocations;
+  size_t peakHeap;
+};
+
+class Measurement {
+  public:
+    Measurement(Stage& stage) : stage(stage), allocations(Allocations), heapInUse(HeapInUse) {
+      PeakHeap = HeapInUse;
+      this->start = std::chrono::steady_clock::now();
+    }
+
+    ~Measurement() {
+      const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - this->start;
+
+      this->stage.times.push_back(elapsed.count());
+      this->stage.allocations += Allocations - this->allocations;
+      this->stage.peakHeap = std::max(this->stage.peakHeap, PeakHeap - this->heapInUse);
+    }
+
+  private:
+    Stage& stage;
+    size_t allocations;
+    size_t heapInUse;
+    std::chrono::steady_clock::time_point start;
+};
+
+static void Report(const char* corpus, const Framing framing, const Stage& stage) {
+  std::vector<double> times = stage.times;
+  std::sort(times.begin(), times.end());
+
+  const size_t n = times.size();
+  char buffer[192];
+
+  snprintf(buffer, sizeof(buffer), "%-16s %-7s %-10s p50 %7.1f us  p90 %7.1f us  p99 %7.1f us  max %7.1f us  %6.1f allocs  peak %5u bytes",
+    corpus, kFramingNames[framing], stage.name,
+    times[n / 2], times[n * 9 / 10], times[n * 99 / 100], times[n - 1],
+    (double)stage.allocations / n, (unsigned)stage.peakHeap);
+
+  TEST_MESSAGE(buffer);
+}
+
+// Same paths as wunderground::Client.
+enum Field {
+  eCity,
+  eTemperature,
+  eTitle,
+  eIcon,
+  eForecastTitle,
+  eForecastHighTemperature,
+  eForecastLowTemperature,
+  eForecastIcon
+};
+
+static const Json::Projection::Field kFields[] = {
+  { "current_observation.display_location.city", eCity },
+  { "current_observation.temp_c", eTemperature },
+  { "current_observation.weather", eTitle },
+  { "current_observation.icon", eIcon },
+  { "forecast.simpleforecast.forecastday[*].date.weekday", eForecastTitle },
+  { "forecast.simpleforecast.forecastday[*].high.celsius", eForecastHighTemperature },
+  { "forecast.simpleforecast.forecastday[*].low.celsius", eForecastLowTemperature },
+  { "forecast.simpleforecast.forecastday[*].icon", eForecastIcon }
+};
+
+static void OnValue(Weather::Conditions& conditions, const uint8_t field, const size_t index, const char* value) {
+  switch(field) {
+    case eCity:
+      conditions.setCity(value);
+      break;
+    case eTemperature:
+      conditions.setTemperature(atof(value));
+      break;
+    case eTitle:
+      conditions.setTitle(value);
+      break;
+    case eIcon:
+      conditions.setIcon(Weather::IconFromName(value, strlen(value)));
+      break;
+    case eForecastTitle:
+      conditions.setForecastTitle(index, value);
+      break;
+    case eForecastHighTemperature:
+      conditions.setForecastHighTemperature(index, atof(value));
+      break;
+    case eForecastLowTemperature:
+      conditions.setForecastLowTemperature(index, atof(value));
+      break;
+    case eForecastIcon:
+      conditions.setForecastIcon(index, Weather::IconFromName(value, strlen(value)));
+      break;
+    default:
+      break;
+  }
+}
+
+// The client before the projection: the complete body in one buffer,
+// parsed into a DynamicJsonBuffer and read from there.
+static const size_t kDomBufferSize = 32 * 1024;
+
+// Routes the JSON buffer through the counted operator new.
+struct CountedAllocator {
+  void* allocate(size_t size) {
+    return operator new(size);
+  }
+
+  void deallocate(void* p) {
+    operator delete(p);
+  }
+};
+
+typedef ArduinoJson::Internals::DynamicJsonBufferBase<CountedAllocator> CountedJsonBuffer;
+
+static void ParseDocument(const std::string& received, Weather::Conditions& conditions) {
+  // Http::Response::body, collected before parsing.
+  const std::string body(received);
+
+  CountedJsonBuffer jsonBuffer(kDomBufferSize);
+  JsonObject& root = jsonBuffer.parseObject(body.c_str());
+  if(!root.success()) {
+    return;
+  }
+
+  JsonObject& observation = root["current_observation"];
+  if(observation.success()) {
+    const char* city = observation["display_location"]["city"];
+    const char* title = observation["weather"];
+    const char* icon = observation["icon"];
+
+    conditions.setCity(city != NULL ? city : "");
+    conditions.setTitle(title != NULL ? title : "");
+    conditions.setTemperature(observation["temp_c"].as<float>());
+    conditions.setIcon(Weather::IconFromName(icon, icon != NULL ? strlen(icon) : 0));
+  }
+
+  JsonArray& forecastDay = root["forecast"]["simpleforecast"]["forecastday"];
+
+  size_t index = 0;
+  for(JsonArray::iterator it = forecastDay.begin(); it != forecastDay.end(); ++it, ++index) {
+    JsonObject& forecast = *it;
+
+    const char* title = forecast["date"]["weekday"];
+    const char* icon = forecast["icon"];
+
+    conditions.setForecastTitle(index, title != NULL ? title : "");
+    conditions.setForecastHighTemperature(index, forecast["high"]["celsius"].as<float>());
+    conditions.setForecastLowTemperature(index, forecast["low"]["celsius"].as<float>());
+    conditions.setForecastIcon(index, Weather::IconFromName(icon, icon != NULL ? strlen(icon) : 0));
+  }
+}
+
+static void AssertSameConditions(const Weather::Conditions& expected, const Weather::Conditions& actual) {
+  TEST_ASSERT_EQUAL(expected.isValid(), actual.isValid());
+  TEST_ASSERT_EQUAL_STRING(expected.getCurrentObservation().city, actual.getCurrentObservation().city);
+  TEST_ASSERT_EQUAL_STRING(expected.getCurrentObservation().title, actual.getCurrentObservation().title);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, expected.getCurrentObservation().temperature, actual.getCurrentObservation().temperature);
+  TEST_ASSERT_EQUAL(expected.getCurrentObservation().icon, actual.getCurrentObservation().icon);
+
+  TEST_ASSERT_EQUAL(expected.hasForecasts(), actual.hasForecasts());
+  for(size_t i = 0; i < Weather::Conditions::kMaxForecasts; i++) {
+    TEST_ASSERT_EQUAL_STRING(expected.getForecastForPeriod(i).title, actual.getForecastForPeriod(i).title);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, expected.getForecastForPeriod(i).highTemperature, actual.getForecastForPeriod(i).highTemperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, expected.getForecastForPeriod(i).lowTemperature, actual.getForecastForPeriod(i).lowTemperature);
+    TEST_ASSERT_EQUAL(expected.getForecastForPeriod(i).icon, actual.getForecastForPeriod(i).icon);
+  }
+}
+
+// Runs every framing of body through the response parser, the projection
+// and into the conditions, kReplays times with different segments.
+static void Replay(const char* corpus, const std::string& body, Weather::Conditions& result) {
+  for(int framing = ePlain; framing <= eClose; framing++) {
+    Stage http = { "http", std::vector<double>(), 0, 0 };
+    Stage json = { "json", std::vector<double>(), 0, 0 };
+    Stage conditions = { "conditions", std::vector<double>(), 0, 0 };
+    Stage dom = { "dom", std::vector<double>(), 0, 0 };
+    http.times.reserve(kReplays);
+    json.times.reserve(kReplays);
+    conditions.times.reserve(kReplays);
+    dom.times.reserve(kReplays);
+
+    std::string received;
+    received.reserve(body.size());
+    std::vector<size_t> segments;
+    segments.reserve(body.size() + 1024);
+
+    Http::Headers headers;
+    headers.watch(Http::kContentLength);
+    headers.watch(Http::kTransferEncoding);
+    headers.watch(Http::kConnection);
+    headers.watch(Http::kETag);
+    headers.watch(Http::kLastModified);
+    Http::ResponseParser parser(headers);
+
+    Weather::Conditions pending;
+    Weather::Conditions parsed;
+    Json::Projection projection(kFields, sizeof(kFields) / sizeof(kFields[0]));
+    projection.onValue([&pending](const uint8_t field, const size_t index, const char* value) {
+      OnValue(pending, field, index, value);
+    });
+    JsonStreamingParser jsonParser;
+    jsonParser.setListener(&projection);
+
+    const Http::BodyCallback onBody = [&received](const char* data, size_t len) {
+      received.append(data, len);
+    };
+
+    for(int i = 0; i < kReplays; i++) {
+      const std::string response = Frame(body, static_cast<Framing>(framing));
+      Split(response.size(), segments);
+      received.clear();
+
+      // As Http::Request::onData, the header first and the rest of the
+      // segment is the start of the body.
+      {
+        Measurement measurement(http);
+
+        parser.reset();
+
+        const char* data = response.data();
+        for(size_t j = 0; j < segments.size(); j++) {
+          size_t len = segments[j];
+          const char* segment = data;
+          data += len;
+
+          if(!parser.isHeaderComplete()) {
+            const size_t consumed = parser.parse(segment, len);
+            if(!parser.isHeaderComplete()) {
+              continue;
+            }
+
+            segment += consumed;
+            len -= consumed;
+          }
+
+          parser.parseBody(segment, len, onBody);
+        }
+
+        if(framing == eClose) {
+          parser.finish();
+        }
+      }
+
+      TEST_ASSERT_FALSE(parser.hasError());
+      TEST_ASSERT_TRUE(parser.isComplete());
+      TEST_ASSERT_EQUAL_UINT16(200, parser.getStatusCode());
+      TEST_ASSERT_EQUAL_STRING("\"8f37f4ec3f3b2a5d3b0a6f3f1b7c2e11\"", headers.get(Http::kETag));
+      TEST_ASSERT_TRUE(received == body);
+
+      // The body streams through in the slices the parser hands out.
+      Split(received.size(), segments);
+
+      {
+        Measurement measurement(json);
+
+        pending.reset();
+        jsonParser.reset();
+        projection.startDocument();
+
+        const char* data = received.data();
+        for(size_t j = 0; j < segments.size(); j++) {
+          for(size_t k = 0; k < segments[j]; k++) {
+            jsonParser.parse(data[k]);
+          }
+          data += segments[j];
+        }
+      }
+
+      TEST_ASSERT_TRUE(projection.isComplete());
+
+      {
+        Measurement measurement(conditions);
+
+        if(pending.isValid()) {
+          result.copyObservation(pending);
+        }
+        if(pending.hasForecasts()) {
+          result.copyForecasts(pending);
+        }
+      }
+
+      {
+        Measurement measurement(dom);
+
+        parsed.reset();
+        ParseDocument(received, parsed);
+      }
+
+      AssertSameConditions(pending, parsed);
+    }
+
+    Report(corpus, static_cast<Framing>(framing), http);
+    Report(corpus, static_cast<Framing>(framing), json);
+    Report(corpus, static_cast<Framing>(framing), conditions);
+    Report(corpus, static_cast<Framing>(framing), dom);
+  }
+}
+
+void setUp() {
+  Seed = 1;
+}
+
+void tearDown() {
+}
+
+void test_conditions() {
+  Weather::Conditions conditions;
+  Replay("conditions", kConditions, conditions);
+
+  const Weather::Conditions::Observation& observation = conditions.getCurrentObservation();
+
+  TEST_ASSERT_TRUE(conditions.isValid());
+  TEST_ASSERT_EQUAL_STRING("Amsterdam", observation.city);
+  TEST_ASSERT_EQUAL_STRING("Mostly Cloudy", observation.title);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 12.3, observation.temperature);
+  TEST_ASSERT_EQUAL(Weather::IconFromName("mostlycloudy", 12), observation.icon);
+  TEST_ASSERT_FALSE(conditions.hasForecasts());
+}
+
+void test_forecast() {
+  Weather::Conditions conditions;
+  Replay("forecast", RecordedForecast(4), conditions);
+
+  TEST_ASSERT_FALSE(conditions.isValid());
+  TEST_ASSERT_TRUE(conditions.hasForecasts());
+
+  for(size_t i = 0; i < Weather::Conditions::kMaxForecasts; i++) {
+    const Weather::Conditions::Forecast& forecast = conditions.getForecastForPeriod(i);
+
+    TEST_ASSERT_EQUAL_STRING(kWeekdays[i], forecast.title);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 14 + i, forecast.highTemperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 5 + i, forecast.lowTemperature);
+    TEST_ASSERT_EQUAL(Weather::IconFromName(kIcons[i], strlen(kIcons[i])), forecast.icon);
+  }
+}
+
+void test_forecast10day() {
+  // Periods past the ones shown are parsed and dropped.
+  Weather::Conditions conditions;
+  Replay("forecast10day", RecordedForecast(10), conditions);
+
+  TEST_ASSERT_TRUE(conditions.hasForecasts());
+  TEST_ASSERT_EQUAL_STRING(kWeekdays[3], conditions.getForecastForPeriod(3).title);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 17, conditions.getForecastForPeriod(3).highTemperature);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_conditions);
+  RUN_TEST(test_forecast);
+  RUN_TEST(test_forecast10day);
+  return UNITY_END();
+}